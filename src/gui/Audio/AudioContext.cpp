@@ -22,12 +22,16 @@
 #include <QFile>
 #include <QMessageBox>
 
+static qint64 tickToSample(int tick) {
+    return PlaybackController::instance()->timeConverter().tickToSample(tick);
+}
+
 static qint64 tickToSample(double tick) {
-    return qint64(tick * 60.0 * AudioSystem::instance()->adoptedSampleRate() / PlaybackController::instance()->tempo() / 480.0);
+    return PlaybackController::instance()->tickToSamplePos(tick);
 }
 
 static double sampleToTick(qint64 sample) {
-    return double(sample) / AudioSystem::instance()->adoptedSampleRate()  * PlaybackController::instance()->tempo() / 60.0 * 480.0;
+    return PlaybackController::instance()->samplePosToTick(sample);
 }
 
 template <typename Iterator, typename Func, typename ...Args>
@@ -169,18 +173,19 @@ void AudioContext::handleTrackInsertion(const DsTrack *track) {
         handleClipInsertion(track, clip);
     }
 
-    connect(track, &DsTrack::clipChanged, this, [=](DsTrack::ClipChangeType type, int index, DsClip *clip) {
-        Q_UNUSED(index)
-        switch (type) {
-            case DsTrack::Inserted:
-                handleClipInsertion(track, clip);
-                break;
-            case DsTrack::Removed:
-                handleClipRemoval(track, clip);
-                break;
-            case DsTrack::PropertyChanged:
-                handleClipPropertyChange(track, clip);
-                break;
+    connect(track, &DsTrack::clipsChanged, this, [=](DsTrack::ClipChangeType type, const QList<DsClip *> &clips) {
+        for (auto clip : clips) {
+            switch (type) {
+                case DsTrack::Inserted:
+                    handleClipInsertion(track, clip);
+                    break;
+                case DsTrack::Removed:
+                    handleClipRemoval(track, clip);
+                    break;
+                case DsTrack::PropertyChanged:
+                    handleClipPropertyChange(track, clip);
+                    break;
+            }
         }
     });
 
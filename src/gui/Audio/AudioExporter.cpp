@@ -211,6 +211,9 @@ void AudioExporter::setOption(const AudioExporter::Option &option) {
 AudioExporter::Option AudioExporter::option() const {
     return m_option;
 }
+TickSampleConverter AudioExporter::timeConverter() const {
+    return {AppModel::instance()->tempo(), m_option.sampleRate};
+}
 QStringList AudioExporter::outputFileList() const {
     auto directory = QDir(m_option.fileDirectory); // TODO
     auto fileNameTemplate = m_option.fileName + "." + m_option.extensionName;
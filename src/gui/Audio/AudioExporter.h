@@ -7,6 +7,8 @@
 
 #include <QObject>
 
+#include "Utils/TickSampleConverter.h"
+
 class AudioExporter : public QObject {
     Q_OBJECT
 public:
@@ -61,6 +63,8 @@ public:
     Option option() const;
 
     QStringList outputFileList() const;
+    // Converts ticks to sample positions at the export sample rate
+    TickSampleConverter timeConverter() const;
 
     struct Format {
         QString formatName;
@@ -138,6 +138,7 @@ bool AudioSystem::initialize(bool isVstMode) {
             m_remoteDev->open(bufferSize, sampleRate);
             m_adoptedBufferSize = bufferSize;
             m_adoptedSampleRate = sampleRate;
+            PlaybackController::instance()->sampleRateChanged(m_adoptedSampleRate);
         });
 
         m_preMixer->open(1024, 48000); // dummy
@@ -249,6 +250,7 @@ void AudioSystem::postSetDevice() {
     m_adoptedBufferSize = m_dev->bufferSize();
     if (!qFuzzyCompare(m_adoptedBufferSize, m_dev->sampleRate())) {
         m_adoptedSampleRate = m_dev->sampleRate();
+        PlaybackController::instance()->sampleRateChanged(m_adoptedSampleRate);
         m_audioContext->rebuildAllClips();
         m_audioContext->handleFileBufferingSizeChange();
     }
@@ -284,6 +286,7 @@ void AudioSystem::setAdoptedSampleRate(double sampleRate) {
         device()->open(device()->bufferSize(), sampleRate);
     }
     m_adoptedSampleRate = sampleRate;
+    PlaybackController::instance()->sampleRateChanged(m_adoptedSampleRate);
     m_settings.setValue("audio/adoptedSampleRate", m_adoptedSampleRate);
     if (m_adoptedBufferSize && m_adoptedSampleRate)
         m_preMixer->open(m_adoptedBufferSize, m_adoptedSampleRate);
@@ -36,4 +36,8 @@ void ClipActions::editAudioClipProperties(const QList<DsClip::ClipCommonProperti
         addAction(EditClipCommonPropertiesAction::build(oldArgs[i], newArgs[i], clip, track));
         i++;
     }
-}
\ No newline at end of file
+}
+void ClipActions::disposeClip(DsClip *clip) {
+    // A singing clip frees its notes and params with it
+    delete clip;
+}
@@ -19,6 +19,9 @@ public:
     void editAudioClipProperties(const QList<DsClip::ClipCommonProperties> &oldArgs,
                                    const QList<DsClip::ClipCommonProperties> &newArgs,
                                    const QList<DsAudioClip *> &clips, DsTrack *track);
+
+    // Deletes a clip that is no longer in any track, with its notes
+    static void disposeClip(DsClip *clip);
 };
 
 
@@ -3,6 +3,8 @@
 //
 
 #include "EditClipCommonPropertiesAction.h"
+
+#include "Controller/History/ActionJournal.h"
 #include "Model/DsTrack.h"
 
 EditClipCommonPropertiesAction *
@@ -39,4 +41,31 @@ void EditClipCommonPropertiesAction::undo() {
 
     m_track->insertClipQuietly(m_clip);
     m_track->notityClipPropertyChanged(m_clip);
-}
\ No newline at end of file
+}
+qint64 EditClipCommonPropertiesAction::memoryUsage() const {
+    return sizeof(EditClipCommonPropertiesAction) +
+           (m_oldArgs.name.size() + m_newArgs.name.size()) * sizeof(QChar);
+}
+EditClipCommonPropertiesAction *
+    EditClipCommonPropertiesAction::read(QDataStream &stream, JournalObjects &objects) {
+    DsClip::ClipCommonProperties oldArgs;
+    DsClip::ClipCommonProperties newArgs;
+    ActionJournal::readClipProperties(stream, oldArgs);
+    ActionJournal::readClipProperties(stream, newArgs);
+    int clipId;
+    int trackId;
+    stream >> clipId >> trackId;
+    auto clip = objects.find<DsClip>(clipId);
+    auto track = objects.find<DsTrack>(trackId);
+    if (!clip || !track)
+        return nullptr;
+    oldArgs.id = newArgs.id = clip->id();
+    return build(oldArgs, newArgs, clip, track);
+}
+bool EditClipCommonPropertiesAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::EditClipCommonProperties);
+    ActionJournal::writeClipProperties(stream, m_oldArgs);
+    ActionJournal::writeClipProperties(stream, m_newArgs);
+    stream << objects.idOf(m_clip) << objects.idOf(m_track);
+    return true;
+}
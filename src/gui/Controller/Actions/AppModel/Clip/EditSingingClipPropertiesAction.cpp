@@ -3,6 +3,9 @@
 //
 
 #include "EditSingingClipPropertiesAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 EditSingingClipPropertiesAction *
     EditSingingClipPropertiesAction::build(const DsClip::ClipCommonProperties &oldArgs,
                                      const DsClip::ClipCommonProperties &newArgs,
@@ -47,4 +50,31 @@ void EditSingingClipPropertiesAction::undo() {
 
     m_track->insertClipQuietly(m_clip);
     m_track->notityClipPropertyChanged(m_clip);
-}
\ No newline at end of file
+}
+qint64 EditSingingClipPropertiesAction::memoryUsage() const {
+    return sizeof(EditSingingClipPropertiesAction) +
+           (m_oldArgs.name.size() + m_newArgs.name.size()) * sizeof(QChar);
+}
+EditSingingClipPropertiesAction *
+    EditSingingClipPropertiesAction::read(QDataStream &stream, JournalObjects &objects) {
+    DsClip::ClipCommonProperties oldArgs;
+    DsClip::ClipCommonProperties newArgs;
+    ActionJournal::readClipProperties(stream, oldArgs);
+    ActionJournal::readClipProperties(stream, newArgs);
+    int clipId;
+    int trackId;
+    stream >> clipId >> trackId;
+    auto clip = objects.find<DsSingingClip>(clipId);
+    auto track = objects.find<DsTrack>(trackId);
+    if (!clip || !track)
+        return nullptr;
+    oldArgs.id = newArgs.id = clip->id();
+    return build(oldArgs, newArgs, clip, track);
+}
+bool EditSingingClipPropertiesAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::EditSingingClipProperties);
+    ActionJournal::writeClipProperties(stream, m_oldArgs);
+    ActionJournal::writeClipProperties(stream, m_newArgs);
+    stream << objects.idOf(m_clip) << objects.idOf(m_track);
+    return true;
+}
@@ -14,8 +14,11 @@ public:
     static EditSingingClipPropertiesAction *build(const DsClip::ClipCommonProperties &oldArgs,
                                             const DsClip::ClipCommonProperties &newArgs,
                                             DsSingingClip *clip, DsTrack *track);
+    static EditSingingClipPropertiesAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsClip::ClipCommonProperties m_oldArgs;
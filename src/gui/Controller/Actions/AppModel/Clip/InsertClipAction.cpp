@@ -3,6 +3,10 @@
 //
 
 #include "InsertClipAction.h"
+
+#include "Controller/History/ActionJournal.h"
+#include "ClipActions.h"
+
 InsertClipAction *InsertClipAction::build(DsClip *clip, DsTrack *track) {
     auto a = new InsertClipAction;
     a->m_clip = clip;
@@ -14,4 +18,32 @@ void InsertClipAction::execute() {
 }
 void InsertClipAction::undo() {
     m_track->removeClip(m_clip);
-}
\ No newline at end of file
+}
+qint64 InsertClipAction::memoryUsage() const {
+    return sizeof(InsertClipAction);
+}
+qint64 InsertClipAction::ownedMemoryUsage(bool executed) const {
+    return executed ? 0 : m_clip->memoryUsage();
+}
+void InsertClipAction::discard(bool executed) {
+    if (!executed)
+        ClipActions::disposeClip(m_clip);
+}
+InsertClipAction *InsertClipAction::read(QDataStream &stream, JournalObjects &objects) {
+    auto clip = ActionJournal::readClip(stream, objects);
+    int trackId;
+    stream >> trackId;
+    auto track = objects.find<DsTrack>(trackId);
+    if (!track) {
+        // Never executed, so nothing else refers to it
+        delete clip;
+        return nullptr;
+    }
+    return build(clip, track);
+}
+bool InsertClipAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::InsertClip);
+    ActionJournal::writeClip(stream, m_clip, objects);
+    stream << objects.idOf(m_track);
+    return true;
+}
@@ -12,8 +12,13 @@
 class InsertClipAction final : public IAction {
 public:
     static InsertClipAction *build(DsClip *clip, DsTrack *track);
+    static InsertClipAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    qint64 ownedMemoryUsage(bool executed) const override;
+    void discard(bool executed) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsClip *m_clip = nullptr;
@@ -3,6 +3,10 @@
 //
 
 #include "RemoveClipAction.h"
+
+#include "Controller/History/ActionJournal.h"
+#include "ClipActions.h"
+
 RemoveClipAction *RemoveClipAction::build(DsClip *clip, DsTrack *track) {
     auto a = new RemoveClipAction;
     a->m_clip = clip;
@@ -14,4 +18,29 @@ void RemoveClipAction::execute() {
 }
 void RemoveClipAction::undo() {
     m_track->insertClip(m_clip);
-}
\ No newline at end of file
+}
+qint64 RemoveClipAction::memoryUsage() const {
+    return sizeof(RemoveClipAction);
+}
+qint64 RemoveClipAction::ownedMemoryUsage(bool executed) const {
+    return executed ? m_clip->memoryUsage() : 0;
+}
+void RemoveClipAction::discard(bool executed) {
+    if (executed)
+        ClipActions::disposeClip(m_clip);
+}
+RemoveClipAction *RemoveClipAction::read(QDataStream &stream, JournalObjects &objects) {
+    int clipId;
+    int trackId;
+    stream >> clipId >> trackId;
+    auto clip = objects.find<DsClip>(clipId);
+    auto track = objects.find<DsTrack>(trackId);
+    if (!clip || !track)
+        return nullptr;
+    return build(clip, track);
+}
+bool RemoveClipAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::RemoveClip) << objects.idOf(m_clip)
+           << objects.idOf(m_track);
+    return true;
+}
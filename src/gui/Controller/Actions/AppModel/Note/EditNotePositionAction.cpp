@@ -3,24 +3,65 @@
 //
 
 #include "EditNotePositionAction.h"
-EditNotePositionAction *EditNotePositionAction::build(DsNote *note, int deltaTick, int deltaKey,
-                                                      DsSingingClip *clip) {
+
+#include "Controller/History/ActionJournal.h"
+
+EditNotePositionAction *EditNotePositionAction::build(const QList<DsNote *> &notes, int deltaTick,
+                                                      int deltaKey, DsSingingClip *clip) {
     auto a = new EditNotePositionAction;
-    a->m_note = note;
+    a->m_notes = notes;
     a->m_deltaTick = deltaTick;
     a->m_deltaKey = deltaKey;
     a->m_clip = clip;
     return a;
 }
 void EditNotePositionAction::execute() {
-    m_clip->removeNote(m_note);
-    m_note->setStart(m_note->start() + m_deltaTick);
-    m_note->setKeyIndex(m_note->keyIndex() + m_deltaKey);
-    m_clip->insertNote(m_note);
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setStart(note->start() + m_deltaTick);
+        note->setKeyIndex(note->keyIndex() + m_deltaKey);
+    });
 }
 void EditNotePositionAction::undo() {
-    m_clip->removeNote(m_note);
-    m_note->setStart(m_note->start() - m_deltaTick);
-    m_note->setKeyIndex(m_note->keyIndex() - m_deltaKey);
-    m_clip->insertNote(m_note);
-}
\ No newline at end of file
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setStart(note->start() - m_deltaTick);
+        note->setKeyIndex(note->keyIndex() - m_deltaKey);
+    });
+}
+qint64 EditNotePositionAction::memoryUsage() const {
+    return sizeof(EditNotePositionAction) + m_notes.count() * sizeof(DsNote *);
+}
+bool EditNotePositionAction::canMergeWith(const IAction *other) const {
+    auto action = dynamic_cast<const EditNotePositionAction *>(other);
+    return action && action->m_clip == m_clip && action->m_notes == m_notes;
+}
+void EditNotePositionAction::mergeWith(const IAction *other) {
+    auto action = static_cast<const EditNotePositionAction *>(other);
+    m_deltaTick += action->m_deltaTick;
+    m_deltaKey += action->m_deltaKey;
+}
+EditNotePositionAction *EditNotePositionAction::read(QDataStream &stream, JournalObjects &objects) {
+    QList<int> noteIds;
+    int deltaTick;
+    int deltaKey;
+    int clipId;
+    stream >> noteIds >> deltaTick >> deltaKey >> clipId;
+    auto clip = objects.find<DsSingingClip>(clipId);
+    if (!clip)
+        return nullptr;
+    QList<DsNote *> notes;
+    for (const auto noteId : noteIds) {
+        auto note = objects.find<DsNote>(noteId);
+        if (!note)
+            return nullptr;
+        notes.append(note);
+    }
+    return build(notes, deltaTick, deltaKey, clip);
+}
+bool EditNotePositionAction::write(QDataStream &stream, JournalObjects &objects) const {
+    QList<int> noteIds;
+    for (const auto note : m_notes)
+        noteIds.append(objects.idOf(note));
+    stream << static_cast<quint8>(ActionJournal::EditNotePosition) << noteIds << m_deltaTick
+           << m_deltaKey << objects.idOf(m_clip);
+    return true;
+}
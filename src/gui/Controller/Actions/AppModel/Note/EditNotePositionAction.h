@@ -8,15 +8,21 @@
 #include "Controller/History/IAction.h"
 #include "Model/DsClip.h"
 
+// Moves a selection of notes as a single edit of the clip
 class EditNotePositionAction final : public IAction {
 public:
-    static EditNotePositionAction *build(DsNote *note, int deltaTick, int deltaKey,
+    static EditNotePositionAction *build(const QList<DsNote *> &notes, int deltaTick, int deltaKey,
                                          DsSingingClip *clip);
+    static EditNotePositionAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool canMergeWith(const IAction *other) const override;
+    void mergeWith(const IAction *other) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
-    DsNote *m_note = nullptr;
+    QList<DsNote *> m_notes;
     int m_deltaTick = 0;
     int m_deltaKey = 0;
     DsSingingClip *m_clip = nullptr;
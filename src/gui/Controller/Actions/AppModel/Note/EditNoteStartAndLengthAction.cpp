@@ -3,29 +3,64 @@
 //
 
 #include "EditNoteStartAndLengthAction.h"
-EditNoteStartAndLengthAction *EditNoteStartAndLengthAction::build(DsNote *note, int deltaTick,
+
+#include "Controller/History/ActionJournal.h"
+
+EditNoteStartAndLengthAction *EditNoteStartAndLengthAction::build(const QList<DsNote *> &notes,
+                                                                  int deltaTick,
                                                                   DsSingingClip *clip) {
     auto a = new EditNoteStartAndLengthAction;
-    a->m_note = note;
+    a->m_notes = notes;
     a->m_deltaTick = deltaTick;
     a->m_clip = clip;
     return a;
 }
 void EditNoteStartAndLengthAction::execute() {
-    m_clip->removeNoteQuietly(m_note);
-
-    m_note->setStart(m_note->start() + m_deltaTick);
-    m_note->setLength(m_note->length() - m_deltaTick);
-
-    m_clip->insertNoteQuietly(m_note);
-    m_clip->notifyNotePropertyChanged(m_note);
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setStart(note->start() + m_deltaTick);
+        note->setLength(note->length() - m_deltaTick);
+    });
 }
 void EditNoteStartAndLengthAction::undo() {
-    m_clip->removeNoteQuietly(m_note);
-
-    m_note->setStart(m_note->start() - m_deltaTick);
-    m_note->setLength(m_note->length() + m_deltaTick);
-
-    m_clip->insertNoteQuietly(m_note);
-    m_clip->notifyNotePropertyChanged(m_note);
-}
\ No newline at end of file
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setStart(note->start() - m_deltaTick);
+        note->setLength(note->length() + m_deltaTick);
+    });
+}
+qint64 EditNoteStartAndLengthAction::memoryUsage() const {
+    return sizeof(EditNoteStartAndLengthAction) + m_notes.count() * sizeof(DsNote *);
+}
+bool EditNoteStartAndLengthAction::canMergeWith(const IAction *other) const {
+    auto action = dynamic_cast<const EditNoteStartAndLengthAction *>(other);
+    return action && action->m_clip == m_clip && action->m_notes == m_notes;
+}
+void EditNoteStartAndLengthAction::mergeWith(const IAction *other) {
+    auto action = static_cast<const EditNoteStartAndLengthAction *>(other);
+    m_deltaTick += action->m_deltaTick;
+}
+EditNoteStartAndLengthAction *
+    EditNoteStartAndLengthAction::read(QDataStream &stream, JournalObjects &objects) {
+    QList<int> noteIds;
+    int deltaTick;
+    int clipId;
+    stream >> noteIds >> deltaTick >> clipId;
+    auto clip = objects.find<DsSingingClip>(clipId);
+    if (!clip)
+        return nullptr;
+    QList<DsNote *> notes;
+    for (const auto noteId : noteIds) {
+        auto note = objects.find<DsNote>(noteId);
+        if (!note)
+            return nullptr;
+        notes.append(note);
+    }
+    return build(notes, deltaTick, clip);
+}
+bool EditNoteStartAndLengthAction::write(QDataStream &stream, JournalObjects &objects) const {
+    QList<int> noteIds;
+    for (const auto note : m_notes)
+        noteIds.append(objects.idOf(note));
+    stream << static_cast<quint8>(ActionJournal::EditNoteStartAndLength) << noteIds << m_deltaTick
+           << objects.idOf(m_clip);
+    return true;
+}
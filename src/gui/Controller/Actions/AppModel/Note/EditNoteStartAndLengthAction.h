@@ -8,14 +8,21 @@
 #include "Controller/History/IAction.h"
 #include "Model/DsClip.h"
 
+// Resizes a selection of notes from the left as a single edit of the clip
 class EditNoteStartAndLengthAction final : public IAction {
 public:
-    static EditNoteStartAndLengthAction *build(DsNote *note, int deltaTick, DsSingingClip *clip);
+    static EditNoteStartAndLengthAction *build(const QList<DsNote *> &notes, int deltaTick,
+                                               DsSingingClip *clip);
+    static EditNoteStartAndLengthAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool canMergeWith(const IAction *other) const override;
+    void mergeWith(const IAction *other) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
-    DsNote *m_note = nullptr;
+    QList<DsNote *> m_notes;
     int m_deltaTick = 0;
     DsSingingClip *m_clip = nullptr;
 };
@@ -3,27 +3,60 @@
 //
 
 #include "EditNotesLengthAction.h"
-EditNotesLengthAction *EditNotesLengthAction::build(DsNote *note, int deltaTick,
-                                                       DsSingingClip *clip) {
+
+#include "Controller/History/ActionJournal.h"
+
+EditNotesLengthAction *EditNotesLengthAction::build(const QList<DsNote *> &notes, int deltaTick,
+                                                    DsSingingClip *clip) {
     auto a = new EditNotesLengthAction;
-    a->m_note = note;
+    a->m_notes = notes;
     a->m_deltaTick = deltaTick;
     a->m_clip = clip;
     return a;
 }
 void EditNotesLengthAction::execute() {
-    m_clip->removeNoteQuietly(m_note);
-
-    m_note->setLength(m_note->length() + m_deltaTick);
-
-    m_clip->insertNoteQuietly(m_note);
-    m_clip->notifyNotePropertyChanged(m_note);
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setLength(note->length() + m_deltaTick);
+    });
 }
 void EditNotesLengthAction::undo() {
-    m_clip->removeNoteQuietly(m_note);
-
-    m_note->setLength(m_note->length() - m_deltaTick);
-
-    m_clip->insertNoteQuietly(m_note);
-    m_clip->notifyNotePropertyChanged(m_note);
-}
\ No newline at end of file
+    m_clip->editNotes(m_notes, [this](DsNote *note) {
+        note->setLength(note->length() - m_deltaTick);
+    });
+}
+qint64 EditNotesLengthAction::memoryUsage() const {
+    return sizeof(EditNotesLengthAction) + m_notes.count() * sizeof(DsNote *);
+}
+bool EditNotesLengthAction::canMergeWith(const IAction *other) const {
+    auto action = dynamic_cast<const EditNotesLengthAction *>(other);
+    return action && action->m_clip == m_clip && action->m_notes == m_notes;
+}
+void EditNotesLengthAction::mergeWith(const IAction *other) {
+    auto action = static_cast<const EditNotesLengthAction *>(other);
+    m_deltaTick += action->m_deltaTick;
+}
+EditNotesLengthAction *EditNotesLengthAction::read(QDataStream &stream, JournalObjects &objects) {
+    QList<int> noteIds;
+    int deltaTick;
+    int clipId;
+    stream >> noteIds >> deltaTick >> clipId;
+    auto clip = objects.find<DsSingingClip>(clipId);
+    if (!clip)
+        return nullptr;
+    QList<DsNote *> notes;
+    for (const auto noteId : noteIds) {
+        auto note = objects.find<DsNote>(noteId);
+        if (!note)
+            return nullptr;
+        notes.append(note);
+    }
+    return build(notes, deltaTick, clip);
+}
+bool EditNotesLengthAction::write(QDataStream &stream, JournalObjects &objects) const {
+    QList<int> noteIds;
+    for (const auto note : m_notes)
+        noteIds.append(objects.idOf(note));
+    stream << static_cast<quint8>(ActionJournal::EditNotesLength) << noteIds << m_deltaTick
+           << objects.idOf(m_clip);
+    return true;
+}
@@ -3,6 +3,9 @@
 //
 
 #include "EditNotesWordPropertiesAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 EditNotesWordPropertiesAction *
     EditNotesWordPropertiesAction::build(DsNote *note, const DsNote::NoteWordProperties &args) {
     DsNote::NoteWordProperties oldArgs;
@@ -27,4 +30,37 @@ void EditNotesWordPropertiesAction::undo() {
     m_note->setPhonemes(DsPhonemes::Original, m_oldArgs.phonemes.original);
     m_note->setPhonemes(DsPhonemes::Edited, m_oldArgs.phonemes.edited);
     m_note->setPronunciation(m_oldArgs.pronunciation);
-}
\ No newline at end of file
+}
+qint64 EditNotesWordPropertiesAction::memoryUsage() const {
+    qint64 bytes = sizeof(EditNotesWordPropertiesAction);
+    for (const auto args : {&m_oldArgs, &m_newArgs})
+        bytes += (args->lyric.size() + args->pronunciation.size()) * sizeof(QChar) +
+                 args->phonemes.memoryUsage();
+    return bytes;
+}
+EditNotesWordPropertiesAction *
+    EditNotesWordPropertiesAction::read(QDataStream &stream, JournalObjects &objects) {
+    int noteId;
+    stream >> noteId;
+    auto a = new EditNotesWordPropertiesAction;
+    a->m_note = objects.find<DsNote>(noteId);
+    for (const auto args : {&a->m_oldArgs, &a->m_newArgs}) {
+        stream >> args->lyric >> args->pronunciation;
+        args->phonemes.original = ActionJournal::readPhonemes(stream);
+        args->phonemes.edited = ActionJournal::readPhonemes(stream);
+    }
+    if (!a->m_note) {
+        delete a;
+        return nullptr;
+    }
+    return a;
+}
+bool EditNotesWordPropertiesAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::EditNotesWordProperties) << objects.idOf(m_note);
+    for (const auto args : {&m_oldArgs, &m_newArgs}) {
+        stream << args->lyric << args->pronunciation;
+        ActionJournal::writePhonemes(stream, args->phonemes.original);
+        ActionJournal::writePhonemes(stream, args->phonemes.edited);
+    }
+    return true;
+}
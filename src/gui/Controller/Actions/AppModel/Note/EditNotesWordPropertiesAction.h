@@ -11,8 +11,11 @@
 class EditNotesWordPropertiesAction final : public IAction {
 public:
     static EditNotesWordPropertiesAction *build(DsNote *note, const DsNote::NoteWordProperties &args);
+    static EditNotesWordPropertiesAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsNote *m_note = nullptr;
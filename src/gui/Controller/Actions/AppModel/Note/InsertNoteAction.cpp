@@ -4,6 +4,8 @@
 
 #include "InsertNoteAction.h"
 
+#include "Controller/History/ActionJournal.h"
+
 InsertNoteAction *InsertNoteAction::build(DsNote *note, DsSingingClip *clip) {
     auto a = new InsertNoteAction;
     a->m_note = note;
@@ -15,4 +17,28 @@ void InsertNoteAction::execute() {
 }
 void InsertNoteAction::undo() {
     m_clip->removeNote(m_note);
-}
\ No newline at end of file
+}
+qint64 InsertNoteAction::memoryUsage() const {
+    return sizeof(InsertNoteAction);
+}
+qint64 InsertNoteAction::ownedMemoryUsage(bool executed) const {
+    return executed ? 0 : m_note->memoryUsage();
+}
+void InsertNoteAction::discard(bool executed) {
+    // Undone, so the note is not in the clip any more
+    if (!executed)
+        m_clip->destroyNote(m_note);
+}
+InsertNoteAction *InsertNoteAction::read(QDataStream &stream, JournalObjects &objects) {
+    int clipId;
+    stream >> clipId;
+    auto clip = objects.find<DsSingingClip>(clipId);
+    if (!clip)
+        return nullptr;
+    return build(ActionJournal::readNote(stream, objects, clip), clip);
+}
+bool InsertNoteAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::InsertNote) << objects.idOf(m_clip);
+    ActionJournal::writeNote(stream, m_note, objects);
+    return true;
+}
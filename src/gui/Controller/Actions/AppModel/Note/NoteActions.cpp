@@ -21,17 +21,14 @@ void NoteActions::removeNotes(const QList<DsNote *> &notes, DsSingingClip *clip)
 }
 void NoteActions::editNotesStartAndLength(const QList<DsNote *> &notes, int delta,
                                           DsSingingClip *clip) {
-    for (const auto note : notes)
-        addAction(EditNoteStartAndLengthAction::build(note, delta, clip));
+    addAction(EditNoteStartAndLengthAction::build(notes, delta, clip));
 }
 void NoteActions::editNotesLength(const QList<DsNote *> &notes, int delta, DsSingingClip *clip) {
-    for (const auto note : notes)
-        addAction(EditNotesLengthAction::build(note, delta, clip));
+    addAction(EditNotesLengthAction::build(notes, delta, clip));
 }
 void NoteActions::editNotePosition(const QList<DsNote *> &notes, int deltaTick, int deltaKey,
                                    DsSingingClip *clip) {
-    for (const auto note : notes)
-        addAction(EditNotePositionAction::build(note, deltaTick, deltaKey, clip));
+    addAction(EditNotePositionAction::build(notes, deltaTick, deltaKey, clip));
 }
 void NoteActions::editNotesWordProperties(const QList<DsNote *> &notes,
                                           const QList<DsNote::NoteWordProperties> &args) {
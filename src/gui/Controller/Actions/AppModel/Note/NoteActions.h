@@ -14,6 +14,9 @@ public:
     void insertNotes(const QList<DsNote *> &notes, DsSingingClip *clip);
     void removeNotes(const QList<DsNote *> &notes, DsSingingClip *clip);
 
+    // The edits below apply to the whole selection as one action, so the clip re-sorts and
+    // notifies once per edit rather than once per note
+
     // Resize from left
     void editNotesStartAndLength(const QList<DsNote *> &notes, int delta, DsSingingClip *clip);
 
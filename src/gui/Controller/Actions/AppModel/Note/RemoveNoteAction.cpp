@@ -3,6 +3,9 @@
 //
 
 #include "RemoveNoteAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 RemoveNoteAction *RemoveNoteAction::build(DsNote *note, DsSingingClip *clip) {
     auto a = new RemoveNoteAction;
     a->m_note = note;
@@ -14,4 +17,30 @@ void RemoveNoteAction::execute() {
 }
 void RemoveNoteAction::undo() {
     m_clip->insertNote(m_note);
-}
\ No newline at end of file
+}
+qint64 RemoveNoteAction::memoryUsage() const {
+    return sizeof(RemoveNoteAction);
+}
+qint64 RemoveNoteAction::ownedMemoryUsage(bool executed) const {
+    return executed ? m_note->memoryUsage() : 0;
+}
+void RemoveNoteAction::discard(bool executed) {
+    // The removed note is only kept alive by this action
+    if (executed)
+        m_clip->destroyNote(m_note);
+}
+RemoveNoteAction *RemoveNoteAction::read(QDataStream &stream, JournalObjects &objects) {
+    int noteId;
+    int clipId;
+    stream >> noteId >> clipId;
+    auto note = objects.find<DsNote>(noteId);
+    auto clip = objects.find<DsSingingClip>(clipId);
+    if (!note || !clip)
+        return nullptr;
+    return build(note, clip);
+}
+bool RemoveNoteAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::RemoveNote) << objects.idOf(m_note)
+           << objects.idOf(m_clip);
+    return true;
+}
@@ -12,8 +12,13 @@
 class RemoveNoteAction final : public IAction {
 public:
     static RemoveNoteAction *build(DsNote *note, DsSingingClip *clip);
+    static RemoveNoteAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    qint64 ownedMemoryUsage(bool executed) const override;
+    void discard(bool executed) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsNote *m_note = nullptr;
@@ -0,0 +1,89 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "EditDrawCurveAction.h"
+
+#include <QDataStream>
+
+#include "Controller/History/ActionJournal.h"
+
+EditDrawCurveAction *EditDrawCurveAction::build(DsDrawCurve *curve, int startTick,
+                                                const QList<int> &values,
+                                                DsParams::ParamType paramType,
+                                                DsParam::ParamCurveType curveType,
+                                                DsSingingClip *clip) {
+    auto index = (startTick - curve->start()) / curve->valueStep();
+    Q_ASSERT(index >= 0 && index <= curve->valueCount());
+
+    auto a = new EditDrawCurveAction;
+    a->m_clip = clip;
+    a->m_paramType = paramType;
+    a->m_curveType = curveType;
+    a->m_curve = curve;
+    a->m_index = index;
+    a->m_oldCount = curve->valueCount();
+    auto overwritten = qMin(values.count(), a->m_oldCount - index);
+    QVector<int> oldValues(overwritten);
+    curve->readValues(index, overwritten, oldValues.data());
+    a->m_oldValues.write(0, oldValues.constData(), overwritten);
+    a->m_newValues.setValues(values);
+    return a;
+}
+void EditDrawCurveAction::execute() {
+    apply(m_newValues, qMax(m_oldCount, m_index + m_newValues.count()));
+}
+void EditDrawCurveAction::undo() {
+    apply(m_oldValues, m_oldCount);
+}
+qint64 EditDrawCurveAction::memoryUsage() const {
+    return sizeof(EditDrawCurveAction) + m_oldValues.memoryUsage() + m_newValues.memoryUsage();
+}
+EditDrawCurveAction *EditDrawCurveAction::read(QDataStream &stream, JournalObjects &objects) {
+    int clipId;
+    quint8 paramType;
+    quint8 curveType;
+    int curveIndex;
+    auto a = new EditDrawCurveAction;
+    stream >> clipId >> paramType >> curveType >> curveIndex >> a->m_index >> a->m_oldCount;
+    QList<int> oldValues;
+    QList<int> newValues;
+    stream >> oldValues >> newValues;
+    a->m_clip = objects.find<DsSingingClip>(clipId);
+    a->m_paramType = static_cast<DsParams::ParamType>(paramType);
+    a->m_curveType = static_cast<DsParam::ParamCurveType>(curveType);
+    if (a->m_clip) {
+        const auto &curves = a->m_clip->params.param(a->m_paramType).curves(a->m_curveType);
+        if (curveIndex >= 0 && curveIndex < curves.count())
+            a->m_curve = dynamic_cast<DsDrawCurve *>(curves.at(curveIndex));
+    }
+    if (!a->m_curve) {
+        delete a;
+        return nullptr;
+    }
+    a->m_oldValues.setValues(oldValues);
+    a->m_newValues.setValues(newValues);
+    return a;
+}
+bool EditDrawCurveAction::write(QDataStream &stream, JournalObjects &objects) const {
+    // Curves have no journal id of their own; the stroke does not move the curve, so its
+    // position in the list identifies it
+    const auto &curves = m_clip->params.param(m_paramType).curves(m_curveType);
+    stream << static_cast<quint8>(ActionJournal::EditDrawCurve) << objects.idOf(m_clip)
+           << static_cast<quint8>(m_paramType) << static_cast<quint8>(m_curveType)
+           << curves.indexOf(m_curve) << m_index << m_oldCount << m_oldValues.toList()
+           << m_newValues.toList();
+    return true;
+}
+void EditDrawCurveAction::apply(const ChunkedIntArray &values, int count) {
+    auto edit = [&](DsCurve *) {
+        m_curve->writeValues(m_index, values.toList());
+        m_curve->truncateValues(count);
+    };
+    if (count == m_curve->valueCount())
+        edit(m_curve);
+    else
+        // The end of the curve moves, and with it its overlaps with the other curves
+        m_clip->params.param(m_paramType).curves(m_curveType).updateItems({m_curve}, edit);
+    m_clip->notifyParamsChanged(static_cast<DsSingingClip::ParamsChangeType>(m_paramType));
+}
@@ -0,0 +1,44 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef EDITDRAWCURVEACTION_H
+#define EDITDRAWCURVEACTION_H
+
+#include "Controller/History/IAction.h"
+#include "Model/DsClip.h"
+#include "Utils/ChunkedIntArray.h"
+
+// Writes a stroke into a draw curve of a clip parameter. Only the slice of the curve the
+// stroke covers is kept, before and after, so the memory of the action and the work of
+// execute() and undo() follow the length of the stroke rather than that of the curve.
+class EditDrawCurveAction final : public IAction {
+public:
+    // values start at startTick, which must fall on a sample of curve, inside it or right
+    // at its end. Values past the end extend the curve.
+    static EditDrawCurveAction *build(DsDrawCurve *curve, int startTick, const QList<int> &values,
+                                      DsParams::ParamType paramType,
+                                      DsParam::ParamCurveType curveType, DsSingingClip *clip);
+    static EditDrawCurveAction *read(QDataStream &stream, JournalObjects &objects);
+    void execute() override;
+    void undo() override;
+    qint64 memoryUsage() const override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
+
+private:
+    // Writes values at m_index and leaves the curve with count values
+    void apply(const ChunkedIntArray &values, int count);
+
+    DsSingingClip *m_clip = nullptr;
+    DsParams::ParamType m_paramType = DsParams::Pitch;
+    DsParam::ParamCurveType m_curveType = DsParam::Edited;
+    DsDrawCurve *m_curve = nullptr;
+    int m_index = 0;    // index of the first value of the stroke
+    int m_oldCount = 0; // value count of the curve before the stroke
+    ChunkedIntArray m_oldValues;
+    ChunkedIntArray m_newValues;
+};
+
+
+
+#endif // EDITDRAWCURVEACTION_H
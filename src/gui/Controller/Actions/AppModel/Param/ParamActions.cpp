@@ -0,0 +1,13 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "ParamActions.h"
+
+#include "EditDrawCurveAction.h"
+
+void ParamActions::editDrawCurve(DsDrawCurve *curve, int startTick, const QList<int> &values,
+                                 DsParams::ParamType paramType,
+                                 DsParam::ParamCurveType curveType, DsSingingClip *clip) {
+    addAction(EditDrawCurveAction::build(curve, startTick, values, paramType, curveType, clip));
+}
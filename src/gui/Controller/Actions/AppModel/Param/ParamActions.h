@@ -0,0 +1,21 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef PARAMACTIONS_H
+#define PARAMACTIONS_H
+
+#include "Controller/History/ActionSequence.h"
+#include "Model/DsClip.h"
+
+class ParamActions : public ActionSequence {
+public:
+    // Draw a stroke of values from startTick on
+    void editDrawCurve(DsDrawCurve *curve, int startTick, const QList<int> &values,
+                       DsParams::ParamType paramType, DsParam::ParamCurveType curveType,
+                       DsSingingClip *clip);
+};
+
+
+
+#endif // PARAMACTIONS_H
@@ -3,6 +3,9 @@
 //
 
 #include "EditTempoAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 EditTempoAction *EditTempoAction::build(double oldTempo, double newTempo,AppModel *model) {
     auto a = new EditTempoAction;
     a->m_oldTempo = oldTempo;
@@ -15,4 +18,19 @@ void EditTempoAction::execute() {
 }
 void EditTempoAction::undo() {
     m_model->setTempo(m_oldTempo);
-}
\ No newline at end of file
+}
+qint64 EditTempoAction::memoryUsage() const {
+    return sizeof(EditTempoAction);
+}
+EditTempoAction *EditTempoAction::read(QDataStream &stream, JournalObjects &objects) {
+    Q_UNUSED(objects)
+    double oldTempo;
+    double newTempo;
+    stream >> oldTempo >> newTempo;
+    return build(oldTempo, newTempo, AppModel::instance());
+}
+bool EditTempoAction::write(QDataStream &stream, JournalObjects &objects) const {
+    Q_UNUSED(objects)
+    stream << static_cast<quint8>(ActionJournal::EditTempo) << m_oldTempo << m_newTempo;
+    return true;
+}
@@ -11,8 +11,11 @@
 class EditTempoAction final : public IAction {
 public:
     static EditTempoAction *build(double oldTempo, double newTempo, AppModel *model);
+    static EditTempoAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     double m_oldTempo = 0;
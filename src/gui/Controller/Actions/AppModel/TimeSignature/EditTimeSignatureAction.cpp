@@ -3,6 +3,9 @@
 //
 
 #include "EditTimeSignatureAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 EditTimeSignatureAction *EditTimeSignatureAction::build(AppModel::TimeSignature oldSig,
                                                         AppModel::TimeSignature newSig,
                                                         AppModel *model) {
@@ -17,4 +20,23 @@ void EditTimeSignatureAction::execute() {
 }
 void EditTimeSignatureAction::undo() {
     m_model->setTimeSignature(m_oldSig);
-}
\ No newline at end of file
+}
+qint64 EditTimeSignatureAction::memoryUsage() const {
+    return sizeof(EditTimeSignatureAction);
+}
+EditTimeSignatureAction *
+    EditTimeSignatureAction::read(QDataStream &stream, JournalObjects &objects) {
+    Q_UNUSED(objects)
+    AppModel::TimeSignature oldSig;
+    AppModel::TimeSignature newSig;
+    for (const auto sig : {&oldSig, &newSig})
+        stream >> sig->pos >> sig->numerator >> sig->denominator;
+    return build(oldSig, newSig, AppModel::instance());
+}
+bool EditTimeSignatureAction::write(QDataStream &stream, JournalObjects &objects) const {
+    Q_UNUSED(objects)
+    stream << static_cast<quint8>(ActionJournal::EditTimeSignature);
+    for (const auto sig : {&m_oldSig, &m_newSig})
+        stream << sig->pos << sig->numerator << sig->denominator;
+    return true;
+}
@@ -12,8 +12,11 @@ class EditTimeSignatureAction : public IAction {
 public:
     static EditTimeSignatureAction *build(AppModel::TimeSignature oldSig,
                                           AppModel::TimeSignature newSig, AppModel *model);
+    static EditTimeSignatureAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     AppModel::TimeSignature m_oldSig;
@@ -3,6 +3,10 @@
 //
 
 #include "AppendTrackAction.h"
+
+#include "Controller/History/ActionJournal.h"
+#include "TrackActions.h"
+
 AppendTrackAction *AppendTrackAction::build(DsTrack *track, AppModel *model) {
     auto a = new AppendTrackAction;
     a->m_track = track;
@@ -14,4 +18,22 @@ void AppendTrackAction::execute() {
 }
 void AppendTrackAction::undo() {
     m_model->removeTrack(m_track);
-}
\ No newline at end of file
+}
+qint64 AppendTrackAction::memoryUsage() const {
+    return sizeof(AppendTrackAction);
+}
+qint64 AppendTrackAction::ownedMemoryUsage(bool executed) const {
+    return executed ? 0 : m_track->memoryUsage();
+}
+void AppendTrackAction::discard(bool executed) {
+    if (!executed)
+        TrackActions::disposeTrack(m_track);
+}
+AppendTrackAction *AppendTrackAction::read(QDataStream &stream, JournalObjects &objects) {
+    return build(ActionJournal::readTrack(stream, objects), AppModel::instance());
+}
+bool AppendTrackAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::AppendTrack);
+    ActionJournal::writeTrack(stream, m_track, objects);
+    return true;
+}
@@ -11,8 +11,13 @@
 class AppendTrackAction final : public IAction {
 public:
     static AppendTrackAction *build(DsTrack *track, AppModel *model);
+    static AppendTrackAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    qint64 ownedMemoryUsage(bool executed) const override;
+    void discard(bool executed) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsTrack *m_track = nullptr;
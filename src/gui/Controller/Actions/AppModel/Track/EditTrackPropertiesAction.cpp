@@ -3,6 +3,9 @@
 //
 
 #include "EditTrackPropertiesAction.h"
+
+#include "Controller/History/ActionJournal.h"
+
 EditTrackPropertiesAction *EditTrackPropertiesAction::build(const DsTrack::TrackProperties &oldArgs,
                                                             const DsTrack::TrackProperties &newArgs,
                                                             DsTrack *track) {
@@ -29,4 +32,37 @@ void EditTrackPropertiesAction::undo() {
     control.setMute(m_oldArgs.mute);
     control.setSolo(m_oldArgs.solo);
     m_track->setControl(control);
-}
\ No newline at end of file
+}
+qint64 EditTrackPropertiesAction::memoryUsage() const {
+    return sizeof(EditTrackPropertiesAction) +
+           (m_oldArgs.name.size() + m_newArgs.name.size()) * sizeof(QChar);
+}
+bool EditTrackPropertiesAction::canMergeWith(const IAction *other) const {
+    auto action = dynamic_cast<const EditTrackPropertiesAction *>(other);
+    return action && action->m_track == m_track;
+}
+void EditTrackPropertiesAction::mergeWith(const IAction *other) {
+    m_newArgs = static_cast<const EditTrackPropertiesAction *>(other)->m_newArgs;
+}
+EditTrackPropertiesAction *
+    EditTrackPropertiesAction::read(QDataStream &stream, JournalObjects &objects) {
+    DsTrack::TrackProperties oldArgs;
+    DsTrack::TrackProperties newArgs;
+    for (const auto args : {&oldArgs, &newArgs})
+        stream >> args->name >> args->gain >> args->pan >> args->mute >> args->solo >>
+            args->index;
+    int trackId;
+    stream >> trackId;
+    auto track = objects.find<DsTrack>(trackId);
+    if (!track)
+        return nullptr;
+    return build(oldArgs, newArgs, track);
+}
+bool EditTrackPropertiesAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::EditTrackProperties);
+    for (const auto args : {&m_oldArgs, &m_newArgs})
+        stream << args->name << args->gain << args->pan << args->mute << args->solo
+               << args->index;
+    stream << objects.idOf(m_track);
+    return true;
+}
@@ -13,8 +13,13 @@ public:
     static EditTrackPropertiesAction *build(const DsTrack::TrackProperties &oldArgs,
                                             const DsTrack::TrackProperties &newArgs,
                                             DsTrack *track);
+    static EditTrackPropertiesAction *read(QDataStream &stream, JournalObjects &objects);
     void execute() override;
     void undo() override;
+    qint64 memoryUsage() const override;
+    bool canMergeWith(const IAction *other) const override;
+    void mergeWith(const IAction *other) override;
+    bool write(QDataStream &stream, JournalObjects &objects) const override;
 
 private:
     DsTrack::TrackProperties m_oldArgs;
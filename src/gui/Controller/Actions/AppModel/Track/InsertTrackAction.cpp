@@ -3,6 +3,10 @@
 //
 
 #include "InsertTrackAction.h"
+
+#include "Controller/History/ActionJournal.h"
+#include "TrackActions.h"
+
 InsertTrackAction *InsertTrackAction::build(DsTrack *track, int index, AppModel *model) {
     auto a = new InsertTrackAction;
     a->m_track = track;
@@ -15,4 +19,26 @@ void InsertTrackAction::execute() {
 }
 void InsertTrackAction::undo() {
     m_model->removeTrackAt(m_index);
-}
\ No newline at end of file
+}
+qint64 InsertTrackAction::memoryUsage() const {
+    return sizeof(InsertTrackAction);
+}
+qint64 InsertTrackAction::ownedMemoryUsage(bool executed) const {
+    return executed ? 0 : m_track->memoryUsage();
+}
+void InsertTrackAction::discard(bool executed) {
+    if (!executed)
+        TrackActions::disposeTrack(m_track);
+}
+InsertTrackAction *InsertTrackAction::read(QDataStream &stream, JournalObjects &objects) {
+    auto track = ActionJournal::readTrack(stream, objects);
+    int index;
+    stream >> index;
+    return build(track, index, AppModel::instance());
+}
+bool InsertTrackAction::write(QDataStream &stream, JournalObjects &objects) const {
+    stream << static_cast<quint8>(ActionJournal::InsertTrack);
+    ActionJournal::writeTrack(stream, m_track, objects);
+    stream << m_index;
+    return true;
+}
@@ -3,6 +3,10 @@
 //
 
 #include "RemoveTrackAction.h"
+
+#include "Controller/History/ActionJournal.h"
+#include "TrackActions.h"
+
 RemoveTrackAction *RemoveTrackAction::build(DsTrack *track, AppModel *model) {
     auto a = new RemoveTrackAction;
     a->m_track = track;
@@ -17,4 +21,42 @@ void RemoveTrackAction::undo() {
     m_model->clearTracks();
     for (const auto track : m_originalTracks)
         m_model->appendTrack(track);
-}
\ No newline at end of file
+}
+qint64 RemoveTrackAction::memoryUsage() const {
+    return sizeof(RemoveTrackAction) + m_originalTracks.count() * sizeof(DsTrack *);
+}
+qint64 RemoveTrackAction::ownedMemoryUsage(bool executed) const {
+    return executed ? m_track->memoryUsage() : 0;
+}
+void RemoveTrackAction::discard(bool executed) {
+    if (executed)
+        TrackActions::disposeTrack(m_track);
+}
+RemoveTrackAction *RemoveTrackAction::read(QDataStream &stream, JournalObjects &objects) {
+    int trackId;
+    QList<int> originalTrackIds;
+    stream >> trackId >> originalTrackIds;
+    auto track = objects.find<DsTrack>(trackId);
+    if (!track)
+        return nullptr;
+    QList<DsTrack *> originalTracks;
+    for (const auto id : originalTrackIds) {
+        auto originalTrack = objects.find<DsTrack>(id);
+        if (!originalTrack)
+            return nullptr;
+        originalTracks.append(originalTrack);
+    }
+    auto a = new RemoveTrackAction;
+    a->m_track = track;
+    a->m_model = AppModel::instance();
+    a->m_originalTracks = originalTracks;
+    return a;
+}
+bool RemoveTrackAction::write(QDataStream &stream, JournalObjects &objects) const {
+    QList<int> originalTrackIds;
+    for (const auto track : m_originalTracks)
+        originalTrackIds.append(objects.idOf(track));
+    stream << static_cast<quint8>(ActionJournal::RemoveTrack) << objects.idOf(m_track)
+           << originalTrackIds;
+    return true;
+}
@@ -9,6 +9,7 @@
 #include "EditTrackPropertiesAction.h"
 #include "InsertTrackAction.h"
 #include "RemoveTrackAction.h"
+#include "../Clip/ClipActions.h"
 void TrackActions::appendTracks(const QList<DsTrack *> &tracks, AppModel *model) {
     for (auto track : tracks)
         addAction(AppendTrackAction::build(track, model));
@@ -23,4 +24,12 @@ void TrackActions::removeTracks(const QList<DsTrack *> &tracks, AppModel *model)
 void TrackActions::editTrackProperties(const DsTrack::TrackProperties &oldArgs,
                                        const DsTrack::TrackProperties &newArgs, DsTrack *track) {
     addAction(EditTrackPropertiesAction::build(oldArgs, newArgs, track));
-}
\ No newline at end of file
+}
+void TrackActions::disposeTrack(DsTrack *track) {
+    QList<DsClip *> clips;
+    for (const auto clip : track->clips())
+        clips.append(clip);
+    delete track;
+    for (const auto clip : clips)
+        ClipActions::disposeClip(clip);
+}
@@ -15,6 +15,9 @@ public:
     void removeTracks(const QList<DsTrack *> &tracks, AppModel *model);
     void editTrackProperties(const DsTrack::TrackProperties &oldArgs,
                              const DsTrack::TrackProperties &newArgs, DsTrack *track);
+
+    // Deletes a track that is no longer in the model, with its clips
+    static void disposeTrack(DsTrack *track);
 };
 
 
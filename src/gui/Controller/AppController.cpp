@@ -10,27 +10,87 @@
 #include "g2pglobal.h"
 #include "mandarin.h"
 #include "syllable2p.h"
+#include "Controller/AutoSaver.h"
 #include "Controller/History/HistoryManager.h"
+#include "Utils/ProjectConverters/MidiConverter.h"
+#include "Utils/ProjectConverters/ProjectLoader.h"
 #include "Actions/AppModel/Tempo/TempoActions.h"
 #include "Actions/AppModel/TimeSignature/TimeSignatureActions.h"
+#include "Actions/AppModel/Track/TrackActions.h"
 
+AppController::AppController() : m_autoSaver(new AutoSaver(this)) {
+}
 void AppController::onNewProject() {
     AppModel::instance()->newProject();
     HistoryManager::instance()->reset();
     m_lastProjectPath = "";
+    m_autoSaver->setProjectPath(m_lastProjectPath);
 }
 void AppController::openProject(const QString &filePath) {
-    AppModel::instance()->loadProject(filePath);
-    HistoryManager::instance()->reset();
-    m_lastProjectPath = filePath;
+    loadProject(filePath, filePath);
+}
+void AppController::loadProject(const QString &filePath, const QString &projectPath) {
+    // A project still loading is dropped for the new one. Its signals may already be queued,
+    // so the handlers check that they come from the current loader.
+    if (m_projectLoader)
+        m_projectLoader->cancel();
+    auto loader = new ProjectLoader(filePath, this);
+    m_projectLoader = loader;
+    connect(loader, &ProjectLoader::progressChanged, this, [=](int percent) {
+        if (loader == m_projectLoader)
+            emit openProjectProgressChanged(percent);
+    });
+    connect(loader, &ProjectLoader::outlineLoaded, this, [=] {
+        if (loader == m_projectLoader)
+            emit openProjectOutlineLoaded(loader->outline());
+    });
+    connect(loader, &ProjectLoader::clipLoaded, this, [=](int outlineClipId, DsClip *clip) {
+        if (loader == m_projectLoader)
+            emit openProjectClipLoaded(outlineClipId, clip);
+    });
+    connect(loader, &ProjectLoader::finished, this,
+            [=] { onProjectLoaded(loader, projectPath); });
+    emit openProjectStarted(projectPath);
+    loader->start();
+}
+void AppController::cancelOpenProject() {
+    if (!m_projectLoader)
+        return;
+    // Dropped at once, so that the signals it has queued already are ignored. It is freed
+    // once its thread has finished.
+    m_projectLoader->cancel();
+    m_projectLoader = nullptr;
+    emit openProjectFinished(false);
 }
 void AppController::saveProject(const QString &filePath) {
     if (AppModel::instance()->saveProject(filePath)) {
+        HistoryManager::instance()->restartJournal(filePath);
         m_lastProjectPath = filePath;
+        m_autoSaver->setProjectPath(m_lastProjectPath);
+        m_autoSaver->removeAutoSave();
     }
 }
 void AppController::importMidiFile(const QString &filePath) {
-    AppModel::instance()->importMidiFile(filePath);
+    auto importMode = MidiConverter::midiImportHandler();
+    if (importMode == -1)
+        return;
+    auto model = AppModel::instance();
+    QList<DsTrack *> tracks;
+    model->importMidiFile(filePath, importMode, tracks);
+    if (importMode == IProjectConverter::NewProject) {
+        // Replaced like by an import of a project, which the history cannot undo
+        HistoryManager::instance()->reset();
+        m_lastProjectPath = "";
+        m_autoSaver->setProjectPath(m_lastProjectPath);
+        return;
+    }
+    if (tracks.isEmpty())
+        return;
+    // Appended as an edit, so that the journal knows the tracks later edits refer to
+    auto actions = new TrackActions;
+    actions->appendTracks(tracks, model);
+    actions->execute();
+    HistoryManager::instance()->record(actions);
 }
 void AppController::exportMidiFile(const QString &filePath) {
     AppModel::instance()->exportMidiFile(filePath);
@@ -39,6 +99,7 @@ void AppController::importAproject(const QString &filePath) {
     AppModel::instance()->importAProject(filePath);
     HistoryManager::instance()->reset();
     m_lastProjectPath = "";
+    m_autoSaver->setProjectPath(m_lastProjectPath);
 }
 void AppController::onRunG2p() {
     auto model = AppModel::instance();
@@ -47,7 +108,7 @@ void AppController::onRunG2p() {
     auto singingClip = dynamic_cast<DsSingingClip *>(firstClip);
     if (singingClip == nullptr)
         return;
-    auto notes = singingClip->notes();
+    const auto &notes = singingClip->notes();
     IKg2p::setDictionaryPath(qApp->applicationDirPath() + "/dict");
 
     auto g2p_man = new IKg2p::Mandarin();
@@ -99,6 +160,52 @@ void AppController::onSetQuantize(int quantize) {
 void AppController::onTrackSelectionChanged(int trackIndex) {
     AppModel::instance()->setSelectedTrack(trackIndex);
 }
+void AppController::onProjectLoaded(ProjectLoader *loader, const QString &projectPath) {
+    loader->deleteLater();
+    if (loader != m_projectLoader)
+        return;
+    m_projectLoader = nullptr;
+    if (!loader->isSuccessful()) {
+        if (!loader->isCancelled())
+            qWarning() << "Failed to open project" << loader->path() << loader->errorString();
+        emit openProjectFinished(false);
+        return;
+    }
+    auto model = AppModel::instance();
+    model->replaceProject(loader->tempo(), loader->timeSignature(), loader->takeTracks());
+    auto history = HistoryManager::instance();
+    history->reset();
+    // Before the journal, whose edits are not in the file
+    m_autoSaver->setProjectPath(projectPath);
+    m_lastProjectPath = projectPath;
+    if (loader->path() != projectPath) {
+        // Recovered from the autosave. The journal only holds edits to the saved file, so
+        // none is kept until the project is saved, and the autosave stays as it is.
+        emit openProjectFinished(true);
+        return;
+    }
+    // Brings back the edits made after the last save, e.g. before a crash
+    history->openJournal(projectPath);
+    emit openProjectFinished(true);
+    // The journal holds every edit the autosave does, unless it was lost or written for
+    // another state of the file
+    if (!history->canUndo() && !history->canRedo() && AutoSaver::hasNewerAutoSave(projectPath))
+        offerAutoSave(projectPath);
+    else
+        m_autoSaver->removeAutoSave();
+}
+void AppController::offerAutoSave(const QString &projectPath) {
+    QMessageBox msgBox;
+    msgBox.setText("Recover autosave");
+    msgBox.setInformativeText("This project has an autosave with changes that were not saved. "
+                              "Do you want to open it?");
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::Yes);
+    if (msgBox.exec() == QMessageBox::Yes)
+        loadProject(AutoSaver::pathOf(projectPath), projectPath);
+    else
+        m_autoSaver->removeAutoSave();
+}
 bool AppController::isPowerOf2(int num) {
     return num > 0 && ((num & (num - 1)) == 0);
 }
@@ -10,18 +10,24 @@
 #include "Utils/Singleton.h"
 #include "Views/TracksView.h"
 
+class AutoSaver;
+class ProjectLoader;
+
 class AppController final : public QObject, public Singleton<AppController>{
     Q_OBJECT
 
 public:
-    explicit AppController() = default;
+    explicit AppController();
     ~AppController() override = default;
 
     QString lastProjectPath() const;
 
 public slots:
     void onNewProject();
+    // Loads the project in the background. The current project stays until the new one is
+    // loaded and replaces it in one step.
     void openProject(const QString &filePath);
+    void cancelOpenProject();
     void saveProject(const QString &filePath);
     void importMidiFile(const QString &filePath);
     void exportMidiFile(const QString &filePath);
@@ -32,10 +38,26 @@ public slots:
     void onSetQuantize(int quantize);
     void onTrackSelectionChanged(int trackIndex);
 
+signals:
+    void openProjectStarted(const QString &filePath);
+    void openProjectProgressChanged(int percent);
+    // Tracks and clip bounds of the project being opened, valid until openProjectFinished()
+    void openProjectOutlineLoaded(const QList<DsTrack *> &tracks);
+    // A clip of the outline with its notes and curves, valid until openProjectFinished()
+    void openProjectClipLoaded(int outlineClipId, DsClip *clip);
+    void openProjectFinished(bool success);
+
 private:
     bool isPowerOf2(int num);
+    // Loads filePath in the background as the project at projectPath
+    void loadProject(const QString &filePath, const QString &projectPath);
+    void onProjectLoaded(ProjectLoader *loader, const QString &projectPath);
+    // Asks whether to open the autosave of projectPath in place of the file just opened
+    void offerAutoSave(const QString &projectPath);
 
     QString m_lastProjectPath;
+    ProjectLoader *m_projectLoader = nullptr;
+    AutoSaver *m_autoSaver;
 };
 
 // using ControllerSingleton = Singleton<Controller>;
@@ -0,0 +1,114 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "AutoSaver.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include "Model/AppModel.h"
+
+AutoSaveWriter::~AutoSaveWriter() {
+    stop();
+}
+void AutoSaveWriter::save(const AppModelSnapshotPtr &snapshot, const QString &path) {
+    QMutexLocker locker(&m_mutex);
+    m_pendingSnapshot = snapshot;
+    m_pendingPath = path;
+    m_condition.wakeOne();
+}
+void AutoSaveWriter::remove(const QString &path) {
+    save(nullptr, path);
+}
+void AutoSaveWriter::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+void AutoSaveWriter::run() {
+    forever {
+        AppModelSnapshotPtr snapshot;
+        QString path;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_pendingPath.isEmpty() && !m_stopping)
+                m_condition.wait(&m_mutex);
+            if (m_stopping)
+                break;
+            snapshot.swap(m_pendingSnapshot);
+            path.swap(m_pendingPath);
+        }
+        if (!snapshot) {
+            QFile::remove(path);
+            continue;
+        }
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly) || !m_encoder.write(*snapshot, file) ||
+            !file.commit())
+            qWarning() << "AutoSaver: failed to write" << path << file.errorString();
+    }
+}
+
+AutoSaver::AutoSaver(QObject *parent) : QObject(parent) {
+    m_timer.setInterval(DefaultInterval);
+    connect(&m_timer, &QTimer::timeout, this, &AutoSaver::autoSave);
+    m_writer.start(QThread::LowPriority);
+    // AppController, which owns the saver, is a static singleton destroyed after the
+    // application, so the thread is ended while the application still runs
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+            &AutoSaver::stop);
+}
+AutoSaver::~AutoSaver() {
+    m_writer.stop();
+}
+QString AutoSaver::pathOf(const QString &projectPath) {
+    return projectPath + ".autosave";
+}
+bool AutoSaver::hasNewerAutoSave(const QString &projectPath) {
+    QFileInfo autoSave(pathOf(projectPath));
+    return autoSave.exists() && autoSave.lastModified() > QFileInfo(projectPath).lastModified();
+}
+void AutoSaver::setProjectPath(const QString &projectPath) {
+    m_projectPath = projectPath;
+    m_savedSnapshot = AppModel::instance()->snapshot();
+    if (m_projectPath.isEmpty()) {
+        m_timer.stop();
+        return;
+    }
+    m_timer.start();
+}
+void AutoSaver::removeAutoSave() {
+    if (!m_projectPath.isEmpty())
+        m_writer.remove(pathOf(m_projectPath));
+}
+int AutoSaver::interval() const {
+    return m_timer.interval();
+}
+void AutoSaver::setInterval(int msec) {
+    m_timer.setInterval(msec);
+}
+void AutoSaver::autoSave() {
+    auto snapshot = AppModel::instance()->snapshot();
+    if (m_projectPath.isEmpty() || !snapshot)
+        return;
+    if (m_savedSnapshot && snapshot->tracks == m_savedSnapshot->tracks &&
+        snapshot->tempo == m_savedSnapshot->tempo &&
+        snapshot->numerator == m_savedSnapshot->numerator &&
+        snapshot->denominator == m_savedSnapshot->denominator)
+        return;
+    m_savedSnapshot = snapshot;
+    m_writer.save(snapshot, pathOf(m_projectPath));
+}
+void AutoSaver::stop() {
+    m_projectPath.clear();
+    m_timer.stop();
+    m_writer.stop();
+}
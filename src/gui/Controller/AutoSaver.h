@@ -0,0 +1,85 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef AUTOSAVER_H
+#define AUTOSAVER_H
+
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include <QWaitCondition>
+
+#include "Model/AppModelSnapshot.h"
+#include "Utils/ProjectConverters/DspxSnapshotEncoder.h"
+
+// Encodes and writes snapshots on a background thread. Only the latest request counts: one
+// made while a write is in progress replaces any other still waiting.
+class AutoSaveWriter final : public QThread {
+public:
+    ~AutoSaveWriter() override;
+    void save(const AppModelSnapshotPtr &snapshot, const QString &path);
+    // Removes the file at path once the write in progress is done
+    void remove(const QString &path);
+    // Waits for the write in progress and ends the thread. A request still waiting is
+    // dropped.
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    // A request waits while the path is not empty. Without a snapshot it is a removal.
+    QString m_pendingPath;
+    AppModelSnapshotPtr m_pendingSnapshot;
+    bool m_stopping = false;
+    DspxSnapshotEncoder m_encoder;
+};
+
+// Saves the open project in the background to "<project>.autosave", a dspx document that
+// opens like any project. AppController offers to open it instead of the project when it is
+// newer and the edit journal brought nothing back.
+//
+// Every interval the snapshot of the model (see AppModel::snapshot()) is compared with the
+// one saved last. Snapshots share the tracks and clips that did not change, so comparing
+// them is cheap and the tracks and clips they do not share are the ones changed since. If
+// there are any, the snapshot is handed to the writer, which only encodes those again, and
+// writes the file through a temporary one renamed over it. The GUI thread only passes a
+// pointer on, so editing goes on during the save.
+class AutoSaver final : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr int DefaultInterval = 30 * 1000;
+
+    explicit AutoSaver(QObject *parent = nullptr);
+    ~AutoSaver() override;
+
+    static QString pathOf(const QString &projectPath);
+    // Whether the project at projectPath has an autosave written after the file
+    static bool hasNewerAutoSave(const QString &projectPath);
+    // Autosaves the project at projectPath from now on, or nothing for an empty path. Only
+    // changes made to the model after this call are saved.
+    void setProjectPath(const QString &projectPath);
+    // Removes the autosave of the current project, e.g. once the project has been saved
+    void removeAutoSave();
+    int interval() const;
+    void setInterval(int msec);
+    // Saves now if anything changed
+    void autoSave();
+    // Stops autosaving for good and ends the writer thread. Called when the application is
+    // about to quit, as the saver itself may outlive it.
+    void stop();
+
+private:
+    QTimer m_timer;
+    AutoSaveWriter m_writer;
+    QString m_projectPath;
+    AppModelSnapshotPtr m_savedSnapshot;
+};
+
+
+
+#endif // AUTOSAVER_H
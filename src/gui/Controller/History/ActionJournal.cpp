@@ -0,0 +1,571 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "ActionJournal.h"
+
+#include "ActionSequence.h"
+#include "Controller/Actions/AppModel/Clip/EditClipCommonPropertiesAction.h"
+#include "Controller/Actions/AppModel/Clip/EditSingingClipPropertiesAction.h"
+#include "Controller/Actions/AppModel/Clip/InsertClipAction.h"
+#include "Controller/Actions/AppModel/Clip/RemoveClipAction.h"
+#include "Controller/Actions/AppModel/Note/EditNotePositionAction.h"
+#include "Controller/Actions/AppModel/Note/EditNoteStartAndLengthAction.h"
+#include "Controller/Actions/AppModel/Note/EditNotesLengthAction.h"
+#include "Controller/Actions/AppModel/Note/EditNotesWordPropertiesAction.h"
+#include "Controller/Actions/AppModel/Note/InsertNoteAction.h"
+#include "Controller/Actions/AppModel/Note/RemoveNoteAction.h"
+#include "Controller/Actions/AppModel/Param/EditDrawCurveAction.h"
+#include "Controller/Actions/AppModel/Tempo/EditTempoAction.h"
+#include "Controller/Actions/AppModel/TimeSignature/EditTimeSignatureAction.h"
+#include "Controller/Actions/AppModel/Track/AppendTrackAction.h"
+#include "Controller/Actions/AppModel/Track/EditTrackPropertiesAction.h"
+#include "Controller/Actions/AppModel/Track/InsertTrackAction.h"
+#include "Controller/Actions/AppModel/Track/RemoveTrackAction.h"
+#include "Model/AppModel.h"
+
+namespace {
+    constexpr quint32 Magic = 0x44534A4C; // "DSJL"
+    constexpr quint16 Version = 2;
+    constexpr int RecordHeaderSize = sizeof(quint32) + sizeof(quint16);
+
+    quint16 checksumOf(const QByteArray &data) {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        return qChecksum(QByteArrayView(data));
+#else
+        return qChecksum(data.constData(), data.size());
+#endif
+    }
+
+    // Sequence rebuilt from the journal
+    class ReplayedSequence final : public ActionSequence {
+    public:
+        using ActionSequence::addAction;
+    };
+
+    void writeCurves(QDataStream &stream, const OverlapableSerialList<DsCurve> &curves) {
+        stream << static_cast<qint32>(curves.count());
+        for (const auto curve : curves) {
+            stream << static_cast<qint32>(curve->type()) << curve->start();
+            if (curve->type() == DsCurve::Draw) {
+                stream << dynamic_cast<DsDrawCurve *>(curve)->values();
+            } else if (curve->type() == DsCurve::Anchor) {
+                const auto &nodes = dynamic_cast<DsAnchorCurve *>(curve)->nodes();
+                stream << static_cast<qint32>(nodes.count());
+                for (const auto node : nodes)
+                    stream << node->pos() << node->value()
+                           << static_cast<qint32>(node->interpMode());
+            }
+        }
+    }
+
+    void readCurves(QDataStream &stream, OverlapableSerialList<DsCurve> &curves,
+                    DsSingingClip *clip) {
+        qint32 count;
+        stream >> count;
+        for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+            qint32 type;
+            int start;
+            stream >> type >> start;
+            DsCurve *curve;
+            if (type == DsCurve::Draw) {
+                auto drawCurve = clip->createDrawCurve();
+                QList<int> values;
+                stream >> values;
+                drawCurve->setValues(values);
+                curve = drawCurve;
+            } else if (type == DsCurve::Anchor) {
+                auto anchorCurve = clip->createAnchorCurve();
+                qint32 nodeCount;
+                stream >> nodeCount;
+                for (int j = 0; j < nodeCount && stream.status() == QDataStream::Ok; j++) {
+                    int pos;
+                    int value;
+                    qint32 interpMode;
+                    stream >> pos >> value >> interpMode;
+                    auto node = clip->createAnchorNode(pos, value);
+                    node->setInterpMode(static_cast<DsAnchorNode::InterpMode>(interpMode));
+                    anchorCurve->insertNode(node);
+                }
+                curve = anchorCurve;
+            } else
+                // The model has no generic curves
+                continue;
+            curve->setStart(start);
+            curves.add(curve);
+        }
+    }
+}
+
+void JournalObjects::clear() {
+    m_ids.clear();
+    m_objects.clear();
+    m_nextId = 0;
+}
+int JournalObjects::assignModel(const AppModel &model) {
+    int count = 0;
+    for (const auto track : model.tracks()) {
+        idOf(track);
+        count++;
+        for (const auto clip : track->clips()) {
+            idOf(clip);
+            count++;
+            if (clip->type() != DsClip::Singing)
+                continue;
+            for (const auto note : dynamic_cast<DsSingingClip *>(clip)->notes()) {
+                idOf(note);
+                count++;
+            }
+        }
+    }
+    return count;
+}
+int JournalObjects::idOf(const UniqueObject *object) {
+    auto it = m_ids.constFind(object->id());
+    if (it != m_ids.cend())
+        return it.value();
+    auto journalId = m_nextId++;
+    m_ids.insert(object->id(), journalId);
+    m_objects.insert(journalId, const_cast<UniqueObject *>(object));
+    return journalId;
+}
+void JournalObjects::add(int journalId, UniqueObject *object) {
+    m_ids.insert(object->id(), journalId);
+    m_objects.insert(journalId, object);
+    m_nextId = qMax(m_nextId, journalId + 1);
+}
+
+ActionJournalWriter::ActionJournalWriter(QFile *file) : m_file(file) {
+}
+ActionJournalWriter::~ActionJournalWriter() {
+    stop();
+    delete m_file;
+}
+void ActionJournalWriter::append(const QByteArray &record) {
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(record);
+    m_condition.wakeOne();
+}
+void ActionJournalWriter::stop() {
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+void ActionJournalWriter::run() {
+    forever {
+        QByteArray data;
+        bool stopping;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_pending.isEmpty() && !m_stopping)
+                m_condition.wait(&m_mutex);
+            data.swap(m_pending);
+            stopping = m_stopping;
+        }
+        if (!data.isEmpty()) {
+            // Everything queued during the previous sync goes out with one write and one sync
+            if (m_file->write(data) != data.size())
+                qWarning() << "ActionJournal: failed to write" << m_file->fileName();
+            m_file->flush();
+#ifdef Q_OS_WIN
+            _commit(m_file->handle());
+#else
+            fsync(m_file->handle());
+#endif
+        }
+        if (stopping)
+            break;
+    }
+}
+
+ActionJournal::~ActionJournal() {
+    delete m_writer;
+}
+QString ActionJournal::pathOf(const QString &projectPath) {
+    return projectPath + ".journal";
+}
+bool ActionJournal::open(const QString &projectPath, const AppModel &model,
+                         const Replayer &replayer) {
+    m_objects.clear();
+    auto expected = headerOf(projectPath, m_objects.assignModel(model));
+
+    auto file = new QFile(pathOf(projectPath));
+    if (!file->open(QIODevice::ReadWrite)) {
+        delete file;
+        return false;
+    }
+    QDataStream stream(file);
+    quint32 magic = 0;
+    quint16 version = 0;
+    Header header;
+    stream >> magic >> version >> header.projectSize >> header.projectModified >>
+        header.objectCount;
+    if (stream.status() != QDataStream::Ok || magic != Magic || version != Version ||
+        header.projectSize != expected.projectSize ||
+        header.projectModified != expected.projectModified ||
+        header.objectCount != expected.objectCount) {
+        // Written for another state of the project file
+        delete file;
+        return start(projectPath, model);
+    }
+
+    auto end = replay(*file, replayer);
+    if (end < file->size())
+        file->resize(end);
+    file->seek(end);
+    startWriter(file);
+    return true;
+}
+bool ActionJournal::start(const QString &projectPath, const AppModel &model) {
+    delete m_writer;
+    m_writer = nullptr;
+    m_undoDepth = 0;
+    m_redoDepth = 0;
+    m_objects.clear();
+    auto header = headerOf(projectPath, m_objects.assignModel(model));
+
+    auto file = new QFile(pathOf(projectPath));
+    if (!file->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "ActionJournal: failed to open" << file->fileName();
+        delete file;
+        return false;
+    }
+    QDataStream stream(file);
+    stream << Magic << Version << header.projectSize << header.projectModified
+           << header.objectCount;
+    file->flush();
+    startWriter(file);
+    return true;
+}
+bool ActionJournal::isRecording() const {
+    return m_writer && !m_replaying;
+}
+JournalObjects &ActionJournal::objects() {
+    return m_objects;
+}
+void ActionJournal::appendSequence(const ActionSequence *actions, bool merged) {
+    if (!isRecording())
+        return;
+    if (!actions->isJournaled()) {
+        suspend();
+        return;
+    }
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << static_cast<quint8>(merged ? MergedSequence : Sequence)
+           << static_cast<quint32>(actions->count());
+    payload.append(actions->journalData());
+    append(payload);
+    if (!merged)
+        m_undoDepth++;
+    m_redoDepth = 0;
+}
+void ActionJournal::appendUndo() {
+    if (!isRecording())
+        return;
+    if (m_undoDepth == 0) {
+        suspend();
+        return;
+    }
+    QByteArray payload;
+    QDataStream(&payload, QIODevice::WriteOnly) << static_cast<quint8>(Undo);
+    append(payload);
+    m_undoDepth--;
+    m_redoDepth++;
+}
+void ActionJournal::appendRedo() {
+    if (!isRecording())
+        return;
+    if (m_redoDepth == 0) {
+        suspend();
+        return;
+    }
+    QByteArray payload;
+    QDataStream(&payload, QIODevice::WriteOnly) << static_cast<quint8>(Redo);
+    append(payload);
+    m_redoDepth--;
+    m_undoDepth++;
+}
+void ActionJournal::writeNote(QDataStream &stream, const DsNote *note, JournalObjects &objects) {
+    auto phonemes = note->phonemes();
+    stream << objects.idOf(note) << note->start() << note->length() << note->keyIndex()
+           << note->lyric() << note->pronunciation();
+    writePhonemes(stream, phonemes.original);
+    writePhonemes(stream, phonemes.edited);
+}
+DsNote *ActionJournal::readNote(QDataStream &stream, JournalObjects &objects,
+                                DsSingingClip *clip) {
+    int journalId;
+    int start;
+    int length;
+    int keyIndex;
+    QString lyric;
+    QString pronunciation;
+    stream >> journalId >> start >> length >> keyIndex >> lyric >> pronunciation;
+    auto note = clip->createNote(start, length, keyIndex, lyric);
+    note->setPronunciation(pronunciation);
+    note->setPhonemes(DsPhonemes::Original, readPhonemes(stream));
+    note->setPhonemes(DsPhonemes::Edited, readPhonemes(stream));
+    objects.add(journalId, note);
+    return note;
+}
+void ActionJournal::writeClip(QDataStream &stream, const DsClip *clip, JournalObjects &objects) {
+    stream << objects.idOf(clip) << static_cast<qint32>(clip->type()) << clip->name()
+           << clip->start() << clip->length() << clip->clipStart() << clip->clipLen()
+           << clip->gain() << clip->mute();
+    if (clip->type() == DsClip::Audio) {
+        stream << dynamic_cast<const DsAudioClip *>(clip)->path();
+    } else if (clip->type() == DsClip::Singing) {
+        auto singingClip = dynamic_cast<const DsSingingClip *>(clip);
+        stream << static_cast<qint32>(singingClip->notes().count());
+        for (const auto note : singingClip->notes())
+            writeNote(stream, note, objects);
+        const auto &params = singingClip->params;
+        for (const auto param : {&params.pitch, &params.energy, &params.tension,
+                                 &params.breathiness})
+            for (const auto layer : {&param->original, &param->edited, &param->envelope})
+                writeCurves(stream, *layer);
+    }
+}
+DsClip *ActionJournal::readClip(QDataStream &stream, JournalObjects &objects) {
+    int journalId;
+    qint32 type;
+    stream >> journalId >> type;
+    DsClip *clip;
+    if (type == DsClip::Audio)
+        clip = new DsAudioClip;
+    else if (type == DsClip::Singing)
+        clip = new DsSingingClip;
+    else
+        clip = new DsClip;
+
+    QString name;
+    int start;
+    int length;
+    int clipStart;
+    int clipLen;
+    double gain;
+    bool mute;
+    stream >> name >> start >> length >> clipStart >> clipLen >> gain >> mute;
+    clip->setName(name);
+    clip->setStart(start);
+    clip->setLength(length);
+    clip->setClipStart(clipStart);
+    clip->setClipLen(clipLen);
+    clip->setGain(gain);
+    clip->setMute(mute);
+
+    if (type == DsClip::Audio) {
+        QString path;
+        stream >> path;
+        dynamic_cast<DsAudioClip *>(clip)->setPath(path);
+    } else if (type == DsClip::Singing) {
+        auto singingClip = dynamic_cast<DsSingingClip *>(clip);
+        qint32 noteCount;
+        stream >> noteCount;
+        for (int i = 0; i < noteCount && stream.status() == QDataStream::Ok; i++)
+            singingClip->insertNote(readNote(stream, objects, singingClip));
+        auto &params = singingClip->params;
+        for (const auto param : {&params.pitch, &params.energy, &params.tension,
+                                 &params.breathiness})
+            for (const auto layer : {&param->original, &param->edited, &param->envelope})
+                readCurves(stream, *layer, singingClip);
+    }
+    objects.add(journalId, clip);
+    return clip;
+}
+void ActionJournal::writeTrack(QDataStream &stream, const DsTrack *track,
+                               JournalObjects &objects) {
+    auto control = track->control();
+    stream << objects.idOf(track) << track->name() << control.gain() << control.pan()
+           << control.mute() << control.solo() << track->color().rgba()
+           << static_cast<qint32>(track->clips().count());
+    for (const auto clip : track->clips())
+        writeClip(stream, clip, objects);
+}
+DsTrack *ActionJournal::readTrack(QDataStream &stream, JournalObjects &objects) {
+    int journalId;
+    QString name;
+    double gain;
+    double pan;
+    bool mute;
+    bool solo;
+    QRgb color;
+    qint32 clipCount;
+    stream >> journalId >> name >> gain >> pan >> mute >> solo >> color >> clipCount;
+    auto track = new DsTrack;
+    track->setName(name);
+    DsTrackControl control;
+    control.setGain(gain);
+    control.setPan(pan);
+    control.setMute(mute);
+    control.setSolo(solo);
+    track->setControl(control);
+    track->setColor(QColor::fromRgba(color));
+    for (int i = 0; i < clipCount && stream.status() == QDataStream::Ok; i++)
+        track->insertClip(readClip(stream, objects));
+    objects.add(journalId, track);
+    return track;
+}
+void ActionJournal::writePhonemes(QDataStream &stream, const QList<DsPhoneme> &phonemes) {
+    stream << static_cast<qint32>(phonemes.count());
+    for (const auto &phoneme : phonemes)
+        stream << static_cast<qint32>(phoneme.type) << phoneme.name.toString() << phoneme.start;
+}
+QList<DsPhoneme> ActionJournal::readPhonemes(QDataStream &stream) {
+    QList<DsPhoneme> phonemes;
+    qint32 count;
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+        qint32 type;
+        QString name;
+        int start;
+        stream >> type >> name >> start;
+        phonemes.append({static_cast<DsPhoneme::DsPhonemeType>(type), name, start});
+    }
+    return phonemes;
+}
+void ActionJournal::writeClipProperties(QDataStream &stream,
+                                        const DsClip::ClipCommonProperties &properties) {
+    stream << properties.name << properties.start << properties.length << properties.clipStart
+           << properties.clipLen << properties.gain << properties.mute << properties.trackIndex;
+}
+void ActionJournal::readClipProperties(QDataStream &stream,
+                                       DsClip::ClipCommonProperties &properties) {
+    stream >> properties.name >> properties.start >> properties.length >> properties.clipStart >>
+        properties.clipLen >> properties.gain >> properties.mute >> properties.trackIndex;
+}
+IAction *ActionJournal::readAction(QDataStream &stream, JournalObjects &objects) {
+    quint8 type;
+    stream >> type;
+    switch (type) {
+        case InsertNote:
+            return InsertNoteAction::read(stream, objects);
+        case RemoveNote:
+            return RemoveNoteAction::read(stream, objects);
+        case EditNotePosition:
+            return EditNotePositionAction::read(stream, objects);
+        case EditNoteStartAndLength:
+            return EditNoteStartAndLengthAction::read(stream, objects);
+        case EditNotesLength:
+            return EditNotesLengthAction::read(stream, objects);
+        case EditNotesWordProperties:
+            return EditNotesWordPropertiesAction::read(stream, objects);
+        case InsertClip:
+            return InsertClipAction::read(stream, objects);
+        case RemoveClip:
+            return RemoveClipAction::read(stream, objects);
+        case EditClipCommonProperties:
+            return EditClipCommonPropertiesAction::read(stream, objects);
+        case EditSingingClipProperties:
+            return EditSingingClipPropertiesAction::read(stream, objects);
+        case AppendTrack:
+            return AppendTrackAction::read(stream, objects);
+        case InsertTrack:
+            return InsertTrackAction::read(stream, objects);
+        case RemoveTrack:
+            return RemoveTrackAction::read(stream, objects);
+        case EditTrackProperties:
+            return EditTrackPropertiesAction::read(stream, objects);
+        case EditTempo:
+            return EditTempoAction::read(stream, objects);
+        case EditTimeSignature:
+            return EditTimeSignatureAction::read(stream, objects);
+        case EditDrawCurve:
+            return EditDrawCurveAction::read(stream, objects);
+        default:
+            return nullptr;
+    }
+}
+ActionJournal::Header ActionJournal::headerOf(const QString &projectPath, int objectCount) {
+    QFileInfo info(projectPath);
+    Header header;
+    header.projectSize = info.size();
+    header.projectModified = info.lastModified().toMSecsSinceEpoch();
+    header.objectCount = objectCount;
+    return header;
+}
+void ActionJournal::startWriter(QFile *file) {
+    m_writer = new ActionJournalWriter(file);
+    m_writer->start(QThread::LowPriority);
+}
+void ActionJournal::suspend() {
+    // Records after this point could not be replayed, so the journal stays as it is
+    delete m_writer;
+    m_writer = nullptr;
+}
+void ActionJournal::append(const QByteArray &payload) {
+    QByteArray record;
+    record.reserve(RecordHeaderSize + payload.size());
+    QDataStream stream(&record, QIODevice::WriteOnly);
+    stream << static_cast<quint32>(payload.size()) << checksumOf(payload);
+    record.append(payload);
+    m_writer->append(record);
+}
+qint64 ActionJournal::replay(QFile &file, const Replayer &replayer) {
+    m_replaying = true;
+    auto end = file.pos();
+    forever {
+        auto header = file.read(RecordHeaderSize);
+        if (header.size() < RecordHeaderSize)
+            break;
+        quint32 size;
+        quint16 checksum;
+        QDataStream(header) >> size >> checksum;
+        auto payload = file.read(size);
+        if (payload.size() != static_cast<int>(size) || checksumOf(payload) != checksum)
+            break;
+
+        QDataStream stream(payload);
+        quint8 type;
+        stream >> type;
+        if (type == Sequence || type == MergedSequence) {
+            quint32 count;
+            stream >> count;
+            auto actions = new ReplayedSequence;
+            for (quint32 i = 0; i < count; i++) {
+                auto action = readAction(stream, m_objects);
+                if (!action || stream.status() != QDataStream::Ok) {
+                    delete action;
+                    break;
+                }
+                actions->addAction(action);
+            }
+            if (actions->count() != static_cast<int>(count)) {
+                qWarning() << "ActionJournal: unreadable sequence in" << file.fileName();
+                delete actions;
+                break;
+            }
+            replayer.sequence(actions, type == MergedSequence);
+            if (type == Sequence)
+                m_undoDepth++;
+            m_redoDepth = 0;
+        } else if (type == Undo && m_undoDepth > 0) {
+            replayer.undo();
+            m_undoDepth--;
+            m_redoDepth++;
+        } else if (type == Redo && m_redoDepth > 0) {
+            replayer.redo();
+            m_redoDepth--;
+            m_undoDepth++;
+        } else
+            break;
+        end = file.pos();
+    }
+    m_replaying = false;
+    return end;
+}
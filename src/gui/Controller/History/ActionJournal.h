@@ -0,0 +1,178 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef ACTIONJOURNAL_H
+#define ACTIONJOURNAL_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "Model/DsClip.h"
+
+class ActionSequence;
+class AppModel;
+class DsTrack;
+class IAction;
+
+// Ids of the tracks, clips and notes referred to by the journal.
+//
+// Runtime ids change from one session to the next, so the journal numbers objects itself:
+// the objects of the project get consecutive ids in model order when the journal starts (and
+// again, in the same order, when it is replayed on the reloaded project), and objects created
+// later get the next free id the first time they are written.
+class JournalObjects {
+public:
+    void clear();
+    // Numbers the tracks, clips and notes of model. Returns the number of objects.
+    int assignModel(const AppModel &model);
+
+    // Journal id of object, assigned on first use
+    int idOf(const UniqueObject *object);
+    // Registers an object created while reading the journal
+    void add(int journalId, UniqueObject *object);
+    template <typename T>
+    T *find(int journalId) const {
+        return dynamic_cast<T *>(m_objects.value(journalId));
+    }
+
+private:
+    QHash<int, int> m_ids; // runtime id -> journal id
+    QHash<int, UniqueObject *> m_objects;
+    int m_nextId = 0;
+};
+
+// Appends journal records to the file on a background thread. Records queued while a write
+// is in progress are written and synced to disk together (group commit).
+class ActionJournalWriter final : public QThread {
+public:
+    // Takes ownership of file, which must be open for writing
+    explicit ActionJournalWriter(QFile *file);
+    ~ActionJournalWriter() override;
+    void append(const QByteArray &record);
+    // Writes what is queued and ends the thread
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    QFile *m_file;
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QByteArray m_pending;
+    bool m_stopping = false;
+};
+
+// Append-only binary journal of the history of a project, kept next to it as
+// "<project>.journal".
+//
+// It holds every sequence recorded since the project was last saved, and the undo and redo
+// steps in between. Replaying it on top of the saved project restores both the unsaved edits
+// after a crash and the undo stack of the previous session. Records are written when an
+// action sequence is built, before it runs, so inserted objects are stored as they were
+// before the edit.
+//
+// File layout: header (magic, version, size and modification time of the project file,
+// number of objects in it), then records of [quint32 size][quint16 checksum][payload]. A torn
+// record at the end, from a crash during a write, is dropped on replay.
+//
+// The journal only follows the history it recorded: undoing past its first sequence (e.g. an
+// edit made before the last save) stops it until the next save, so that a replay always
+// reproduces a state that really existed.
+class ActionJournal {
+public:
+    enum RecordType : quint8 { Sequence = 1, MergedSequence, Undo, Redo };
+    enum ActionType : quint8 {
+        InsertNote = 1,
+        RemoveNote,
+        EditNotePosition,
+        EditNoteStartAndLength,
+        EditNotesLength,
+        EditNotesWordProperties,
+        InsertClip,
+        RemoveClip,
+        EditClipCommonProperties,
+        EditSingingClipProperties,
+        AppendTrack,
+        InsertTrack,
+        RemoveTrack,
+        EditTrackProperties,
+        EditTempo,
+        EditTimeSignature,
+        EditDrawCurve
+    };
+
+    class Replayer {
+    public:
+        // merged tells whether the sequence was merged into the previous entry
+        std::function<void(ActionSequence *actions, bool merged)> sequence;
+        std::function<void()> undo;
+        std::function<void()> redo;
+    };
+
+    ~ActionJournal();
+
+    static QString pathOf(const QString &projectPath);
+
+    // Opens the journal of the project just loaded into model and replays its records, if it
+    // was written for the same project file. Otherwise starts a new one.
+    bool open(const QString &projectPath, const AppModel &model, const Replayer &replayer);
+    // Starts a new journal for the project just saved from model
+    bool start(const QString &projectPath, const AppModel &model);
+
+    // Whether sequences built now are written
+    bool isRecording() const;
+    JournalObjects &objects();
+    // A sequence that was not fully written when it was built suspends the journal
+    void appendSequence(const ActionSequence *actions, bool merged);
+    void appendUndo();
+    void appendRedo();
+
+    // Object and action codecs, used by the actions
+    static void writeNote(QDataStream &stream, const DsNote *note, JournalObjects &objects);
+    // The note is allocated by clip
+    static DsNote *readNote(QDataStream &stream, JournalObjects &objects, DsSingingClip *clip);
+    static void writeClip(QDataStream &stream, const DsClip *clip, JournalObjects &objects);
+    static DsClip *readClip(QDataStream &stream, JournalObjects &objects);
+    static void writeTrack(QDataStream &stream, const DsTrack *track, JournalObjects &objects);
+    static DsTrack *readTrack(QDataStream &stream, JournalObjects &objects);
+    static void writePhonemes(QDataStream &stream, const QList<DsPhoneme> &phonemes);
+    static QList<DsPhoneme> readPhonemes(QDataStream &stream);
+    static void writeClipProperties(QDataStream &stream,
+                                    const DsClip::ClipCommonProperties &properties);
+    static void readClipProperties(QDataStream &stream, DsClip::ClipCommonProperties &properties);
+    static IAction *readAction(QDataStream &stream, JournalObjects &objects);
+
+private:
+    class Header {
+    public:
+        qint64 projectSize = 0;
+        qint64 projectModified = 0;
+        qint32 objectCount = 0;
+    };
+
+    static Header headerOf(const QString &projectPath, int objectCount);
+    void startWriter(QFile *file);
+    void suspend();
+    void append(const QByteArray &payload);
+    // Returns the size of the valid part of the records. Replay stops at the first record that
+    // cannot be read or refers to an object that does not exist.
+    qint64 replay(QFile &file, const Replayer &replayer);
+
+    JournalObjects m_objects;
+    ActionJournalWriter *m_writer = nullptr;
+    bool m_replaying = false;
+    // Entries of the undo and redo stacks the journal knows of
+    int m_undoDepth = 0;
+    int m_redoDepth = 0;
+};
+
+#endif // ACTIONJOURNAL_H
@@ -3,17 +3,82 @@
 //
 
 #include "ActionSequence.h"
+
+#include <QDataStream>
+
+#include "ActionJournal.h"
+#include "HistoryManager.h"
+#include "Model/AppModel.h"
+
+ActionSequence::~ActionSequence() {
+    qDeleteAll(m_actionSequence);
+}
 void ActionSequence::execute() {
+    // Listeners see the whole sequence as one change
+    AppModel::beginBatch();
     for (const auto action : m_actionSequence)
         action->execute();
+    AppModel::endBatch();
 }
 void ActionSequence::undo() {
+    AppModel::beginBatch();
     for (int i = m_actionSequence.count() - 1; i >= 0; i--)
         m_actionSequence[i]->undo();
+    AppModel::endBatch();
 }
-int ActionSequence::count() {
+int ActionSequence::count() const {
     return m_actionSequence.count();
 }
+qint64 ActionSequence::memoryUsage(bool executed) {
+    if (m_memoryUsage < 0 || m_memoryUsageExecuted != executed) {
+        m_memoryUsage = sizeof(ActionSequence) + m_actionSequence.count() * sizeof(IAction *);
+        for (const auto action : m_actionSequence)
+            m_memoryUsage += action->memoryUsage() + action->ownedMemoryUsage(executed);
+        m_memoryUsageExecuted = executed;
+    }
+    return m_memoryUsage;
+}
+void ActionSequence::discard(bool executed) {
+    // Objects an action creates may belong to objects created by the actions before it, so
+    // an undone sequence frees them last action first
+    if (executed) {
+        for (const auto action : m_actionSequence)
+            action->discard(executed);
+    } else {
+        for (int i = m_actionSequence.count() - 1; i >= 0; i--)
+            m_actionSequence[i]->discard(executed);
+    }
+}
+bool ActionSequence::canMergeWith(const ActionSequence *other) const {
+    if (m_actionSequence.count() != other->m_actionSequence.count())
+        return false;
+    for (int i = 0; i < m_actionSequence.count(); i++)
+        if (!m_actionSequence.at(i)->canMergeWith(other->m_actionSequence.at(i)))
+            return false;
+    return true;
+}
+void ActionSequence::mergeWith(const ActionSequence *other) {
+    for (int i = 0; i < m_actionSequence.count(); i++)
+        m_actionSequence.at(i)->mergeWith(other->m_actionSequence.at(i));
+    m_memoryUsage = -1;
+}
+const QByteArray &ActionSequence::journalData() const {
+    return m_journalData;
+}
+bool ActionSequence::isJournaled() const {
+    return m_journaledCount == m_actionSequence.count();
+}
 void ActionSequence::addAction(IAction *action) {
+    // Written before the sequence runs, so that inserted objects are stored as they are now
+    auto journal = HistoryManager::instance()->journal();
+    if (journal && journal->isRecording() && isJournaled()) {
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        if (action->write(stream, journal->objects())) {
+            m_journalData.append(data);
+            m_journaledCount++;
+        }
+    }
     m_actionSequence.append(action);
+    m_memoryUsage = -1;
 }
\ No newline at end of file
@@ -5,19 +5,39 @@
 #ifndef ACTIONSEQUENCE_H
 #define ACTIONSEQUENCE_H
 
+#include <QByteArray>
 #include <QList>
 
 #include "IAction.h"
 
 class ActionSequence {
 public:
+    virtual ~ActionSequence();
     void execute();
     void undo();
-    int count();
+    int count() const;
+    // Approximate bytes held in the given state, including the model objects the actions are
+    // the only holders of then (see IAction::ownedMemoryUsage). Cached until the sequence
+    // changes or is asked about the other state.
+    qint64 memoryUsage(bool executed);
+    void discard(bool executed);
+    // Sequences merge when they hold the same number of actions and each action can merge
+    // with the one at the same index of other
+    bool canMergeWith(const ActionSequence *other) const;
+    void mergeWith(const ActionSequence *other);
+    // Actions written to the edit journal as they were added, see ActionJournal
+    const QByteArray &journalData() const;
+    bool isJournaled() const;
 
 protected:
     QList<IAction *> m_actionSequence;
     void addAction(IAction *action);
+
+private:
+    qint64 m_memoryUsage = -1;
+    bool m_memoryUsageExecuted = true;
+    QByteArray m_journalData;
+    int m_journaledCount = 0;
 };
 
 
@@ -3,35 +3,58 @@
 //
 
 #include "HistoryManager.h"
+
+#include "Model/AppModel.h"
+
+HistoryManager::~HistoryManager() {
+    // Writes out what is still queued
+    closeJournal();
+}
 void HistoryManager::undo() {
     if (m_undoStack.isEmpty())
         return;
 
-    auto seq = m_undoStack.pop();
-    seq->undo();
-    m_redoStack.push(seq);
+    undoLast();
+    if (m_journal)
+        m_journal->appendUndo();
+    evictOverBudget();
+    AppModel::instance()->publishSnapshot();
     emit undoRedoChanged(canUndo(), canRedo());
 }
 void HistoryManager::redo() {
     if (m_redoStack.isEmpty())
         return;
 
-    auto seq = m_redoStack.pop();
-    seq->execute();
-    m_undoStack.push(seq);
+    redoLast();
+    if (m_journal)
+        m_journal->appendRedo();
+    evictOverBudget();
+    AppModel::instance()->publishSnapshot();
     emit undoRedoChanged(canUndo(), canRedo());
 }
 void HistoryManager::record(ActionSequence *actions) {
-    if (actions->count() <= 0)
+    if (actions->count() <= 0) {
+        delete actions;
         return;
+    }
 
-    m_undoStack.push(actions);
-    m_redoStack.clear();
+    auto merge = canMerge(actions);
+    if (m_journal)
+        m_journal->appendSequence(actions, merge);
+    push(actions, merge);
+    m_mergeTimer.start();
+    evictOverBudget();
+    AppModel::instance()->publishSnapshot();
     emit undoRedoChanged(canUndo(), canRedo());
 }
 void HistoryManager::reset() {
+    closeJournal();
+    m_mergeTarget = nullptr;
+    clearRedoStack();
+    // Oldest first, so that each object is freed by the last entry that touched it
+    for (const auto actions : m_undoStack)
+        discard(actions, true);
     m_undoStack.clear();
-    m_redoStack.clear();
     emit undoRedoChanged(canUndo(), canRedo());
 }
 bool HistoryManager::canUndo() const {
@@ -39,4 +62,106 @@ bool HistoryManager::canUndo() const {
 }
 bool HistoryManager::canRedo() const {
     return !m_redoStack.isEmpty();
+}
+qint64 HistoryManager::memoryUsage() const {
+    return m_memoryUsage;
+}
+qint64 HistoryManager::memoryBudget() const {
+    return m_memoryBudget;
+}
+void HistoryManager::setMemoryBudget(qint64 bytes) {
+    m_memoryBudget = bytes;
+    evictOverBudget();
+    emit undoRedoChanged(canUndo(), canRedo());
+}
+void HistoryManager::openJournal(const QString &projectPath) {
+    closeJournal();
+    m_journal = new ActionJournal;
+    ActionJournal::Replayer replayer;
+    replayer.sequence = [this](ActionSequence *actions, bool merged) {
+        actions->execute();
+        push(actions, merged && m_mergeTarget);
+    };
+    replayer.undo = [this] { undoLast(); };
+    replayer.redo = [this] { redoLast(); };
+    // Nothing is evicted during the replay, so that every undo and redo finds its entry
+    m_journal->open(projectPath, *AppModel::instance(), replayer);
+    evictOverBudget();
+    AppModel::instance()->publishSnapshot();
+    emit undoRedoChanged(canUndo(), canRedo());
+}
+void HistoryManager::restartJournal(const QString &projectPath) {
+    if (!m_journal)
+        m_journal = new ActionJournal;
+    m_journal->start(projectPath, *AppModel::instance());
+}
+ActionJournal *HistoryManager::journal() const {
+    return m_journal;
+}
+int HistoryManager::mergeWindow() const {
+    return m_mergeWindow;
+}
+void HistoryManager::setMergeWindow(int ms) {
+    m_mergeWindow = ms;
+}
+void HistoryManager::discard(ActionSequence *actions, bool executed) {
+    if (actions == m_mergeTarget)
+        m_mergeTarget = nullptr;
+    m_memoryUsage -= actions->memoryUsage(executed);
+    actions->discard(executed);
+    delete actions;
+}
+void HistoryManager::clearRedoStack() {
+    // The top of the redo stack is the oldest edit undone and the bottom the newest. Newest
+    // first, so that the notes of an undone InsertNote are freed before the clip of an undone
+    // InsertClip they belong to.
+    for (int i = 0; i < m_redoStack.count(); i++)
+        discard(m_redoStack.at(i), false);
+    m_redoStack.clear();
+}
+void HistoryManager::evictOverBudget() {
+    // The bottom of the redo stack is the newest edit undone, and the farthest from being
+    // redone
+    while (m_memoryUsage > m_memoryBudget && m_redoStack.count() > 1)
+        discard(m_redoStack.takeFirst(), false);
+    while (m_memoryUsage > m_memoryBudget && m_undoStack.count() > 1)
+        discard(m_undoStack.takeFirst(), true);
+}
+bool HistoryManager::canMerge(const ActionSequence *actions) const {
+    return m_mergeTarget && m_mergeTimer.isValid() && m_mergeTimer.elapsed() <= m_mergeWindow &&
+           m_mergeTarget->canMergeWith(actions);
+}
+void HistoryManager::push(ActionSequence *actions, bool merge) {
+    if (merge) {
+        m_memoryUsage -= m_mergeTarget->memoryUsage(true);
+        m_mergeTarget->mergeWith(actions);
+        m_memoryUsage += m_mergeTarget->memoryUsage(true);
+        delete actions;
+    } else {
+        m_undoStack.push(actions);
+        m_memoryUsage += actions->memoryUsage(true);
+        m_mergeTarget = actions;
+    }
+    clearRedoStack();
+}
+void HistoryManager::undoLast() {
+    m_mergeTarget = nullptr;
+    auto seq = m_undoStack.pop();
+    // What the entry owns changes with the state, e.g. an undone insert owns its object
+    m_memoryUsage -= seq->memoryUsage(true);
+    seq->undo();
+    m_redoStack.push(seq);
+    m_memoryUsage += seq->memoryUsage(false);
+}
+void HistoryManager::redoLast() {
+    m_mergeTarget = nullptr;
+    auto seq = m_redoStack.pop();
+    m_memoryUsage -= seq->memoryUsage(false);
+    seq->execute();
+    m_undoStack.push(seq);
+    m_memoryUsage += seq->memoryUsage(true);
+}
+void HistoryManager::closeJournal() {
+    delete m_journal;
+    m_journal = nullptr;
 }
\ No newline at end of file
@@ -5,30 +5,75 @@
 #ifndef HISTORYMANAGER_H
 #define HISTORYMANAGER_H
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QStack>
 
+#include "ActionJournal.h"
 #include "ActionSequence.h"
 #include "Utils/Singleton.h"
 
+// Owns the recorded action sequences. Sequences dropped from the history (redo entries
+// replaced by a new record, entries evicted to stay within the memory budget, everything on
+// reset) are discarded and deleted, which also frees model objects only they kept alive.
 class HistoryManager final : public QObject, public Singleton<HistoryManager> {
     Q_OBJECT
 
 public:
+    ~HistoryManager() override;
+
     void undo();
     void redo();
+    // Takes ownership of actions
     void record(ActionSequence *actions);
     void reset();
 
     bool canUndo() const;
     bool canRedo() const;
 
+    // Approximate bytes held by the undo and redo stacks
+    qint64 memoryUsage() const;
+    qint64 memoryBudget() const;
+    // While the history is over budget, the newest redo entries are evicted first and then
+    // the oldest undo entries. The next entry to undo and the next to redo are always kept.
+    void setMemoryBudget(qint64 bytes);
+
+    // A sequence recorded within this many milliseconds of the previous one is merged into
+    // it when possible (see ActionSequence::canMergeWith), so a slider drag or repeated
+    // nudges make one entry. 0 disables merging.
+    int mergeWindow() const;
+    void setMergeWindow(int ms);
+
+    // Opens the edit journal of the project just loaded and replays the unsaved edits it
+    // holds, which also restores the undo and redo stacks. See ActionJournal.
+    void openJournal(const QString &projectPath);
+    // Starts a new journal after the project was saved
+    void restartJournal(const QString &projectPath);
+    ActionJournal *journal() const;
+
 signals:
     void undoRedoChanged(bool canUndo, bool canRedo);
 
 private:
+    void discard(ActionSequence *actions, bool executed);
+    void clearRedoStack();
+    void evictOverBudget();
+    bool canMerge(const ActionSequence *actions) const;
+    // Pushes actions onto the undo stack or merges them into its top
+    void push(ActionSequence *actions, bool merge);
+    void undoLast();
+    void redoLast();
+    void closeJournal();
+
     QStack<ActionSequence *> m_undoStack;
     QStack<ActionSequence *> m_redoStack;
+    qint64 m_memoryUsage = 0;
+    qint64 m_memoryBudget = 64 * 1024 * 1024;
+    int m_mergeWindow = 1000;
+    // Top of the undo stack if it was recorded last and can still take merges
+    ActionSequence *m_mergeTarget = nullptr;
+    QElapsedTimer m_mergeTimer;
+    ActionJournal *m_journal = nullptr;
 };
 
 
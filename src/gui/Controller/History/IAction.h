@@ -5,10 +5,48 @@
 #ifndef IACTION_H
 #define IACTION_H
 
+#include <QtGlobal>
+
+class JournalObjects;
+class QDataStream;
+
 class IAction {
 public:
     virtual void execute() = 0;
     virtual void undo() = 0;
+    // Approximate bytes held by the action itself
+    virtual qint64 memoryUsage() const = 0;
+    // Approximate bytes of the model objects the action is the only holder of in the given
+    // state (see discard), such as a removed note while executed or an inserted one while
+    // undone
+    virtual qint64 ownedMemoryUsage(bool executed) const {
+        Q_UNUSED(executed)
+        return 0;
+    }
+    // Called by the history right before the action is deleted. executed tells whether the
+    // model is in the state after execute() (the action was on the undo stack) or after
+    // undo() (redo stack). An action that is then the only holder of a model object, such
+    // as a removed note, deletes it here.
+    virtual void discard(bool executed) {
+        Q_UNUSED(executed)
+    }
+    // Whether other, executed right after this action, can be folded into it so that the
+    // merged action goes from the state before this one to the state after other
+    virtual bool canMergeWith(const IAction *other) const {
+        Q_UNUSED(other)
+        return false;
+    }
+    // Only called when canMergeWith(other) returned true. other is deleted afterwards.
+    virtual void mergeWith(const IAction *other) {
+        Q_UNUSED(other)
+    }
+    // Writes the action to the edit journal (see ActionJournal) as it is built, starting with
+    // its ActionJournal::ActionType. Actions that can not be journaled return false.
+    virtual bool write(QDataStream &stream, JournalObjects &objects) const {
+        Q_UNUSED(stream)
+        Q_UNUSED(objects)
+        return false;
+    }
     virtual ~IAction() = default;
 };
 
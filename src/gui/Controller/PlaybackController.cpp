@@ -24,6 +24,9 @@ double PlaybackController::lastPosition() const {
 double PlaybackController::tempo() const {
     return m_tempo;
 }
+const TickSampleConverter &PlaybackController::timeConverter() const {
+    return m_timeConverter;
+}
 
 void PlaybackController::play() {
     m_playbackStatus = Playing;
@@ -50,16 +53,15 @@ void PlaybackController::setLastPosition(double tick) {
 
 void PlaybackController::sampleRateChanged(double sr) {
     m_sampleRate = sr;
+    m_timeConverter.set(m_tempo, m_sampleRate);
 }
 void PlaybackController::onTempoChanged(double tempo) {
     m_tempo = tempo;
+    m_timeConverter.set(m_tempo, m_sampleRate);
 }
-double PlaybackController::samplePosToTick(int sample) const {
-    auto secs = sample / m_sampleRate;
-    auto tick =  secs * 60 / m_tempo * 480;
-    return tick;
+double PlaybackController::samplePosToTick(qint64 sample) const {
+    return m_timeConverter.sampleToTick(sample);
 }
-int PlaybackController::tickToSamplePos(double tick) const {
-    auto pos = tick * m_tempo * m_sampleRate / 60 / 480;
-    return static_cast<int>(pos);
+qint64 PlaybackController::tickToSamplePos(double tick) const {
+    return m_timeConverter.tickToSample(tick);
 }
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <QObject>
 
 #include "Utils/Singleton.h"
+#include "Utils/TickSampleConverter.h"
 
 class PlaybackController final : public QObject, public Singleton<PlaybackController> {
     Q_OBJECT
@@ -27,6 +28,10 @@ public:
     double lastPosition() const;
 
     double tempo() const;
+    const TickSampleConverter &timeConverter() const;
+
+    double samplePosToTick(qint64 sample) const;
+    qint64 tickToSamplePos(double tick) const;
 
     // bool isPlaying() const;
     // long position() const;
@@ -55,9 +60,7 @@ private:
     double m_sampleRate = 48000;
     double m_tempo = 120;
     PlaybackStatus m_playbackStatus = Stopped;
-
-    double samplePosToTick(int sample) const;
-    int tickToSamplePos(double tick) const;
+    TickSampleConverter m_timeConverter{m_tempo, m_sampleRate};
 };
 
 
@@ -180,16 +180,16 @@ void TracksViewController::onRemoveClip(int clipId) {
     msgBox.setDefaultButton(QMessageBox::Yes);
     int ret = msgBox.exec();
     if (ret == QMessageBox::Yes) {
-        for (const auto &track : AppModel::instance()->tracks()) {
-            auto result = track->findClipById(clipId);
-            if (result != nullptr) {
-                auto a = new ClipActions;
-                QList<DsClip *> clips;
-                clips.append(result);
-                a->removeClips(clips, track);
-                a->execute();
-                HistoryManager::instance()->record(a);
-            }
+        int trackIndex;
+        auto result = AppModel::instance()->findClipById(clipId, trackIndex);
+        if (result != nullptr) {
+            auto track = AppModel::instance()->tracks().at(trackIndex);
+            auto a = new ClipActions;
+            QList<DsClip *> clips;
+            clips.append(result);
+            a->removeClips(clips, track);
+            a->execute();
+            HistoryManager::instance()->record(a);
         }
     }
 }
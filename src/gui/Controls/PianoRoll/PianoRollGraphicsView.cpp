@@ -55,19 +55,19 @@ void PianoRollGraphicsView::insertNote(DsNote *dsNote) {
     noteItem->setScaleY(scaleY());
     scene()->addItem(noteItem);
     connect(this, &PianoRollGraphicsView::scaleChanged, noteItem, &NoteGraphicsItem::setScale);
-    connect(this, &PianoRollGraphicsView::visibleRectChanged, noteItem,
-            &NoteGraphicsItem::setVisibleRect);
-    m_noteItems.append(noteItem);
+    // Note geometry does not depend on the visible rect, so scrolling must not touch every note
+    m_noteItems.insert(noteItem);
 }
 void PianoRollGraphicsView::removeNote(int noteId) {
     auto noteItem = findNoteById(noteId);
     scene()->removeItem(noteItem);
-    m_noteItems.removeOne(noteItem);
+    m_noteItems.remove(noteItem);
+    noteItem->deleteLater();
 }
 NoteGraphicsItem *PianoRollGraphicsView::findNoteById(int id) {
-    for (const auto note : m_noteItems)
-        if (note->id() == id)
-            return note;
+    auto noteItem = UniqueObject::find<NoteGraphicsItem>(id);
+    if (noteItem && m_noteItems.contains(noteItem))
+        return noteItem;
     return nullptr;
 }
 double PianoRollGraphicsView::keyIndexToSceneY(double index) const {
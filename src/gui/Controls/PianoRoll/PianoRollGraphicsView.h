@@ -5,6 +5,8 @@
 #ifndef PIANOROLLGRAPHICSVIEW_H
 #define PIANOROLLGRAPHICSVIEW_H
 
+#include <QSet>
+
 #include "Model/AppModel.h"
 #include "NoteGraphicsItem.h"
 #include "PianoRollGraphicsScene.h"
@@ -41,7 +43,7 @@ private:
 
     bool m_isSingingClipSelected = false;
     PianoRollEditMode m_mode = Select;
-    QList<NoteGraphicsItem *> m_noteItems;
+    QSet<NoteGraphicsItem *> m_noteItems;
 
     NoteGraphicsItem *findNoteById(int id);
     double keyIndexToSceneY(double index) const;
@@ -17,14 +17,20 @@ SingingClipGraphicsItem::SingingClipGraphicsItem(int itemId, QGraphicsItem *pare
 }
 void SingingClipGraphicsItem::loadNotes(const OverlapableSerialList<DsNote> &notes) {
     m_notes.clear();
-    if (notes.count() != 0) {
-        for (const auto &dsNote : notes) {
-            Note note;
-            note.rStart = dsNote->start() - start();
-            note.length = dsNote->length();
-            note.keyIndex = dsNote->keyIndex();
-            m_notes.append(note);
-        }
+    m_notes.reserve(notes.count());
+    // find lowest and highest pitch once here instead of on every paint
+    m_lowestKeyIndex = 127;
+    m_highestKeyIndex = 0;
+    m_maxNoteLength = 0;
+    for (const auto &dsNote : notes) {
+        Note note;
+        note.rStart = dsNote->start() - start();
+        note.length = dsNote->length();
+        note.keyIndex = dsNote->keyIndex();
+        m_notes.append(note);
+        m_lowestKeyIndex = qMin(m_lowestKeyIndex, note.keyIndex);
+        m_highestKeyIndex = qMax(m_highestKeyIndex, note.keyIndex);
+        m_maxNoteLength = qMax(m_maxNoteLength, note.length);
     }
     update();
 }
@@ -52,23 +58,19 @@ void SingingClipGraphicsItem::drawPreviewArea(QPainter *painter, const QRectF &p
     painter->setPen(Qt::NoPen);
     painter->setBrush(noteColor);
 
-    // find lowest and highest pitch
-    int lowestKeyIndex = 127;
-    int highestKeyIndex = 0;
-    for (const auto &note : m_notes) {
-        auto keyIndex = note.keyIndex;
-        if (keyIndex < lowestKeyIndex)
-            lowestKeyIndex = keyIndex;
-        if (keyIndex > highestKeyIndex)
-            highestKeyIndex = keyIndex;
-    }
-
+    int lowestKeyIndex = m_lowestKeyIndex;
+    int highestKeyIndex = m_highestKeyIndex;
     int divideCount = highestKeyIndex - lowestKeyIndex + 1;
     auto noteHeight = (rectHeight - rectTop) / divideCount;
 
-    for (const auto &note : m_notes) {
-        auto clipLeft = start() + clipStart();
-        auto clipRight = clipLeft + clipLen();
+    auto clipLeft = start() + clipStart();
+    auto clipRight = clipLeft + clipLen();
+    // Skip the notes that end before the visible part of the clip
+    auto first = std::lower_bound(m_notes.cbegin(), m_notes.cend(),
+                                  clipStart() - m_maxNoteLength,
+                                  [](const Note &note, int rStart) { return note.rStart < rStart; });
+    for (auto it = first; it != m_notes.cend(); ++it) {
+        const auto &note = *it;
         if (start() + note.rStart + note.length < clipLeft)
             continue;
         if (start() + note.rStart >= clipRight)
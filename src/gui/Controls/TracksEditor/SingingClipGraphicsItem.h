@@ -34,7 +34,10 @@ private:
     }
 
     QString m_audioCachePath;
-    QList<Note> m_notes;
+    QList<Note> m_notes; // sorted by rStart
+    int m_lowestKeyIndex = 127;
+    int m_highestKeyIndex = 0;
+    int m_maxNoteLength = 0;
 };
 
 
@@ -13,6 +13,7 @@
 #include "Controller/History/HistoryManager.h"
 #include "Utils/ProjectConverters/AProjectConverter.h"
 #include "Utils/ProjectConverters/DspxProjectConverter.h"
+#include "Utils/ProjectConverters/ProjectCache.h"
 #include "opendspx/qdspxtrack.h"
 #include "opendspx/qdspxtimeline.h"
 #include "Utils/ProjectConverters/MidiConverter.h"
@@ -39,15 +40,15 @@ const QList<DsTrack *> &AppModel::tracks() const {
 void AppModel::insertTrack(DsTrack *track, int index) {
     connect(track, &DsTrack::propertyChanged, this, [=] {
         auto trackIndex = m_tracks.indexOf(track);
-        emit tracksChanged(PropertyUpdate, trackIndex, track);
+        notifyTrackChanged(PropertyUpdate, trackIndex, track);
     });
     m_tracks.insert(index, track);
-    emit tracksChanged(Insert, index, track);
+    notifyTrackChanged(Insert, index, track);
 }
 void AppModel::insertTrackQuietly(DsTrack *track, int index) {
     connect(track, &DsTrack::propertyChanged, this, [=] {
         auto trackIndex = m_tracks.indexOf(track);
-        emit tracksChanged(PropertyUpdate, trackIndex, track);
+        notifyTrackChanged(PropertyUpdate, trackIndex, track);
     });
     m_tracks.insert(index, track);
 }
@@ -58,15 +59,17 @@ void AppModel::removeTrackAt(int index) {
     auto track = m_tracks[index];
     onSelectedClipChanged(-1);
     m_tracks.removeAt(index);
-    emit tracksChanged(Remove, index, track);
+    notifyTrackChanged(Remove, index, track);
 }
 void AppModel::removeTrack(DsTrack *track) {
     auto index = m_tracks.indexOf(track);
     removeTrackAt(index);
 }
 void AppModel::clearTracks() {
+    beginBatch();
     while (m_tracks.count() > 0)
         removeTrackAt(0);
+    endBatch();
 }
 int AppModel::quantize() const {
     return m_quantize;
@@ -82,22 +85,29 @@ void AppModel::newProject() {
     newTrack->setName("New Track");
     m_tracks.append(newTrack);
     emit modelChanged();
+    publishSnapshot();
 }
 
 bool AppModel::loadProject(const QString &filename) {
-    reset();
-    auto converter = new DspxProjectConverter;
+    ProjectCache cache;
+    if (cache.open(filename)) {
+        replaceProject(cache.tempo(), cache.timeSignature(), cache.readTracks());
+        return true;
+    }
+    DspxProjectConverter converter;
     QString errMsg;
     AppModel resultModel;
-    auto ok = converter->load(filename, this, errMsg);
+    auto ok = converter.load(filename, &resultModel, errMsg);
     if (ok)
         loadFromAppModel(resultModel);
     return ok;
 }
 bool AppModel::saveProject(const QString &filename) {
-    auto converter = new DspxProjectConverter;
+    DspxProjectConverter converter;
     QString errMsg;
-    auto ok = converter->save(filename, this, errMsg);
+    auto ok = converter.save(filename, this, errMsg);
+    if (ok)
+        ProjectCache::write(filename, *this);
     return ok;
 }
 bool AppModel::importAProject(const QString &filename) {
@@ -110,35 +120,36 @@ bool AppModel::importAProject(const QString &filename) {
     return ok;
 }
 void AppModel::loadFromAppModel(const AppModel &model) {
+    replaceProject(model.tempo(), model.timeSignature(), model.tracks());
+}
+void AppModel::replaceProject(double tempo, const TimeSignature &signature,
+                              const QList<DsTrack *> &tracks) {
     reset();
-    m_tempo = model.tempo();
-    m_timeSignature = model.timeSignature();
-    m_tracks = model.tracks();
+    m_tempo = tempo;
+    m_timeSignature = signature;
+    // Connects the tracks to this model rather than to the one they were loaded into
+    for (int i = 0; i < tracks.count(); i++)
+        insertTrackQuietly(tracks.at(i), i);
     emit modelChanged();
+    publishSnapshot();
 }
 
-bool AppModel::importMidiFile(const QString &filename) {
+bool AppModel::importMidiFile(const QString &filename, int importMode,
+                              QList<DsTrack *> &appendedTracks) {
     QString errMsg;
-    int midiImport = MidiConverter::midiImportHandler();
-
-    if (midiImport == ImportMode::NewProject) {
+    if (importMode == ImportMode::NewProject)
         reset();
-    } else if (midiImport == -1) {
-        errMsg = "User canceled the import.";
+    else if (importMode != ImportMode::AppendToProject)
         return false;
-    }
 
     AppModel resultModel;
     auto converter = new MidiConverter;
     auto ok = converter->load(filename, &resultModel, errMsg,
-                              static_cast<IProjectConverter::ImportMode>(midiImport));
-    if (midiImport == ImportMode::NewProject) {
+                              static_cast<IProjectConverter::ImportMode>(importMode));
+    if (importMode == ImportMode::NewProject)
         loadFromAppModel(resultModel);
-    } else if (midiImport == ImportMode::AppendToProject) {
-        for (auto track : resultModel.tracks()) {
-            appendTrack(track);
-        }
-    }
+    else
+        appendedTracks = resultModel.tracks();
     return ok;
 }
 
@@ -155,13 +166,11 @@ int AppModel::selectedTrackIndex() const {
 void AppModel::onSelectedClipChanged(int clipId) {
     qDebug() << "AppModel::setIsSingingClip" << clipId;
     m_selectedClipId = clipId;
-    auto found = false;
-    for (auto track : m_tracks) {
-        auto result = track->findClipById(clipId);
-        if (result) {
-            emit selectedClipChanged(track, result);
-            return;
-        }
+    int trackIndex;
+    auto clip = findClipById(clipId, trackIndex);
+    if (clip) {
+        emit selectedClipChanged(m_tracks.at(trackIndex), clip);
+        return;
     }
     emit selectedClipChanged(nullptr, nullptr);
 }
@@ -170,17 +179,44 @@ void AppModel::setSelectedTrack(int trackIndex) {
     emit selectedTrackChanged(trackIndex);
 }
 DsClip *AppModel::findClipById(int clipId, int &trackIndex) {
-    int i = 0;
-    for (auto track : m_tracks) {
-        auto result = track->findClipById(clipId);
-        if (result) {
+    auto clip = UniqueObject::find<DsClip>(clipId);
+    if (!clip)
+        return nullptr;
+    // The clip may be detached (e.g. removed and kept by the history), so check its owner
+    for (int i = 0; i < m_tracks.count(); i++)
+        if (m_tracks.at(i)->clips().contains(clip)) {
             trackIndex = i;
-            return result;
+            return clip;
         }
-        i++;
-    }
     return nullptr;
 }
+AppModelSnapshotPtr AppModel::snapshot() const {
+    return m_snapshot.load();
+}
+void AppModel::publishSnapshot() {
+    auto snapshot = AppModelSnapshot::build(*this, ++m_snapshotVersion, m_snapshot.load());
+    m_snapshot.store(snapshot);
+    emit snapshotPublished(m_snapshotVersion);
+}
+void AppModel::flushBatchedChanges() {
+    if (!m_tracksChangedInBatch)
+        return;
+    m_tracksChangedInBatch = false;
+    emit modelChanged();
+}
+void AppModel::discardBatchedChanges() {
+    m_tracksChangedInBatch = false;
+}
+void AppModel::notifyTrackChanged(TrackChangeType type, int index, DsTrack *track) {
+    if (isBatching()) {
+        // Views reload all tracks on modelChanged(), so pending clip and note changes are
+        // dropped
+        m_tracksChangedInBatch = true;
+        scheduleResetFlush();
+        return;
+    }
+    emit tracksChanged(type, index, track);
+}
 void AppModel::reset() {
     m_tempo = 120;
     m_timeSignature.numerator = 4;
@@ -5,10 +5,16 @@
 #ifndef DSPXMODEL_H
 #define DSPXMODEL_H
 
+#include "AppModelSnapshot.h"
+#include "BatchedNotifier.h"
 #include "DsTrack.h"
+#include "Utils/PublishedPointer.h"
 #include "Utils/Singleton.h"
 
-class AppModel final : public QObject, public Singleton<AppModel> {
+// Changes made between beginBatch() and endBatch() (inherited from BatchedNotifier) are
+// delivered once when the batch ends. Track insertions, removals and property updates in a
+// batch are announced by a single modelChanged() instead of tracksChanged().
+class AppModel final : public QObject, public Singleton<AppModel>, public BatchedNotifier {
     Q_OBJECT
 
 public:
@@ -41,18 +47,30 @@ public:
     void setQuantize(int quantize);
 
     void newProject();
-    bool importMidiFile(const QString &filename);
+    // Reads a MIDI file in importMode (see MidiConverter::midiImportHandler()). A new project
+    // replaces this one. The tracks read for an append are not added but returned in
+    // appendedTracks, for the caller to add as an edit.
+    bool importMidiFile(const QString &filename, int importMode,
+                        QList<DsTrack *> &appendedTracks);
     bool exportMidiFile(const QString &filename);
     bool loadProject(const QString &filename);
     bool saveProject(const QString &filename);
     bool importAProject(const QString &filename);
     void loadFromAppModel(const AppModel &model);
+    // Replaces the project in one step, announced by a single modelChanged() and snapshot
+    void replaceProject(double tempo, const TimeSignature &signature,
+                        const QList<DsTrack *> &tracks);
 
     int selectedTrackIndex() const;
     void setSelectedTrack(int trackIndex);
 
     DsClip *findClipById(int clipId, int &trackIndex);
 
+    // Latest published snapshot. Safe to call from any thread, and takes no lock.
+    AppModelSnapshotPtr snapshot() const;
+    // Publishes a snapshot of the current state with the next version. GUI thread only.
+    void publishSnapshot();
+
     class LevelMetersUpdatedArgs {
     public:
         class State {
@@ -74,9 +92,15 @@ signals:
     void selectedClipChanged(DsTrack *track, DsClip *clip);
     void quantizeChanged(int quantize);
     void selectedTrackChanged(int trackIndex);
+    void snapshotPublished(quint64 version);
+
+protected:
+    void flushBatchedChanges() override;
+    void discardBatchedChanges() override;
 
 private:
     void reset();
+    void notifyTrackChanged(TrackChangeType type, int index, DsTrack *track);
 
     TimeSignature m_timeSignature;
     double m_tempo = 120;
@@ -86,6 +110,10 @@ private:
     int m_selectedClipId = -1;
 
     int m_quantize = 16;
+    bool m_tracksChangedInBatch = false;
+
+    PublishedPointer<const AppModelSnapshot> m_snapshot;
+    quint64 m_snapshotVersion = 0;
 };
 
 
@@ -0,0 +1,145 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#include "AppModelSnapshot.h"
+
+#include "AppModel.h"
+
+std::shared_ptr<const AppModelSnapshot>
+    AppModelSnapshot::build(const AppModel &model, quint64 version,
+                            const std::shared_ptr<const AppModelSnapshot> &previous) {
+    QHash<int, std::shared_ptr<const TrackSnapshot>> previousTracks;
+    QHash<int, std::shared_ptr<const ClipSnapshot>> previousClips;
+    if (previous) {
+        for (const auto &track : previous->tracks) {
+            previousTracks.insert(track->id, track);
+            for (const auto &clip : track->clips)
+                previousClips.insert(clip->id, clip);
+        }
+    }
+
+    auto snapshot = std::make_shared<AppModelSnapshot>();
+    snapshot->version = version;
+    snapshot->tempo = model.tempo();
+    snapshot->numerator = model.timeSignature().numerator;
+    snapshot->denominator = model.timeSignature().denominator;
+    snapshot->tracks.reserve(model.tracks().count());
+    for (auto track : model.tracks())
+        snapshot->tracks.append(
+            buildTrack(track, previousTracks.value(track->id()), previousClips));
+    return snapshot;
+}
+std::shared_ptr<const TrackSnapshot>
+    AppModelSnapshot::buildTrack(DsTrack *track,
+                                 const std::shared_ptr<const TrackSnapshot> &previous,
+                                 const QHash<int, std::shared_ptr<const ClipSnapshot>> &previousClips) {
+    QVector<std::shared_ptr<const ClipSnapshot>> clips;
+    clips.reserve(track->clips().count());
+    for (auto clip : track->clips())
+        clips.append(buildClip(clip, previousClips.value(clip->id())));
+
+    // Clip property edits do not touch the track, so compare the clip subtrees as well
+    if (previous && previous->revision == track->revision() && previous->clips == clips)
+        return previous;
+
+    auto snapshot = std::make_shared<TrackSnapshot>();
+    snapshot->id = track->id();
+    snapshot->persistentId = track->persistentId();
+    snapshot->name = track->name();
+    snapshot->control = track->control();
+    snapshot->color = track->color();
+    snapshot->clips = clips;
+    snapshot->revision = track->revision();
+    return snapshot;
+}
+std::shared_ptr<const ClipSnapshot>
+    AppModelSnapshot::buildClip(DsClip *clip, const std::shared_ptr<const ClipSnapshot> &previous) {
+    auto singingClip = clip->type() == DsClip::Singing ? dynamic_cast<DsSingingClip *>(clip)
+                                                       : nullptr;
+    auto notesRevision = singingClip ? singingClip->noteStore().revision() : 0;
+    auto paramsRevision = singingClip ? singingClip->paramsRevision() : 0;
+    if (previous && previous->clipRevision == clip->revision() &&
+        previous->notesRevision == notesRevision && previous->paramsRevision == paramsRevision)
+        return previous;
+
+    auto snapshot = std::make_shared<ClipSnapshot>();
+    snapshot->id = clip->id();
+    snapshot->persistentId = clip->persistentId();
+    snapshot->type = clip->type();
+    snapshot->name = clip->name();
+    snapshot->start = clip->start();
+    snapshot->length = clip->length();
+    snapshot->clipStart = clip->clipStart();
+    snapshot->clipLen = clip->clipLen();
+    snapshot->gain = clip->gain();
+    snapshot->mute = clip->mute();
+    snapshot->clipRevision = clip->revision();
+    snapshot->notesRevision = notesRevision;
+    snapshot->paramsRevision = paramsRevision;
+
+    if (clip->type() == DsClip::Audio) {
+        snapshot->path = dynamic_cast<DsAudioClip *>(clip)->path();
+    } else if (singingClip) {
+        // Notes and params are shared separately, so editing notes keeps the params
+        if (previous && previous->notesRevision == notesRevision) {
+            snapshot->notes = previous->notes;
+        } else {
+            snapshot->notes.reserve(singingClip->notes().count());
+            for (auto note : singingClip->notes()) {
+                NoteSnapshot noteSnapshot;
+                noteSnapshot.id = note->id();
+                noteSnapshot.persistentId = note->persistentId();
+                noteSnapshot.start = note->start();
+                noteSnapshot.length = note->length();
+                noteSnapshot.keyIndex = note->keyIndex();
+                noteSnapshot.lyric = note->lyricSymbol();
+                noteSnapshot.pronunciation = note->pronunciationSymbol();
+                noteSnapshot.phonemes = note->phonemes();
+                snapshot->notes.append(noteSnapshot);
+            }
+        }
+        if (previous && previous->params && previous->paramsRevision == paramsRevision)
+            snapshot->params = previous->params;
+        else
+            snapshot->params = buildParams(singingClip->params);
+    }
+    return snapshot;
+}
+std::shared_ptr<const ParamsSnapshot> AppModelSnapshot::buildParams(const DsParams &params) {
+    auto snapshot = std::make_shared<ParamsSnapshot>();
+    snapshot->pitch = buildParam(params.pitch);
+    snapshot->energy = buildParam(params.energy);
+    snapshot->tension = buildParam(params.tension);
+    snapshot->breathiness = buildParam(params.breathiness);
+    return snapshot;
+}
+ParamSnapshot AppModelSnapshot::buildParam(const DsParam &param) {
+    ParamSnapshot snapshot;
+    snapshot.original = buildCurves(param.original);
+    snapshot.edited = buildCurves(param.edited);
+    snapshot.envelope = buildCurves(param.envelope);
+    return snapshot;
+}
+QVector<CurveSnapshot> AppModelSnapshot::buildCurves(const OverlapableSerialList<DsCurve> &curves) {
+    QVector<CurveSnapshot> snapshots;
+    snapshots.reserve(curves.count());
+    for (auto curve : curves) {
+        CurveSnapshot snapshot;
+        snapshot.type = curve->type();
+        snapshot.start = curve->start();
+        if (snapshot.type == DsCurve::Draw) {
+            auto drawCurve = dynamic_cast<DsDrawCurve *>(curve);
+            snapshot.step = drawCurve->valueStep();
+            snapshot.values.resize(drawCurve->valueCount());
+            drawCurve->readValues(0, drawCurve->valueCount(), snapshot.values.data());
+        } else if (snapshot.type == DsCurve::Anchor) {
+            auto anchorCurve = dynamic_cast<DsAnchorCurve *>(curve);
+            snapshot.nodes.reserve(anchorCurve->nodes().count());
+            for (auto node : anchorCurve->nodes())
+                snapshot.nodes.append({node->pos(), node->value(), node->interpMode()});
+        }
+        snapshots.append(snapshot);
+    }
+    return snapshots;
+}
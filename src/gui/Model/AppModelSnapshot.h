@@ -0,0 +1,132 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#ifndef APPMODELSNAPSHOT_H
+#define APPMODELSNAPSHOT_H
+
+#include <memory>
+
+#include <QColor>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "DsClip.h"
+#include "DsTrackControl.h"
+
+class AppModel;
+class DsTrack;
+
+// Immutable copy of the project for threads other than the GUI thread (audio, export,
+// synthesis).
+//
+// A snapshot is a tree of shared_ptr<const ...> nodes. When a new one is built, every
+// track, clip and params subtree whose model object did not change since the previous
+// snapshot is shared with it instead of copied, so publishing after an edit only costs the
+// edited clips. Readers keep the snapshot alive as long as they hold the pointer; nothing in
+// it is ever modified.
+class NoteSnapshot {
+public:
+    int id = -1;
+    quint64 persistentId = 0;
+    int start = 0;
+    int length = 0;
+    int keyIndex = 60;
+    Symbol lyric;
+    Symbol pronunciation;
+    DsPhonemes phonemes;
+};
+
+class CurveSnapshot {
+public:
+    class Node {
+    public:
+        int pos = 0;
+        int value = 0;
+        DsAnchorNode::InterpMode interpMode = DsAnchorNode::Cubic;
+    };
+
+    DsCurve::DsCurveType type = DsCurve::Generic;
+    int start = 0;
+    int step = 0;          // Draw
+    QVector<int> values;   // Draw
+    QVector<Node> nodes;   // Anchor, sorted by position
+};
+
+class ParamSnapshot {
+public:
+    QVector<CurveSnapshot> original;
+    QVector<CurveSnapshot> edited;
+    QVector<CurveSnapshot> envelope;
+};
+
+class ParamsSnapshot {
+public:
+    ParamSnapshot pitch;
+    ParamSnapshot energy;
+    ParamSnapshot tension;
+    ParamSnapshot breathiness;
+};
+
+class ClipSnapshot {
+public:
+    int id = -1;
+    quint64 persistentId = 0;
+    DsClip::ClipType type = DsClip::Generic;
+    QString name;
+    int start = 0;
+    int length = 0;
+    int clipStart = 0;
+    int clipLen = 0;
+    double gain = 0;
+    bool mute = false;
+    QString path;                                 // Audio
+    QVector<NoteSnapshot> notes;                  // Singing, sorted by start
+    std::shared_ptr<const ParamsSnapshot> params; // Singing
+
+    // Revisions of the model objects this snapshot was taken from
+    quint64 clipRevision = 0;
+    quint64 notesRevision = 0;
+    quint64 paramsRevision = 0;
+};
+
+class TrackSnapshot {
+public:
+    int id = -1;
+    quint64 persistentId = 0;
+    QString name;
+    DsTrackControl control;
+    QColor color;
+    QVector<std::shared_ptr<const ClipSnapshot>> clips; // Sorted by start
+
+    quint64 revision = 0;
+};
+
+class AppModelSnapshot {
+public:
+    quint64 version = 0;
+    double tempo = 120;
+    int numerator = 4;
+    int denominator = 4;
+    QVector<std::shared_ptr<const TrackSnapshot>> tracks;
+
+    // Builds the snapshot of model as version, sharing the unchanged subtrees of previous
+    static std::shared_ptr<const AppModelSnapshot>
+        build(const AppModel &model, quint64 version,
+              const std::shared_ptr<const AppModelSnapshot> &previous);
+
+private:
+    static std::shared_ptr<const TrackSnapshot>
+        buildTrack(DsTrack *track, const std::shared_ptr<const TrackSnapshot> &previous,
+                   const QHash<int, std::shared_ptr<const ClipSnapshot>> &previousClips);
+    static std::shared_ptr<const ClipSnapshot>
+        buildClip(DsClip *clip, const std::shared_ptr<const ClipSnapshot> &previous);
+    static std::shared_ptr<const ParamsSnapshot> buildParams(const DsParams &params);
+    static ParamSnapshot buildParam(const DsParam &param);
+    static QVector<CurveSnapshot> buildCurves(const OverlapableSerialList<DsCurve> &curves);
+};
+
+using AppModelSnapshotPtr = std::shared_ptr<const AppModelSnapshot>;
+
+#endif // APPMODELSNAPSHOT_H
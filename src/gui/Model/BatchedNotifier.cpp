@@ -0,0 +1,52 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#include "BatchedNotifier.h"
+
+int BatchedNotifier::m_depth = 0;
+QList<BatchedNotifier *> BatchedNotifier::m_pending;
+BatchedNotifier *BatchedNotifier::m_resetNotifier = nullptr;
+
+BatchedNotifier::~BatchedNotifier() {
+    if (m_scheduled)
+        m_pending.removeOne(this);
+    if (m_resetNotifier == this)
+        m_resetNotifier = nullptr;
+}
+void BatchedNotifier::beginBatch() {
+    m_depth++;
+}
+void BatchedNotifier::endBatch() {
+    Q_ASSERT(m_depth > 0);
+    if (--m_depth > 0)
+        return;
+    if (m_resetNotifier) {
+        for (auto notifier : m_pending)
+            if (notifier != m_resetNotifier) {
+                notifier->m_scheduled = false;
+                notifier->discardBatchedChanges();
+            }
+        m_pending = {m_resetNotifier};
+        m_resetNotifier = nullptr;
+    }
+    // Slots may start another batch, which then flushes on its own
+    while (!m_pending.isEmpty() && m_depth == 0) {
+        auto notifier = m_pending.takeFirst();
+        notifier->m_scheduled = false;
+        notifier->flushBatchedChanges();
+    }
+}
+bool BatchedNotifier::isBatching() {
+    return m_depth > 0;
+}
+void BatchedNotifier::scheduleFlush() {
+    if (m_scheduled)
+        return;
+    m_scheduled = true;
+    m_pending.append(this);
+}
+void BatchedNotifier::scheduleResetFlush() {
+    scheduleFlush();
+    m_resetNotifier = this;
+}
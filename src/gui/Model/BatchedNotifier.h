@@ -0,0 +1,103 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#ifndef BATCHEDNOTIFIER_H
+#define BATCHEDNOTIFIER_H
+
+#include <QHash>
+#include <QList>
+
+// Base of model objects that coalesce their change signals inside a batch.
+//
+// AppModel::beginBatch() and endBatch() open and close a batch. Batches nest, and nothing is
+// delivered until the outermost one ends. A notifier that records changes during a batch
+// calls scheduleFlush(), and its flushBatchedChanges() runs once when the batch ends.
+// Changes after which listeners reload everything (such as adding or removing tracks) use
+// scheduleResetFlush() instead: the other notifiers then discard their changes and only
+// that notifier flushes.
+class BatchedNotifier {
+public:
+    virtual ~BatchedNotifier();
+
+    static void beginBatch();
+    static void endBatch();
+    static bool isBatching();
+
+protected:
+    void scheduleFlush();
+    void scheduleResetFlush();
+    virtual void flushBatchedChanges() = 0;
+    virtual void discardBatchedChanges() = 0;
+
+private:
+    bool m_scheduled = false;
+
+    static int m_depth;
+    static QList<BatchedNotifier *> m_pending;
+    static BatchedNotifier *m_resetNotifier;
+};
+
+// Ordered changes of a batch, reduced to their net effect per key:
+// - a property change of an item inserted or already changed in the batch is dropped;
+// - removing an item inserted in the batch drops both, and removing an item drops its
+//   earlier property changes.
+// forEachRun() then hands out consecutive changes of the same type as one list.
+template <typename Type, Type Inserted, Type PropertyChanged, Type Removed, typename Key>
+class BatchedChanges {
+public:
+    void clear() {
+        m_entries.clear();
+        m_latest.clear();
+    }
+
+    void add(Type type, Key key) {
+        auto latest = m_latest.value(key, -1);
+        if (type == PropertyChanged) {
+            if (latest >= 0 && m_entries.at(latest).type != Removed)
+                return;
+        } else if (type == Removed && latest >= 0) {
+            // A live property change is always the latest entry of its key
+            auto latestType = m_entries.at(latest).type;
+            if (latestType != Removed)
+                m_entries[latest].alive = false;
+            if (latestType == Inserted) {
+                m_latest.remove(key);
+                return;
+            }
+        }
+        m_latest.insert(key, m_entries.count());
+        m_entries.append({type, key, true});
+    }
+
+    template <typename Fn>
+    void forEachRun(Fn fn) const {
+        QList<Key> keys;
+        Type runType = Inserted;
+        for (const auto &entry : m_entries) {
+            if (!entry.alive)
+                continue;
+            if (!keys.isEmpty() && entry.type != runType) {
+                fn(runType, keys);
+                keys.clear();
+            }
+            runType = entry.type;
+            keys.append(entry.key);
+        }
+        if (!keys.isEmpty())
+            fn(runType, keys);
+    }
+
+private:
+    class Entry {
+    public:
+        Type type;
+        Key key;
+        bool alive;
+    };
+
+    QList<Entry> m_entries;
+    QHash<Key, int> m_latest; // index of the latest live entry of each key
+};
+
+#endif // BATCHEDNOTIFIER_H
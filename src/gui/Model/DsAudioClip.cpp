@@ -10,5 +10,14 @@ QString DsAudioClip::path() const {
 }
 void DsAudioClip::setPath(const QString &path) {
     m_path = path;
+    m_revision++;
     // emit propertyChanged();
-}
\ No newline at end of file
+}
+qint64 DsAudioClip::memoryUsage() const {
+    return DsClip::memoryUsage() + sizeof(DsAudioClip) - sizeof(DsClip) +
+           m_path.size() * sizeof(QChar);
+}
+void DsAudioClip::hashProperties(ContentHash &hash) const {
+    DsClip::hashProperties(hash);
+    hash.add(m_path);
+}
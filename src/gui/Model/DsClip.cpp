@@ -4,47 +4,81 @@
 
 #include "DsClip.h"
 
+#include <QDebug>
+#include <QSet>
+
 QString DsClip::name() const {
     return m_name;
 }
 void DsClip::setName(const QString &text) {
     m_name = text;
+    m_revision++;
 }
 int DsClip::start() const {
     return m_start;
 }
 void DsClip::setStart(int start) {
     m_start = start;
+    m_revision++;
 }
 int DsClip::length() const {
     return m_length;
 }
 void DsClip::setLength(int length) {
     m_length = length;
+    m_revision++;
 }
 int DsClip::clipStart() const {
     return m_clipStart;
 }
 void DsClip::setClipStart(int clipStart) {
     m_clipStart = clipStart;
+    m_revision++;
 }
 int DsClip::clipLen() const {
     return m_clipLen;
 }
 void DsClip::setClipLen(int clipLen) {
     m_clipLen = clipLen;
+    m_revision++;
 }
 double DsClip::gain() const {
     return m_gain;
 }
 void DsClip::setGain(double gain) {
     m_gain = gain;
+    m_revision++;
 }
 bool DsClip::mute() const {
     return m_mute;
 }
 void DsClip::setMute(bool mute) {
     m_mute = mute;
+    m_revision++;
+}
+quint64 DsClip::revision() const {
+    return m_revision;
+}
+DsClipHashes DsClip::contentHashes() {
+    ContentHash hash;
+    hashProperties(hash);
+    DsClipHashes hashes;
+    hashes.properties = hash.result();
+    hashes.hash = hashes.properties;
+    return hashes;
+}
+void DsClip::hashProperties(ContentHash &hash) const {
+    hash.add(static_cast<int>(type()))
+        .add(m_name)
+        .add(m_start)
+        .add(m_length)
+        .add(m_clipStart)
+        .add(m_clipLen)
+        .add(m_gain)
+        .add(m_mute);
+}
+qint64 DsClip::memoryUsage() const {
+    return sizeof(DsClip) + m_name.size() * sizeof(QChar);
 }
 int DsClip::compareTo(DsClip *obj) const {
     auto curVisibleStart = start() + clipStart();
@@ -66,34 +100,279 @@ bool DsClip::isOverlappedWith(DsClip *obj) const {
         return false;
     return true;
 }
+int DsClip::overlapStart() const {
+    return start() + clipStart();
+}
+int DsClip::overlapEnd() const {
+    return start() + clipStart() + clipLen();
+}
+DsSingingClip::~DsSingingClip() {
+    // Free everything the clip allocated at once, notes first while their store is alive
+    m_notes.clear();
+    m_notePool.clear();
+    m_drawCurvePool.clear();
+    m_anchorCurvePool.clear();
+    m_anchorNodePool.clear();
+}
 const OverlapableSerialList<DsNote> &DsSingingClip::notes() const {
     return m_notes;
 }
+const DsNoteStore &DsSingingClip::noteStore() const {
+    return m_noteStore;
+}
 void DsSingingClip::insertNote(DsNote *note) {
-    m_notes.add(note);
-    emit noteChanged(Inserted, note->id());
+    insertNoteQuietly(note);
+    notifyNoteChanged(Inserted, note->id());
 }
 void DsSingingClip::removeNote(DsNote *note) {
-    m_notes.remove(note);
-    emit noteChanged(Removed, note->id());
+    removeNoteQuietly(note);
+    notifyNoteChanged(Removed, note->id());
 }
 void DsSingingClip::insertNoteQuietly(DsNote *note) {
+    note->attach(&m_noteStore);
     m_notes.add(note);
 }
 void DsSingingClip::removeNoteQuietly(DsNote *note) {
+    if (note->store() != &m_noteStore)
+        return;
     m_notes.remove(note);
+    note->detach();
 }
 void DsSingingClip::notifyNotePropertyChanged(DsNote *note) {
-    emit noteChanged(PropertyChanged, note->id());
+    notifyNoteChanged(PropertyChanged, note->id());
 }
-DsNote *DsSingingClip::findNoteById(int id) {
-    for (int i = 0; i < m_notes.count(); i++) {
-        auto note = m_notes.at(i);
-        if (note->id() == id)
-            return note;
+void DsSingingClip::editNotes(const QList<DsNote *> &notes,
+                              const std::function<void(DsNote *)> &edit) {
+    if (notes.isEmpty())
+        return;
+    m_notes.updateItems(notes, edit);
+    QList<int> ids;
+    ids.reserve(notes.count());
+    for (const auto note : notes)
+        ids.append(note->id());
+    notifyNotesChanged(PropertyChanged, ids);
+}
+quint64 DsSingingClip::paramsRevision() const {
+    return m_paramsRevision;
+}
+void DsSingingClip::notifyParamsChanged(ParamsChangeType type) {
+    m_paramsRevision++;
+    m_staleParams |= 1 << type;
+    emit paramsChanged(type);
+}
+void DsSingingClip::flushBatchedChanges() {
+    m_batchedNoteChanges.forEachRun(
+        [this](NoteChangeType type, const QList<int> &ids) { emit notesChanged(type, ids); });
+    m_batchedNoteChanges.clear();
+}
+void DsSingingClip::discardBatchedChanges() {
+    m_batchedNoteChanges.clear();
+}
+void DsSingingClip::notifyNoteChanged(NoteChangeType type, int id) {
+    if (isBatching()) {
+        m_batchedNoteChanges.add(type, id);
+        scheduleFlush();
+        return;
     }
+    emit noteChanged(type, id);
+    emit notesChanged(type, {id});
+}
+void DsSingingClip::notifyNotesChanged(NoteChangeType type, const QList<int> &ids) {
+    if (isBatching()) {
+        for (const auto id : ids)
+            m_batchedNoteChanges.add(type, id);
+        scheduleFlush();
+        return;
+    }
+    emit notesChanged(type, ids);
+}
+qint64 DsSingingClip::memoryUsage() const {
+    qint64 bytes = DsClip::memoryUsage() + sizeof(DsSingingClip) - sizeof(DsClip);
+    for (const auto note : m_notes)
+        bytes += note->memoryUsage();
+    for (const auto param : {&params.pitch, &params.energy, &params.tension, &params.breathiness})
+        for (const auto layer : {&param->original, &param->edited, &param->envelope})
+            for (const auto curve : *layer) {
+                if (curve->type() == DsCurve::Draw)
+                    bytes += dynamic_cast<DsDrawCurve *>(curve)->memoryUsage();
+                else if (curve->type() == DsCurve::Anchor)
+                    bytes += dynamic_cast<DsAnchorCurve *>(curve)->nodes().count() *
+                             static_cast<qint64>(sizeof(DsAnchorNode));
+            }
+    return bytes;
+}
+DsNote *DsSingingClip::createNote() {
+    return m_notePool.create();
+}
+DsNote *DsSingingClip::createNote(int start, int length, int keyIndex, const QString &lyric) {
+    return m_notePool.create(start, length, keyIndex, lyric);
+}
+DsDrawCurve *DsSingingClip::createDrawCurve() {
+    return m_drawCurvePool.create();
+}
+DsAnchorCurve *DsSingingClip::createAnchorCurve() {
+    return m_anchorCurvePool.create();
+}
+DsAnchorNode *DsSingingClip::createAnchorNode(int pos, int value) {
+    return m_anchorNodePool.create(pos, value);
+}
+void DsSingingClip::destroyNote(DsNote *note) {
+    // Checked against the pool first, so that a foreign or freed note is never dereferenced
+    if (!m_notePool.contains(note) || note->store() == &m_noteStore || m_notes.contains(note)) {
+        qWarning() << "DsSingingClip::destroyNote: refused a note that is in the clip or not"
+                      " owned by it";
+        return;
+    }
+    m_notePool.destroy(note);
+}
+void DsSingingClip::destroyCurve(DsCurve *curve) {
+    if (!m_drawCurvePool.contains(dynamic_cast<DsDrawCurve *>(curve)) &&
+        !m_anchorCurvePool.contains(dynamic_cast<DsAnchorCurve *>(curve))) {
+        qWarning() << "DsSingingClip::destroyCurve: refused a curve not owned by the clip";
+        return;
+    }
+    if (curve->type() == DsCurve::Draw) {
+        m_drawCurvePool.destroy(dynamic_cast<DsDrawCurve *>(curve));
+    } else if (curve->type() == DsCurve::Anchor) {
+        auto anchorCurve = dynamic_cast<DsAnchorCurve *>(curve);
+        for (const auto node : anchorCurve->nodes())
+            m_anchorNodePool.destroy(node);
+        m_anchorCurvePool.destroy(anchorCurve);
+    }
+}
+DsClipHashes DsSingingClip::contentHashes() {
+    ContentHash properties;
+    hashProperties(properties);
+    m_hashes.properties = properties.result();
+    updateNoteHashes();
+    for (const auto type :
+         {DsParams::Pitch, DsParams::Energy, DsParams::Tension, DsParams::Breathiness})
+        if (m_staleParams & (1 << type))
+            m_hashes.params[type] = hashParam(params.param(type));
+    m_staleParams = 0;
+
+    ContentHash hash;
+    hash.add(m_hashes.properties).add(m_hashes.notes);
+    for (const auto paramHash : m_hashes.params)
+        hash.add(paramHash);
+    m_hashes.hash = hash.result();
+    return m_hashes;
+}
+DsNote *DsSingingClip::findNoteById(int id) {
+    auto note = UniqueObject::find<DsNote>(id);
+    if (note && m_notes.contains(note))
+        return note;
     return nullptr;
 }
 // const DsParams &DsSingingClip::params() const {
 //     return m_params;
-// }
\ No newline at end of file
+// }
+void DsSingingClip::updateNoteHashes() {
+    QVector<int> dirtySlots;
+    if (!m_noteStore.takeDirtySlots(dirtySlots)) {
+        // Cleared: hash every slot again
+        m_slotWindows.clear();
+        m_hashes.noteWindows.clear();
+        dirtySlots.clear();
+        for (int slot = 0; slot < m_noteStore.slotCount(); slot++)
+            dirtySlots.append(slot);
+    }
+    if (dirtySlots.isEmpty())
+        return;
+
+    auto windowOf = [](int tick) {
+        // Rounded down, also for negative ticks
+        auto w = DsClipHashes::NoteWindowTicks;
+        return tick >= 0 ? tick / w : (tick - w + 1) / w;
+    };
+    while (m_slotWindows.count() < m_noteStore.slotCount())
+        m_slotWindows.append(NoWindow);
+    // A moved note changes both the window it left and the one it entered
+    QSet<int> windows;
+    for (const auto slot : dirtySlots) {
+        auto &slotWindow = m_slotWindows[slot];
+        if (slotWindow != NoWindow)
+            windows.insert(slotWindow);
+        if (m_noteStore.isFree(slot)) {
+            slotWindow = NoWindow;
+        } else {
+            slotWindow = windowOf(m_noteStore.start(slot));
+            windows.insert(slotWindow);
+        }
+    }
+    for (const auto window : windows) {
+        auto noteWindow = hashNoteWindow(window);
+        if (noteWindow.hash == 0)
+            m_hashes.noteWindows.remove(window);
+        else
+            m_hashes.noteWindows.insert(window, noteWindow);
+    }
+
+    ContentHash hash;
+    for (auto it = m_hashes.noteWindows.cbegin(); it != m_hashes.noteWindows.cend(); ++it)
+        hash.add(it.key()).add(it.value().hash);
+    m_hashes.notes = hash.result();
+}
+DsClipHashes::NoteWindow DsSingingClip::hashNoteWindow(int window) const {
+    auto windowStart = window * DsClipHashes::NoteWindowTicks;
+    auto windowEnd = windowStart + DsClipHashes::NoteWindowTicks;
+    ContentHash hash;
+    int count = 0;
+    DsClipHashes::NoteWindow noteWindow;
+    noteWindow.end = windowEnd;
+    auto hashPhonemes = [&](const QList<DsPhoneme> &phonemes) {
+        hash.add(phonemes.count());
+        for (const auto &phoneme : phonemes)
+            hash.add(static_cast<int>(phoneme.type))
+                .add(phoneme.name.toString())
+                .add(phoneme.start);
+    };
+    m_notes.forEachInRange(windowStart, windowEnd, [&](DsNote *note) {
+        // Notes belong to the window they start in
+        if (note->start() < windowStart)
+            return;
+        auto phonemes = note->phonemes();
+        hash.add(note->start())
+            .add(note->length())
+            .add(note->keyIndex())
+            .add(note->lyric())
+            .add(note->pronunciation());
+        hashPhonemes(phonemes.original);
+        hashPhonemes(phonemes.edited);
+        noteWindow.end = qMax(noteWindow.end, note->start() + note->length());
+        count++;
+    });
+    // 0 stands for an empty window
+    if (count > 0)
+        noteWindow.hash = hash.add(count).result() | 1;
+    return noteWindow;
+}
+quint64 DsSingingClip::hashParam(const DsParam &param) {
+    ContentHash hash;
+    for (const auto layer : {&param.original, &param.edited, &param.envelope}) {
+        hash.add(layer->count());
+        for (const auto curve : *layer) {
+            hash.add(static_cast<int>(curve->type())).add(curve->start());
+            if (curve->type() == DsCurve::Draw) {
+                auto drawCurve = dynamic_cast<DsDrawCurve *>(curve);
+                auto count = drawCurve->valueCount();
+                hash.add(drawCurve->valueStep()).add(count);
+                int buffer[ChunkedIntArray::ChunkSize];
+                for (int i = 0; i < count; i += ChunkedIntArray::ChunkSize) {
+                    auto n = qMin(ChunkedIntArray::ChunkSize, count - i);
+                    drawCurve->readValues(i, n, buffer);
+                    for (int j = 0; j < n; j++)
+                        hash.add(buffer[j]);
+                }
+            } else if (curve->type() == DsCurve::Anchor) {
+                const auto &nodes = dynamic_cast<DsAnchorCurve *>(curve)->nodes();
+                hash.add(nodes.count());
+                for (const auto node : nodes)
+                    hash.add(node->pos())
+                        .add(node->value())
+                        .add(static_cast<int>(node->interpMode()));
+            }
+        }
+    }
+    return hash.result();
+}
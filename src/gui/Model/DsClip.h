@@ -5,12 +5,19 @@
 #ifndef DSCLIP_H
 #define DSCLIP_H
 
+#include <climits>
+#include <functional>
+
 #include <QSharedPointer>
 #include <QObject>
 
+#include "BatchedNotifier.h"
+#include "DsContentHashes.h"
 #include "DsNote.h"
 #include "DsParams.h"
+#include "../Utils/ContentHash.h"
 #include "../Utils/IOverlapable.h"
+#include "../Utils/ObjectPool.h"
 #include "../Utils/OverlapableSerialList.h"
 #include "../Utils/UniqueObject.h"
 
@@ -39,9 +46,18 @@ public:
     void setGain(double gain);
     bool mute() const;
     void setMute(bool mute);
+    // Incremented by every property change, see AppModelSnapshot
+    quint64 revision() const;
+    // Approximate bytes held by the clip and its content
+    virtual qint64 memoryUsage() const;
+    // Content hashes of the clip. Singing clips update them from what changed since the last
+    // call.
+    virtual DsClipHashes contentHashes();
 
     int compareTo(DsClip *obj) const;
     bool isOverlappedWith(DsClip *obj) const;
+    int overlapStart() const;
+    int overlapEnd() const;
 
     class ClipCommonProperties {
     public:
@@ -64,6 +80,8 @@ public:
     };
 
 protected:
+    virtual void hashProperties(ContentHash &hash) const;
+
     QString m_name;
     int m_start = 0;
     int m_length = 0;
@@ -71,6 +89,7 @@ protected:
     int m_clipLen = 0;
     double m_gain = 0;
     bool m_mute = false;
+    quint64 m_revision = 0;
 };
 
 class DsAudioClip final : public DsClip {
@@ -80,39 +99,98 @@ public:
     }
     QString path() const;
     void setPath(const QString &path);
+    qint64 memoryUsage() const override;
+
+protected:
+    void hashProperties(ContentHash &hash) const override;
 
 private:
     QString m_path;
 };
 
-class DsSingingClip final : public DsClip {
+class DsSingingClip final : public DsClip, public BatchedNotifier {
     Q_OBJECT
 
 public:
     enum NoteChangeType { Inserted, PropertyChanged, Removed };
     enum ParamsChangeType { Pitch, Energy, Tension, Breathiness };
 
+    ~DsSingingClip() override;
+
     ClipType type() const override {
         return Singing;
     }
 
     const OverlapableSerialList<DsNote> &notes() const;
+    const DsNoteStore &noteStore() const;
     void insertNote(DsNote *note);
     void removeNote(DsNote *note);
     void insertNoteQuietly(DsNote *note);
     void removeNoteQuietly(DsNote *note);
     void notifyNotePropertyChanged(DsNote *note);
+    // Applies edit(note) to each of notes, which may move them, as one change: the notes are
+    // re-sorted and their overlap state recomputed once, and notesChanged() is emitted once
+    void editNotes(const QList<DsNote *> &notes, const std::function<void(DsNote *)> &edit);
+    // Callers that modify params must notify, so that snapshots and content hashes pick up
+    // the change
+    void notifyParamsChanged(ParamsChangeType type);
+    quint64 paramsRevision() const;
     DsNote *findNoteById(int id);
+    qint64 memoryUsage() const override;
+    // Only the note windows touched since the last call and the notified params are hashed
+    // again
+    DsClipHashes contentHashes() override;
+
+    // Notes, curves and anchor nodes of the clip are allocated from pools owned by it, and
+    // all freed together with the clip. Objects removed from the clip but still held by the
+    // history stay allocated until the history destroys them here.
+    DsNote *createNote();
+    DsNote *createNote(int start, int length, int keyIndex, const QString &lyric);
+    DsDrawCurve *createDrawCurve();
+    DsAnchorCurve *createAnchorCurve();
+    DsAnchorNode *createAnchorNode(int pos, int value);
+    // Notes still in the clip or not created by it are refused and left alone
+    void destroyNote(DsNote *note);
+    // Destroys an anchor curve together with its nodes. curve must not be in params; curves
+    // not created by the clip are refused.
+    void destroyCurve(DsCurve *curve);
 
     DsParams params;
     // const DsParams &params() const;
 
 signals:
     void noteChanged(NoteChangeType type, int id);
+    // Emitted for every change, and once per run of same-type changes inside a batch,
+    // where noteChanged() is not emitted. editNotes() reports all its notes at once and
+    // does not emit noteChanged() either.
+    void notesChanged(NoteChangeType type, const QList<int> &ids);
     void paramsChanged(ParamsChangeType type);
 
+protected:
+    void flushBatchedChanges() override;
+    void discardBatchedChanges() override;
+
 private:
+    void notifyNoteChanged(NoteChangeType type, int id);
+    void notifyNotesChanged(NoteChangeType type, const QList<int> &ids);
+    void updateNoteHashes();
+    DsClipHashes::NoteWindow hashNoteWindow(int window) const;
+    static quint64 hashParam(const DsParam &param);
+
     OverlapableSerialList<DsNote> m_notes;
+    DsNoteStore m_noteStore;
+    ObjectPool<DsNote> m_notePool;
+    ObjectPool<DsDrawCurve, 16> m_drawCurvePool;
+    ObjectPool<DsAnchorCurve, 16> m_anchorCurvePool;
+    ObjectPool<DsAnchorNode> m_anchorNodePool;
+    quint64 m_paramsRevision = 0;
+    DsClipHashes m_hashes;
+    // Note window each store slot was last hashed into, or NoWindow. Not -1, which is the
+    // window of the negative ticks just before the clip start.
+    static constexpr int NoWindow = INT_MIN;
+    QVector<int> m_slotWindows;
+    quint8 m_staleParams = 0xF; // bit per DsParams::ParamType
+    BatchedChanges<NoteChangeType, Inserted, PropertyChanged, Removed, int> m_batchedNoteChanges;
     // DsParams m_params;
 };
 
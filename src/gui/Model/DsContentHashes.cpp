@@ -0,0 +1,63 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "DsContentHashes.h"
+
+QList<QPair<int, int>> DsClipHashes::changedNoteRanges(const DsClipHashes &a,
+                                                       const DsClipHashes &b) {
+    QList<QPair<int, int>> ranges;
+    if (a.notes == b.notes)
+        return ranges;
+    // A note changed in a window covers the ticks up to its end in both versions, so a note
+    // lengthened past its window changes the ticks it now covers too
+    auto addWindow = [&](int window, int endA, int endB) {
+        auto start = window * NoteWindowTicks;
+        auto end = qMax(start + NoteWindowTicks, qMax(endA, endB));
+        if (!ranges.isEmpty() && ranges.last().second >= start)
+            ranges.last().second = qMax(ranges.last().second, end);
+        else
+            ranges.append({start, end});
+    };
+    // Merge the two sorted maps
+    auto itA = a.noteWindows.cbegin();
+    auto itB = b.noteWindows.cbegin();
+    while (itA != a.noteWindows.cend() || itB != b.noteWindows.cend()) {
+        if (itB == b.noteWindows.cend() || (itA != a.noteWindows.cend() && itA.key() < itB.key())) {
+            addWindow(itA.key(), itA.value().end, 0);
+            ++itA;
+        } else if (itA == a.noteWindows.cend() || itB.key() < itA.key()) {
+            addWindow(itB.key(), 0, itB.value().end);
+            ++itB;
+        } else {
+            if (itA.value().hash != itB.value().hash)
+                addWindow(itA.key(), itA.value().end, itB.value().end);
+            ++itA;
+            ++itB;
+        }
+    }
+    return ranges;
+}
+QList<DsParams::ParamType> DsClipHashes::changedParams(const DsClipHashes &a,
+                                                      const DsClipHashes &b) {
+    QList<DsParams::ParamType> types;
+    for (const auto type :
+         {DsParams::Pitch, DsParams::Energy, DsParams::Tension, DsParams::Breathiness})
+        if (a.params[type] != b.params[type])
+            types.append(type);
+    return types;
+}
+QList<int> DsTrackHashes::changedClips(const DsTrackHashes &a, const DsTrackHashes &b) {
+    QList<int> ids;
+    if (a.hash == b.hash)
+        return ids;
+    for (auto it = a.clips.cbegin(); it != a.clips.cend(); ++it) {
+        auto other = b.clips.constFind(it.key());
+        if (other == b.clips.cend() || other.value().hash != it.value().hash)
+            ids.append(it.key());
+    }
+    for (auto it = b.clips.cbegin(); it != b.clips.cend(); ++it)
+        if (!a.clips.contains(it.key()))
+            ids.append(it.key());
+    return ids;
+}
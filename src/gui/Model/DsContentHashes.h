@@ -0,0 +1,56 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef DSCONTENTHASHES_H
+#define DSCONTENTHASHES_H
+
+#include <QList>
+#include <QMap>
+#include <QPair>
+
+#include "DsParams.h"
+
+// Merkle-style content hashes of a clip, see DsClip::contentHashes().
+//
+// Each level hashes the level below, so comparing the top hashes of two versions tells
+// whether anything changed, and descending only into differing hashes finds what changed
+// in time proportional to the change. Copies are cheap (the note windows are implicitly
+// shared), so callers keep the hashes of the version they processed last and diff against
+// them later.
+class DsClipHashes {
+public:
+    // Notes are hashed in windows of this many ticks, by start
+    static constexpr int NoteWindowTicks = 1920;
+
+    class NoteWindow {
+    public:
+        quint64 hash = 0; // of the notes starting in the window
+        int end = 0;      // latest end of those notes, past the window for long notes
+    };
+
+    quint64 hash = 0; // of everything below
+    quint64 properties = 0;
+    // Singing clips
+    quint64 notes = 0;
+    QMap<int, NoteWindow> noteWindows; // by window index
+    quint64 params[4] = {};            // by DsParams::ParamType
+
+    // Tick ranges [start, end) of the note windows that differ between a and b, each reaching
+    // to the end of the longest note starting in it in either version, with touching and
+    // overlapping ranges joined
+    static QList<QPair<int, int>> changedNoteRanges(const DsClipHashes &a, const DsClipHashes &b);
+    static QList<DsParams::ParamType> changedParams(const DsClipHashes &a, const DsClipHashes &b);
+};
+
+class DsTrackHashes {
+public:
+    quint64 hash = 0; // of the properties and of the clips in order
+    quint64 properties = 0;
+    QMap<int, DsClipHashes> clips; // by clip id
+
+    // Ids of the clips that were added, removed or changed between a and b
+    static QList<int> changedClips(const DsTrackHashes &a, const DsTrackHashes &b);
+};
+
+#endif // DSCONTENTHASHES_H
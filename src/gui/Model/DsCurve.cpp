@@ -29,15 +29,42 @@ bool DsCurve::isOverlappedWith(DsCurve *obj) const {
         return false;
     return true;
 }
-const QList<int> &DsDrawCurve::values() const {
-    return m_values;
+int DsCurve::overlapStart() const {
+    return m_start;
+}
+int DsCurve::overlapEnd() const {
+    return endTick();
+}
+QList<int> DsDrawCurve::values() const {
+    return m_values.toList();
 }
 void DsDrawCurve::setValues(const QList<int> &values) {
-    m_values = values;
+    m_values.setValues(values);
 }
 void DsDrawCurve::insertValue(int value) {
     m_values.append(value);
 }
+int DsDrawCurve::valueCount() const {
+    return m_values.count();
+}
+int DsDrawCurve::valueAt(int index) const {
+    return m_values.at(index);
+}
+void DsDrawCurve::readValues(int index, int count, int *out) const {
+    m_values.read(index, count, out);
+}
+int DsDrawCurve::valueStep() const {
+    return m_step;
+}
+void DsDrawCurve::writeValues(int index, const QList<int> &values) {
+    m_values.write(index, values);
+}
+void DsDrawCurve::truncateValues(int count) {
+    m_values.truncate(count);
+}
+qint64 DsDrawCurve::memoryUsage() const {
+    return m_values.memoryUsage();
+}
 int DsDrawCurve::endTick() const {
     return start() + m_step * m_values.count();
 }
@@ -74,11 +101,30 @@ const QList<DsAnchorNode *> &DsAnchorCurve::nodes() const {
     return m_nodes;
 }
 void DsAnchorCurve::insertNode(DsAnchorNode *node) {
-    m_nodes.append(node);
+    auto index = lowerBound(node->pos());
+    if (index < m_nodes.count() && m_nodes.at(index)->pos() == node->pos())
+        m_nodes[index] = node;
+    else
+        m_nodes.insert(index, node);
+    m_curve.insert(node->pos(), node->value());
 }
 void DsAnchorCurve::removeNode(DsAnchorNode *node) {
-    m_nodes.removeOne(node);
+    auto index = lowerBound(node->pos());
+    if (index < m_nodes.count() && m_nodes.at(index) == node) {
+        m_nodes.removeAt(index);
+        m_curve.remove(node->pos());
+    }
+}
+const AnchoredCurve<int, double> &DsAnchorCurve::curve() const {
+    return m_curve;
 }
 int DsAnchorCurve::endTick() const {
-    return m_nodes.at(m_nodes.count() - 1)->pos(); // TODO: fix
+    if (m_nodes.isEmpty())
+        return start();
+    return m_nodes.last()->pos();
+}
+int DsAnchorCurve::lowerBound(int pos) const {
+    auto it = std::lower_bound(m_nodes.cbegin(), m_nodes.cend(), pos,
+                               [](const DsAnchorNode *node, int p) { return node->pos() < p; });
+    return static_cast<int>(it - m_nodes.cbegin());
 }
\ No newline at end of file
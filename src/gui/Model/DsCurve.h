@@ -5,6 +5,8 @@
 #ifndef DSCURVE_H
 #define DSCURVE_H
 
+#include "../Utils/AnchoredCurve.h"
+#include "../Utils/ChunkedIntArray.h"
 #include "../Utils/IOverlapable.h"
 #include "../Utils/UniqueObject.h"
 
@@ -27,6 +29,8 @@ public:
         return m_start;
     }
     bool isOverlappedWith(DsCurve *obj) const;
+    int overlapStart() const;
+    int overlapEnd() const;
 
 private:
     int m_start = 0;
@@ -38,15 +42,25 @@ public:
         return Draw;
     }
     int step; // TODO: remove
-    const QList<int> &values() const;
+    QList<int> values() const;
     void setValues(const QList<int> &values);
     void insertValue(int value);
+    int valueCount() const;
+    int valueAt(int index) const;
+    void readValues(int index, int count, int *out) const;
+    int valueStep() const;
+    // Overwrites the values from index on and appends the rest; only the chunks touched
+    // by the range are re-encoded
+    void writeValues(int index, const QList<int> &values);
+    // Drops the values from count on
+    void truncateValues(int count);
+    qint64 memoryUsage() const;
 
     int endTick() const override;
 
 private:
     int m_step = 5;
-    QList<int> m_values;
+    ChunkedIntArray m_values;
 };
 
 class DsAnchorNode : public IOverlapable, UniqueObject {
@@ -77,14 +91,21 @@ public:
     DsCurveType type() override {
         return Anchor;
     }
-    //TODO: use OverlapableSerialList
+    // Nodes sorted by position
     const QList<DsAnchorNode *> &nodes() const;
+    // A node at the position of an existing one replaces it. To move a node or change its
+    // value, remove it first and insert it again.
     void insertNode(DsAnchorNode *node);
     void removeNode(DsAnchorNode *node);
+    // Monotone interpolation through the nodes, kept in sync with them
+    const AnchoredCurve<int, double> &curve() const;
     int endTick() const override;
 
 private:
+    int lowerBound(int pos) const;
+
     QList<DsAnchorNode *> m_nodes;
+    AnchoredCurve<int, double> m_curve;
 };
 
 #endif // DSCURVE_H
@@ -6,45 +6,103 @@
 
 #include <utility>
 
+DsNote::DsNote(const DsNote &other)
+    : IOverlapable(other), m_start(other.start()), m_length(other.length()),
+      m_keyIndex(other.keyIndex()), m_lyric(other.lyricSymbol()),
+      m_pronunciation(other.pronunciationSymbol()), m_phonemes(other.phonemes()) {
+}
+DsNote &DsNote::operator=(const DsNote &other) {
+    // The clip orders its notes by position, which an assignment would change behind its back
+    Q_ASSERT(!m_store);
+    if (this == &other)
+        return *this;
+    IOverlapable::operator=(other);
+    setStart(other.start());
+    setLength(other.length());
+    setKeyIndex(other.keyIndex());
+    setLyric(other.lyricSymbol());
+    setPronunciation(other.pronunciationSymbol());
+    if (m_store)
+        m_store->setPhonemes(m_slot, other.phonemes());
+    else
+        m_phonemes = other.phonemes();
+    return *this;
+}
+DsNote::~DsNote() {
+    if (m_store)
+        m_store->release(m_slot);
+}
 int DsNote::start() const {
-    return m_start;
+    return m_store ? m_store->start(m_slot) : m_start;
 }
 void DsNote::setStart(int start) {
-    m_start = start;
+    if (m_store)
+        m_store->setStart(m_slot, start);
+    else
+        m_start = start;
 }
 int DsNote::length() const {
-    return m_length;
+    return m_store ? m_store->length(m_slot) : m_length;
 }
 void DsNote::setLength(int length) {
-    m_length = length;
+    if (m_store)
+        m_store->setLength(m_slot, length);
+    else
+        m_length = length;
 }
 int DsNote::keyIndex() const {
-    return m_keyIndex;
+    return m_store ? m_store->keyIndex(m_slot) : m_keyIndex;
 }
 void DsNote::setKeyIndex(int keyIndex) {
-    m_keyIndex = keyIndex;
+    if (m_store)
+        m_store->setKeyIndex(m_slot, keyIndex);
+    else
+        m_keyIndex = keyIndex;
 }
-QString DsNote::lyric() const {
-    return m_lyric;
+const QString &DsNote::lyric() const {
+    return lyricSymbol().toString();
 }
 void DsNote::setLyric(const QString &lyric) {
-    m_lyric = lyric;
+    setLyric(Symbol(lyric));
 }
-QString DsNote::pronunciation() const {
-    return m_pronunciation;
+const QString &DsNote::pronunciation() const {
+    return pronunciationSymbol().toString();
 }
 void DsNote::setPronunciation(const QString &pronunciation) {
-    m_pronunciation = pronunciation;
+    setPronunciation(Symbol(pronunciation));
+}
+Symbol DsNote::lyricSymbol() const {
+    return m_store ? m_store->lyric(m_slot) : m_lyric;
+}
+void DsNote::setLyric(Symbol lyric) {
+    if (m_store)
+        m_store->setLyric(m_slot, lyric);
+    else
+        m_lyric = lyric;
+}
+Symbol DsNote::pronunciationSymbol() const {
+    return m_store ? m_store->pronunciation(m_slot) : m_pronunciation;
+}
+void DsNote::setPronunciation(Symbol pronunciation) {
+    if (m_store)
+        m_store->setPronunciation(m_slot, pronunciation);
+    else
+        m_pronunciation = pronunciation;
 }
 DsPhonemes DsNote::phonemes() const {
-    return m_phonemes;
+    return m_store ? m_store->phonemes(m_slot) : m_phonemes;
 }
 void DsNote::setPhonemes(DsPhonemes::DsPhonemesType type, const QList<DsPhoneme>& phonemes) {
+    auto result = this->phonemes();
     if (type == DsPhonemes::Original)
-        m_phonemes.original = phonemes;
+        result.original = phonemes;
     else if (type == DsPhonemes::Edited)
-        m_phonemes.edited = phonemes;
+        result.edited = phonemes;
 
+    if (m_store)
+        m_store->setPhonemes(m_slot, result);
+    else
+        m_phonemes = result;
 }
 int DsNote::compareTo(DsNote *obj) const {
     auto otherStart = obj->start();
@@ -61,4 +119,44 @@ bool DsNote::isOverlappedWith(DsNote *obj) const {
     if (otherEnd <= start() || curEnd <= otherStart)
         return false;
     return true;
-}
\ No newline at end of file
+}
+int DsNote::overlapStart() const {
+    return start();
+}
+int DsNote::overlapEnd() const {
+    return start() + length();
+}
+void DsNote::attach(DsNoteStore *store) {
+    Q_ASSERT(m_store == nullptr);
+    m_slot = store->allocate(id(), m_start, m_length, m_keyIndex);
+    store->setLyric(m_slot, m_lyric);
+    store->setPronunciation(m_slot, m_pronunciation);
+    store->setPhonemes(m_slot, m_phonemes);
+    m_store = store;
+    m_lyric = Symbol();
+    m_pronunciation = Symbol();
+    m_phonemes = DsPhonemes();
+}
+void DsNote::detach() {
+    if (!m_store)
+        return;
+    m_start = m_store->start(m_slot);
+    m_length = m_store->length(m_slot);
+    m_keyIndex = m_store->keyIndex(m_slot);
+    m_lyric = m_store->lyric(m_slot);
+    m_pronunciation = m_store->pronunciation(m_slot);
+    m_phonemes = m_store->phonemes(m_slot);
+    m_store->release(m_slot);
+    m_store = nullptr;
+    m_slot = -1;
+}
+DsNoteStore *DsNote::store() const {
+    return m_store;
+}
+int DsNote::slot() const {
+    return m_slot;
+}
+qint64 DsNote::memoryUsage() const {
+    // Lyric and pronunciation are interned and not counted
+    return sizeof(DsNote) + phonemes().memoryUsage();
+}
@@ -6,36 +6,25 @@
 #define DSNOTE_H
 
 #include <QList>
-#include <utility>
 
+#include "DsNoteStore.h"
+#include "DsPhonemes.h"
 #include "../Utils/IOverlapable.h"
 #include "../Utils/UniqueObject.h"
 
-class DsPhoneme {
-public:
-    enum DsPhonemeType { Ahead, Normal, Final };
-
-    DsPhoneme(DsPhonemeType type, QString name, int start)
-        : type(type), name(std::move(name)), start(start) {
-    }
-    DsPhonemeType type;
-    QString name;
-    int start;
-};
-
-class DsPhonemes {
-public:
-    enum DsPhonemesType { Original, Edited };
-    QList<DsPhoneme> original;
-    QList<DsPhoneme> edited;
-};
-
+// A note handle. While the note belongs to a singing clip its data lives in the clip's
+// DsNoteStore, otherwise in the note itself.
 class DsNote : public IOverlapable, public UniqueObject {
 public:
     explicit DsNote() = default;
-    explicit DsNote(int start, int length, int keyIndex, QString lyric)
-        : m_start(start), m_length(length), m_keyIndex(keyIndex), m_lyric(std::move(lyric)) {
+    explicit DsNote(int start, int length, int keyIndex, const QString &lyric)
+        : m_start(start), m_length(length), m_keyIndex(keyIndex), m_lyric(lyric) {
     }
+    // A copy is a new note with an id of its own. Assignment copies the data and keeps the id,
+    // and must not be used on a note that is in a clip.
+    DsNote(const DsNote &other);
+    DsNote &operator=(const DsNote &other);
+    ~DsNote() override;
 
     int start() const;
     void setStart(int start);
@@ -43,15 +32,30 @@ public:
     void setLength(int length);
     int keyIndex() const;
     void setKeyIndex(int keyIndex);
-    QString lyric() const;
+    const QString &lyric() const;
     void setLyric(const QString &lyric);
-    QString pronunciation() const;
+    const QString &pronunciation() const;
     void setPronunciation(const QString &pronunciation);
+    // Interned forms of the lyric and the pronunciation, for comparing and grouping notes
+    Symbol lyricSymbol() const;
+    void setLyric(Symbol lyric);
+    Symbol pronunciationSymbol() const;
+    void setPronunciation(Symbol pronunciation);
     DsPhonemes phonemes() const;
+    // Approximate bytes held by the note and its word properties
+    qint64 memoryUsage() const;
     void setPhonemes(DsPhonemes::DsPhonemesType type, const QList<DsPhoneme> &phonemes);
 
     int compareTo(DsNote *obj) const;
     bool isOverlappedWith(DsNote *obj) const;
+    int overlapStart() const;
+    int overlapEnd() const;
+
+    // Moves the note's data into the store of the clip it is inserted into, and back
+    void attach(DsNoteStore *store);
+    void detach();
+    DsNoteStore *store() const;
+    int slot() const;
 
     class NoteWordProperties {
     public:
@@ -61,11 +65,15 @@ public:
     };
 
 private:
+    DsNoteStore *m_store = nullptr;
+    int m_slot = -1;
+
+    // Used while the note is detached
     int m_start = 0;
     int m_length = 480;
     int m_keyIndex = 60;
-    QString m_lyric;
-    QString m_pronunciation;
+    Symbol m_lyric;
+    Symbol m_pronunciation;
     DsPhonemes m_phonemes;
 };
 
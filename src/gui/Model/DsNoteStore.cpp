@@ -0,0 +1,76 @@
+//
+// Created by fluty on 2024/2/12.
+//
+
+#include "DsNoteStore.h"
+
+#include <utility>
+
+int DsNoteStore::allocate(int id, int start, int length, int keyIndex) {
+    if (!m_freeSlots.isEmpty()) {
+        auto slot = m_freeSlots.takeLast();
+        m_ids[slot] = id;
+        m_starts[slot] = start;
+        m_lengths[slot] = length;
+        m_keyIndices[slot] = keyIndex;
+        m_lyrics[slot] = Symbol();
+        m_pronunciations[slot] = Symbol();
+        touch(slot);
+        return slot;
+    }
+    m_ids.append(id);
+    m_starts.append(start);
+    m_lengths.append(length);
+    m_keyIndices.append(keyIndex);
+    m_lyrics.append(Symbol());
+    m_pronunciations.append(Symbol());
+    m_dirty.append(false);
+    auto slot = m_ids.count() - 1;
+    touch(slot);
+    return slot;
+}
+void DsNoteStore::release(int slot) {
+    touch(slot);
+    m_phonemes.remove(slot);
+    m_ids[slot] = -1;
+    m_freeSlots.append(slot);
+}
+void DsNoteStore::clear() {
+    m_ids.clear();
+    m_starts.clear();
+    m_lengths.clear();
+    m_keyIndices.clear();
+    m_lyrics.clear();
+    m_pronunciations.clear();
+    m_freeSlots.clear();
+    m_dirty.clear();
+    m_dirtySlots.clear();
+    m_cleared = true;
+    m_phonemes.clear();
+    m_revision++;
+}
+int DsNoteStore::count() const {
+    return m_ids.count() - m_freeSlots.count();
+}
+int DsNoteStore::slotCount() const {
+    return m_ids.count();
+}
+DsPhonemes DsNoteStore::phonemes(int slot) const {
+    return m_phonemes.value(slot);
+}
+void DsNoteStore::setPhonemes(int slot, const DsPhonemes &phonemes) {
+    touch(slot);
+    if (phonemes.isEmpty())
+        m_phonemes.remove(slot);
+    else
+        m_phonemes.insert(slot, phonemes);
+}
+bool DsNoteStore::takeDirtySlots(QVector<int> &dirtySlots) {
+    for (const auto slot : m_dirtySlots)
+        m_dirty[slot] = false;
+    dirtySlots = std::move(m_dirtySlots);
+    m_dirtySlots.clear();
+    auto cleared = m_cleared;
+    m_cleared = false;
+    return !cleared;
+}
@@ -0,0 +1,124 @@
+//
+// Created by fluty on 2024/2/12.
+//
+
+#ifndef DSNOTESTORE_H
+#define DSNOTESTORE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+#include "DsPhonemes.h"
+#include "../Utils/Symbol.h"
+
+// Columnar storage for the notes of a singing clip.
+// Start, length, key, lyric and pronunciation of each note live in parallel arrays indexed by
+// slot, so scans that only need timing walk contiguous memory. Lyrics and pronunciations are
+// interned symbols. Phonemes, which most notes do not have yet, are kept in a side table
+// keyed by slot. Slots of removed notes are reused by later insertions, so
+// the columns may contain free slots, whose id is -1.
+class DsNoteStore {
+public:
+    int allocate(int id, int start, int length, int keyIndex);
+    void release(int slot);
+    void clear();
+    int count() const;
+    int slotCount() const;
+    // Incremented by every change to the stored notes
+    quint64 revision() const {
+        return m_revision;
+    }
+    bool isFree(int slot) const {
+        return m_ids.at(slot) == -1;
+    }
+
+    int id(int slot) const {
+        return m_ids.at(slot);
+    }
+    int start(int slot) const {
+        return m_starts.at(slot);
+    }
+    void setStart(int slot, int start) {
+        m_starts[slot] = start;
+        touch(slot);
+    }
+    int length(int slot) const {
+        return m_lengths.at(slot);
+    }
+    void setLength(int slot, int length) {
+        m_lengths[slot] = length;
+        touch(slot);
+    }
+    int keyIndex(int slot) const {
+        return m_keyIndices.at(slot);
+    }
+    void setKeyIndex(int slot, int keyIndex) {
+        m_keyIndices[slot] = keyIndex;
+        touch(slot);
+    }
+    const QVector<int> &ids() const {
+        return m_ids;
+    }
+    const QVector<int> &starts() const {
+        return m_starts;
+    }
+    const QVector<int> &lengths() const {
+        return m_lengths;
+    }
+    Symbol lyric(int slot) const {
+        return m_lyrics.at(slot);
+    }
+    void setLyric(int slot, Symbol lyric) {
+        m_lyrics[slot] = lyric;
+        touch(slot);
+    }
+    Symbol pronunciation(int slot) const {
+        return m_pronunciations.at(slot);
+    }
+    void setPronunciation(int slot, Symbol pronunciation) {
+        m_pronunciations[slot] = pronunciation;
+        touch(slot);
+    }
+    const QVector<int> &keyIndices() const {
+        return m_keyIndices;
+    }
+    const QVector<Symbol> &lyrics() const {
+        return m_lyrics;
+    }
+    const QVector<Symbol> &pronunciations() const {
+        return m_pronunciations;
+    }
+
+    DsPhonemes phonemes(int slot) const;
+    void setPhonemes(int slot, const DsPhonemes &phonemes);
+
+    // Slots allocated, released or modified since the last call, for incremental hashing.
+    // Returns false instead if the store was cleared in between.
+    bool takeDirtySlots(QVector<int> &dirtySlots);
+
+private:
+    void touch(int slot) {
+        m_revision++;
+        if (!m_dirty.at(slot)) {
+            m_dirty[slot] = true;
+            m_dirtySlots.append(slot);
+        }
+    }
+
+    QVector<int> m_ids;
+    QVector<int> m_starts;
+    QVector<int> m_lengths;
+    QVector<int> m_keyIndices;
+    QVector<Symbol> m_lyrics;
+    QVector<Symbol> m_pronunciations;
+    QVector<int> m_freeSlots;
+    QVector<bool> m_dirty;
+    QVector<int> m_dirtySlots;
+    bool m_cleared = false;
+
+    QHash<int, DsPhonemes> m_phonemes;
+    quint64 m_revision = 0;
+};
+
+#endif // DSNOTESTORE_H
@@ -0,0 +1,166 @@
+//
+// Created by fluty on 2024/2/14.
+//
+
+#include "DsParamSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "../Utils/SamplingKernels.h"
+
+// Index of the first output sample at or after tick
+static int firstSampleAt(int tick, int startTick, int step) {
+    auto offset = static_cast<qint64>(tick) - startTick;
+    if (offset <= 0)
+        return 0;
+    return static_cast<int>((offset + step - 1) / step);
+}
+
+void DsParamSampler::sample(const DsParam &param, int startTick, int step, int count,
+                            float *out) {
+    if (count <= 0 || step <= 0)
+        return;
+    std::fill(out, out + count, std::numeric_limits<float>::quiet_NaN());
+    renderLayer(param.original, startTick, step, count, out);
+    renderLayer(param.edited, startTick, step, count, out);
+
+    if (param.envelope.count() == 0)
+        return;
+    m_envelopeBuffer.resize(count);
+    auto envelope = m_envelopeBuffer.data();
+    std::fill(envelope, envelope + count, 0.0f);
+    renderLayer(param.envelope, startTick, step, count, envelope);
+    SamplingKernels::add(envelope, out, count);
+}
+QVector<float> DsParamSampler::sample(const DsParam &param, int startTick, int endTick,
+                                      int step) {
+    if (step <= 0 || endTick <= startTick)
+        return {};
+    QVector<float> buffer(firstSampleAt(endTick, startTick, step));
+    sample(param, startTick, step, buffer.count(), buffer.data());
+    return buffer;
+}
+void DsParamSampler::sampleBatch(const QList<Request> &requests) {
+    for (const auto &request : requests)
+        sample(*request.param, request.startTick, request.step, request.count, request.out);
+}
+void DsParamSampler::renderLayer(const OverlapableSerialList<DsCurve> &curves, int startTick,
+                                 int step, int count, float *out) {
+    auto endTick = static_cast<int>(qMin<qint64>(startTick + static_cast<qint64>(step) * count,
+                                                 std::numeric_limits<int>::max()));
+    // Curves are visited in start order, so a later curve wins where two overlap
+    curves.forEachInRange(startTick, endTick, [&](DsCurve *curve) {
+        if (curve->type() == DsCurve::Draw)
+            renderDrawCurve(static_cast<DsDrawCurve *>(curve), startTick, step, count, out);
+        else if (curve->type() == DsCurve::Anchor)
+            renderAnchorCurve(static_cast<DsAnchorCurve *>(curve), startTick, step, count, out);
+    });
+}
+void DsParamSampler::renderDrawCurve(const DsDrawCurve *curve, int startTick, int step,
+                                     int count, float *out) {
+    auto valueCount = curve->valueCount();
+    if (valueCount == 0)
+        return;
+    auto valueStep = curve->valueStep();
+    auto begin = firstSampleAt(curve->start(), startTick, step);
+    auto end = qMin(count, firstSampleAt(curve->endTick(), startTick, step));
+    if (begin >= end)
+        return;
+
+    // Decode only the samples the output range needs, plus one for interpolation
+    auto firstTick = startTick + begin * step - curve->start();
+    auto lastTick = startTick + (end - 1) * step - curve->start();
+    auto first = firstTick / valueStep;
+    auto last = qMin(valueCount - 1, lastTick / valueStep + 1);
+    auto n = last - first + 1;
+    m_intBuffer.resize(n);
+    m_floatBuffer.resize(n);
+    curve->readValues(first, n, m_intBuffer.data());
+    SamplingKernels::convert(m_intBuffer.constData(), m_floatBuffer.data(), n);
+    auto values = m_floatBuffer.constData();
+
+    if (step == valueStep && firstTick % valueStep == 0) {
+        std::copy(values, values + (end - begin), out + begin);
+        return;
+    }
+    for (int i = begin; i < end; i++) {
+        auto tick = startTick + i * step - curve->start();
+        auto index = tick / valueStep - first;
+        auto frac = static_cast<float>(tick % valueStep) / valueStep;
+        auto v0 = values[index];
+        auto v1 = index + 1 < n ? values[index + 1] : v0;
+        out[i] = v0 + (v1 - v0) * frac;
+    }
+}
+void DsParamSampler::renderAnchorCurve(const DsAnchorCurve *curve, int startTick, int step,
+                                       int count, float *out) {
+    const auto &nodes = curve->nodes();
+    if (nodes.isEmpty())
+        return;
+    const auto &knots = curve->curve().getKnots();
+
+    // Nodes are sorted, so start from the segment that contains the first sampled tick
+    auto first = std::upper_bound(nodes.cbegin(), nodes.cend(), startTick,
+                                  [](int tick, const DsAnchorNode *node) {
+                                      return tick < node->pos();
+                                  }) -
+                 nodes.cbegin();
+    for (int i = qMax(0, static_cast<int>(first) - 1); i + 1 < nodes.count(); i++) {
+        auto node = nodes.at(i);
+        auto next = nodes.at(i + 1);
+        auto p0 = node->pos();
+        auto p1 = next->pos();
+        if (p1 <= p0)
+            continue;
+        auto begin = firstSampleAt(p0, startTick, step);
+        if (begin >= count)
+            break;
+        auto end = qMin(count, firstSampleAt(p1, startTick, step));
+        if (begin >= end)
+            continue;
+
+        const float v0 = node->value();
+        const float v1 = next->value();
+        const float length = p1 - p0;
+        const float t0 = (startTick + static_cast<float>(begin) * step - p0) / length;
+        const float dt = step / length;
+        float m0;
+        float m1;
+        switch (node->interpMode()) {
+            case DsAnchorNode::None:
+                std::fill(out + begin, out + end, v0);
+                continue;
+            case DsAnchorNode::Linear:
+                m0 = m1 = v1 - v0;
+                break;
+            case DsAnchorNode::Hermite:
+                // Monotone tangents of the anchored curve
+                m0 = static_cast<float>(knots.at(i).getSlope() * length);
+                m1 = static_cast<float>(knots.at(i + 1).getSlope() * length);
+                break;
+            case DsAnchorNode::Cubic:
+            default: {
+                // Catmull-Rom tangents, one-sided at the ends, scaled to this segment
+                auto prev = i > 0 ? nodes.at(i - 1) : node;
+                auto after = i + 2 < nodes.count() ? nodes.at(i + 2) : next;
+                auto slope = [](const DsAnchorNode *a, const DsAnchorNode *b) {
+                    return b->pos() == a->pos()
+                               ? 0.0f
+                               : static_cast<float>(b->value() - a->value()) / (b->pos() - a->pos());
+                };
+                m0 = slope(prev, next) * length;
+                m1 = slope(node, after) * length;
+                break;
+            }
+        }
+        SamplingKernels::hermite(t0, dt, end - begin, v0, v1, m0, m1, out + begin);
+    }
+
+    // The last node itself ends the curve
+    auto lastNode = nodes.last();
+    auto offset = static_cast<qint64>(lastNode->pos()) - startTick;
+    if (offset >= 0 && offset % step == 0 && offset / step < count)
+        out[offset / step] = lastNode->value();
+}
@@ -0,0 +1,55 @@
+//
+// Created by fluty on 2024/2/14.
+//
+
+#ifndef DSPARAMSAMPLER_H
+#define DSPARAMSAMPLER_H
+
+#include <QList>
+#include <QVector>
+
+#include "DsParams.h"
+
+// Turns a DsParam into a dense float buffer sampled every `step` ticks.
+//
+// Layers are resolved as follows:
+// - a tick covered by an edited curve takes the edited value, otherwise the original one;
+// - envelope curves are offsets added on top of that value, 0 where no envelope exists;
+// - ticks covered by neither original nor edited curves are NaN.
+// Draw curves are interpolated linearly between their samples. Anchor curves use the mode
+// of the left node of each segment: None holds the value, Linear interpolates linearly,
+// Hermite uses the monotone tangents of DsAnchorCurve::curve() and Cubic uses Catmull-Rom
+// tangents.
+//
+// A sampler keeps its scratch buffers between calls, so reuse one instance (or use
+// sampleBatch()) when sampling many params. It is not thread-safe.
+class DsParamSampler {
+public:
+    class Request {
+    public:
+        const DsParam *param = nullptr;
+        int startTick = 0;
+        int step = 5;
+        int count = 0;
+        float *out = nullptr;
+    };
+
+    // Samples ticks startTick + i * step for i in [0, count) into out
+    void sample(const DsParam &param, int startTick, int step, int count, float *out);
+    QVector<float> sample(const DsParam &param, int startTick, int endTick, int step);
+    void sampleBatch(const QList<Request> &requests);
+
+private:
+    void renderLayer(const OverlapableSerialList<DsCurve> &curves, int startTick, int step,
+                     int count, float *out);
+    void renderDrawCurve(const DsDrawCurve *curve, int startTick, int step, int count,
+                         float *out);
+    void renderAnchorCurve(const DsAnchorCurve *curve, int startTick, int step, int count,
+                           float *out);
+
+    QVector<int> m_intBuffer;
+    QVector<float> m_floatBuffer;
+    QVector<float> m_envelopeBuffer;
+};
+
+#endif // DSPARAMSAMPLER_H
@@ -3,3 +3,26 @@
 //
 
 #include "DsParams.h"
+
+OverlapableSerialList<DsCurve> &DsParam::curves(ParamCurveType type) {
+    switch (type) {
+        case Original:
+            return original;
+        case Edited:
+            return edited;
+        default:
+            return envelope;
+    }
+}
+DsParam &DsParams::param(ParamType type) {
+    switch (type) {
+        case Pitch:
+            return pitch;
+        case Energy:
+            return energy;
+        case Tension:
+            return tension;
+        default:
+            return breathiness;
+    }
+}
@@ -15,6 +15,8 @@ public:
     OverlapableSerialList<DsCurve> original;
     OverlapableSerialList<DsCurve> edited;
     OverlapableSerialList<DsCurve> envelope;
+
+    OverlapableSerialList<DsCurve> &curves(ParamCurveType type);
 };
 
 class DsParams {
@@ -24,6 +26,8 @@ public:
     DsParam energy;
     DsParam tension;
     DsParam breathiness;
+
+    DsParam &param(ParamType type);
 };
 
 
@@ -0,0 +1,42 @@
+//
+// Created by fluty on 2024/1/27.
+//
+
+#ifndef DSPHONEMES_H
+#define DSPHONEMES_H
+
+#include <QList>
+#include <QString>
+
+#include "../Utils/Symbol.h"
+
+class DsPhoneme {
+public:
+    enum DsPhonemeType { Ahead, Normal, Final };
+
+    DsPhoneme(DsPhonemeType type, const QString &name, int start)
+        : type(type), name(name), start(start) {
+    }
+    DsPhoneme(DsPhonemeType type, Symbol name, int start) : type(type), name(name), start(start) {
+    }
+    DsPhonemeType type;
+    Symbol name;
+    int start;
+};
+
+class DsPhonemes {
+public:
+    enum DsPhonemesType { Original, Edited };
+    QList<DsPhoneme> original;
+    QList<DsPhoneme> edited;
+
+    bool isEmpty() const {
+        return original.isEmpty() && edited.isEmpty();
+    }
+    // Approximate heap usage in bytes. Names are interned and not counted.
+    qint64 memoryUsage() const {
+        return (original.count() + edited.count()) * static_cast<qint64>(sizeof(DsPhoneme));
+    }
+};
+
+#endif // DSPHONEMES_H
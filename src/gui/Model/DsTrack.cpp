@@ -11,6 +11,7 @@ QString DsTrack::name() const {
 }
 void DsTrack::setName(const QString &name) {
     m_name = name;
+    m_revision++;
     emit propertyChanged();
 }
 DsTrackControl DsTrack::control() const {
@@ -18,44 +19,94 @@ DsTrackControl DsTrack::control() const {
 }
 void DsTrack::setControl(const DsTrackControl &control) {
     m_control = control;
+    m_revision++;
     emit propertyChanged();
 }
-OverlapableSerialList<DsClip> DsTrack::clips() const {
+const OverlapableSerialList<DsClip> &DsTrack::clips() const {
     return m_clips;
 }
 void DsTrack::insertClip(DsClip *clip) {
     m_clips.add(clip);
-    qDebug() << "DsTrack emit clipChanged Inserted" << clip->id();
-    emit clipChanged(Inserted, clip->id(), clip);
+    m_revision++;
+    notifyClipChanged(Inserted, clip);
 }
 void DsTrack::removeClip(DsClip *clip) {
     m_clips.remove(clip);
-    qDebug() << "DsTrack emit clipChanged Removed" << clip->id();
-    emit clipChanged(Removed, clip->id(), clip);
+    m_revision++;
+    notifyClipChanged(Removed, clip);
 }
 QColor DsTrack::color() const {
     return m_color;
 }
 void DsTrack::setColor(const QColor &color) {
     m_color = color;
+    m_revision++;
     emit propertyChanged();
 }
+quint64 DsTrack::revision() const {
+    return m_revision;
+}
+qint64 DsTrack::memoryUsage() const {
+    qint64 bytes = sizeof(DsTrack) + m_name.size() * sizeof(QChar);
+    for (const auto clip : m_clips)
+        bytes += clip->memoryUsage();
+    return bytes;
+}
+DsTrackHashes DsTrack::contentHashes() {
+    DsTrackHashes hashes;
+    ContentHash properties;
+    properties.add(m_name)
+        .add(m_control.gain())
+        .add(m_control.pan())
+        .add(m_control.mute())
+        .add(m_control.solo())
+        .add(static_cast<quint64>(m_color.rgba()));
+    hashes.properties = properties.result();
+
+    ContentHash hash;
+    hash.add(hashes.properties);
+    for (const auto clip : m_clips) {
+        auto clipHashes = clip->contentHashes();
+        hash.add(clipHashes.hash);
+        hashes.clips.insert(clip->id(), clipHashes);
+    }
+    hashes.hash = hash.result();
+    return hashes;
+}
 void DsTrack::removeClipQuietly(DsClip *clip) {
     m_clips.remove(clip);
+    m_revision++;
 }
 void DsTrack::insertClipQuietly(DsClip *clip) {
     m_clips.add(clip);
+    m_revision++;
 }
 void DsTrack::notityClipPropertyChanged(DsClip *clip) {
-    qDebug() << "DsTrack::notityClipPropertyChanged" << clip->id();
-    emit clipChanged(PropertyChanged, clip->id(), clip);
+    notifyClipChanged(PropertyChanged, clip);
 }
 
 DsClip *DsTrack::findClipById(int id) {
-    for (int i = 0; i < m_clips.count(); i++) {
-        auto clip = m_clips.at(i);
-        if (clip->id() == id)
-            return clip;
-    }
+    auto clip = UniqueObject::find<DsClip>(id);
+    if (clip && m_clips.contains(clip))
+        return clip;
     return nullptr;
+}
+void DsTrack::flushBatchedChanges() {
+    m_batchedClipChanges.forEachRun([this](ClipChangeType type, const QList<DsClip *> &clips) {
+        emit clipsChanged(type, clips);
+    });
+    m_batchedClipChanges.clear();
+}
+void DsTrack::discardBatchedChanges() {
+    m_batchedClipChanges.clear();
+}
+void DsTrack::notifyClipChanged(ClipChangeType type, DsClip *clip) {
+    if (isBatching()) {
+        m_batchedClipChanges.add(type, clip);
+        scheduleFlush();
+        return;
+    }
+    qDebug() << "DsTrack emit clipChanged" << type << clip->id();
+    emit clipChanged(type, clip->id(), clip);
+    emit clipsChanged(type, {clip});
 }
\ No newline at end of file
@@ -8,12 +8,13 @@
 #include <QString>
 #include <QColor>
 
+#include "BatchedNotifier.h"
 #include "DsClip.h"
 #include "DsTrackControl.h"
 #include "Utils/UniqueObject.h"
 #include "Utils/OverlapableSerialList.h"
 
-class DsTrack : public QObject, public UniqueObject {
+class DsTrack : public QObject, public UniqueObject, public BatchedNotifier {
     Q_OBJECT
 
 public:
@@ -23,11 +24,17 @@ public:
     void setName(const QString &name);
     DsTrackControl control() const;
     void setControl(const DsTrackControl &control);
-    OverlapableSerialList<DsClip> clips() const;
+    const OverlapableSerialList<DsClip> &clips() const;
     void insertClip(DsClip *clip);
     void removeClip(DsClip *clip);
     QColor color() const;
     void setColor(const QColor &color);
+    // Incremented by property changes and clip insertions and removals
+    quint64 revision() const;
+    // Approximate bytes held by the track and its clips
+    qint64 memoryUsage() const;
+    // Content hashes of the track and of its clips, see DsClip::contentHashes()
+    DsTrackHashes contentHashes();
 
     // void updateClip(DsClip *clip);
     void removeClipQuietly(DsClip *clip);
@@ -50,12 +57,23 @@ public:
 signals:
     void propertyChanged();
     void clipChanged(ClipChangeType type, int id, DsClip *clip);
+    // Emitted for every change, and once per run of same-type changes inside a batch,
+    // where clipChanged() is not emitted
+    void clipsChanged(ClipChangeType type, const QList<DsClip *> &clips);
+
+protected:
+    void flushBatchedChanges() override;
+    void discardBatchedChanges() override;
 
 private:
+    void notifyClipChanged(ClipChangeType type, DsClip *clip);
+
     QString m_name;
     DsTrackControl m_control = DsTrackControl();
     OverlapableSerialList<DsClip> m_clips;
     QColor m_color;
+    quint64 m_revision = 0;
+    BatchedChanges<ClipChangeType, Inserted, PropertyChanged, Removed, DsClip *> m_batchedClipChanges;
 };
 
 
@@ -0,0 +1,413 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#ifndef ANCHOREDCURVE_H
+#define ANCHOREDCURVE_H
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <QVector>
+
+#include "SamplingKernels.h"
+
+// Monotone piecewise cubic Hermite curve through a set of knots.
+//
+// Knots are kept sorted by position in contiguous storage, and every edit only recomputes
+// the slopes of the knots next to the edited ones and the segments touching them.
+// getValueLinspace() walks the segments once instead of searching for every point.
+
+template <typename T, typename U>
+class Knot {
+public:
+    Knot() = default;
+    Knot(T position, U value) : position(position), value(value) {
+    }
+    Knot(T position, U value, double slope) : position(position), value(value), slope(slope) {
+    }
+
+    T getPosition() const {
+        return position;
+    }
+    void setPosition(T position) {
+        this->position = position;
+    }
+    U getValue() const {
+        return value;
+    }
+    void setValue(U value) {
+        this->value = value;
+    }
+    double getSlope() const {
+        return slope;
+    }
+    void setSlope(double slope) {
+        this->slope = slope;
+    }
+
+    bool operator==(const Knot &other) const {
+        return position == other.position;
+    }
+
+private:
+    T position = T();
+    U value = U();
+    double slope = 0.0;
+};
+
+template <typename T, typename U>
+class Segment {
+public:
+    Segment() = default;
+    Segment(const Knot<T, U> &k1, const Knot<T, U> &k2)
+        : x_k(k1.getPosition()), x_k1(k2.getPosition()), y_k(k1.getValue()), y_k1(k2.getValue()),
+          m_k(k1.getSlope()), m_k1(k2.getSlope()) {
+    }
+
+    T getStart() const {
+        return x_k;
+    }
+    T getEnd() const {
+        return x_k1;
+    }
+
+    U getValue(T position) const {
+        U res;
+        getValues(position, 0, 1, &res);
+        return res;
+    }
+
+    // Evaluates the segment at position + i * step for i in [0, n)
+    void getValues(double position, double step, int n, U *out) const {
+        const double length = static_cast<double>(x_k1) - x_k;
+        if (length <= 0) {
+            std::fill(out, out + n, y_k1);
+            return;
+        }
+        const double t0 = (position - x_k) / length;
+        const double dt = step / length;
+        const double m0 = m_k * length;
+        const double m1 = m_k1 * length;
+        if constexpr (std::is_same<U, float>::value) {
+            SamplingKernels::hermite(static_cast<float>(t0), static_cast<float>(dt), n, y_k, y_k1,
+                                     static_cast<float>(m0), static_cast<float>(m1), out);
+        } else {
+            const double a = 2 * (static_cast<double>(y_k) - y_k1) + m0 + m1;
+            const double b = 3 * (static_cast<double>(y_k1) - y_k) - 2 * m0 - m1;
+            for (int i = 0; i < n; i++) {
+                const double t = t0 + i * dt;
+                out[i] = static_cast<U>(((a * t + b) * t + m0) * t + y_k);
+            }
+        }
+    }
+
+private:
+    T x_k = T();
+    T x_k1 = T();
+    U y_k = U();
+    U y_k1 = U();
+    double m_k = 0.0;
+    double m_k1 = 0.0;
+};
+
+template <typename T, typename U>
+class AnchoredCurve {
+public:
+    AnchoredCurve() = default;
+    explicit AnchoredCurve(const QVector<Knot<T, U>> &knots) {
+        merge(knots);
+    }
+    AnchoredCurve(std::initializer_list<T> positions, std::initializer_list<U> values) {
+        merge(positions, values);
+    }
+
+    int count() const {
+        return knots.count();
+    }
+    U getValue(T position) const;
+    std::vector<std::pair<T, U>> getValueLinspace(T start, T end, int num) const;
+    // Values at start + i * (end - start) / num for i in [0, num)
+    void getValueLinspace(double start, double end, int num, U *out) const;
+
+    // A knot at the position of an existing one replaces it
+    void insert(const Knot<T, U> &knot);
+    void insert(T position, U value);
+    void merge(const QVector<Knot<T, U>> &knots);
+    void merge(const AnchoredCurve &other);
+    void merge(std::initializer_list<T> positions, std::initializer_list<U> values);
+    void remove(T x);
+    void removeRange(T l, T r); // 移除闭区间[l,r]
+    void clear();
+
+    const QVector<Knot<T, U>> &getKnots() const {
+        return knots;
+    }
+    const QVector<Segment<T, U>> &getSegments() const {
+        return segments;
+    }
+
+private:
+    QVector<Knot<T, U>> knots;
+    QVector<Segment<T, U>> segments;
+
+    int lowerBound(T position) const;
+    double getInteriorSlope(int index) const;
+    double getEndSlope(int index) const;
+
+    void update(int start_index, int end_index); // 更新闭区间[start_index,end_index]
+};
+
+template <typename T, typename U>
+U AnchoredCurve<T, U>::getValue(T position) const {
+    if (knots.isEmpty())
+        return U();
+    auto index = lowerBound(position);
+    if (index == knots.count())
+        return knots.last().getValue();
+    if (index == 0 || knots.at(index).getPosition() == position)
+        return knots.at(index).getValue();
+    return segments.at(index - 1).getValue(position);
+}
+
+template <typename T, typename U>
+std::vector<std::pair<T, U>> AnchoredCurve<T, U>::getValueLinspace(T start, T end,
+                                                                   int num) const {
+    std::vector<std::pair<T, U>> res;
+    if (num <= 0 || knots.isEmpty())
+        return res;
+    res.reserve(num);
+    int segment = qMax(0, lowerBound(start) - 1);
+    for (int i = 0; i < num; i++) {
+        double w = static_cast<double>(i) / num;
+        auto position = static_cast<T>((1.0 - w) * start + w * end);
+        while (segment < segments.count() && segments.at(segment).getEnd() <= position)
+            segment++;
+        U value;
+        if (position <= knots.first().getPosition())
+            value = knots.first().getValue();
+        else if (segment >= segments.count())
+            value = knots.last().getValue();
+        else
+            value = segments.at(segment).getValue(position);
+        res.emplace_back(position, value);
+    }
+    return res;
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::getValueLinspace(double start, double end, int num, U *out) const {
+    if (num <= 0)
+        return;
+    if (knots.isEmpty()) {
+        std::fill(out, out + num, U());
+        return;
+    }
+    const double step = (end - start) / num;
+    auto position = [&](int i) { return start + i * step; };
+
+    int i = 0;
+    const double first = knots.first().getPosition();
+    while (i < num && position(i) <= first)
+        out[i++] = knots.first().getValue();
+
+    int segment = i < num ? qMax(0, lowerBound(static_cast<T>(std::floor(position(i)))) - 1) : 0;
+    while (i < num && segment < segments.count()) {
+        const auto &s = segments.at(segment);
+        const double segmentEnd = s.getEnd();
+        // Points of this run lie before the end of the segment
+        int runEnd = num;
+        if (step > 0)
+            runEnd = static_cast<int>(
+                qBound(static_cast<double>(i), std::ceil((segmentEnd - start) / step), 1.0 * num));
+        while (runEnd > i && position(runEnd - 1) >= segmentEnd)
+            runEnd--;
+        while (runEnd < num && position(runEnd) < segmentEnd)
+            runEnd++;
+        if (runEnd > i) {
+            s.getValues(position(i), step, runEnd - i, out + i);
+            i = runEnd;
+        }
+        segment++;
+    }
+    while (i < num)
+        out[i++] = knots.last().getValue();
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::insert(const Knot<T, U> &knot) {
+    auto index = lowerBound(knot.getPosition());
+    if (index < knots.count() && knots.at(index) == knot) {
+        knots[index] = knot;
+    } else {
+        knots.insert(index, knot);
+        if (knots.count() > 1)
+            segments.insert(qMin(index, segments.count()), Segment<T, U>());
+    }
+    update(index - 1, index + 1);
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::insert(T position, U value) {
+    insert(Knot<T, U>(position, value));
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::merge(const QVector<Knot<T, U>> &knots) {
+    if (knots.isEmpty())
+        return;
+    auto incoming = knots;
+    std::stable_sort(incoming.begin(), incoming.end(),
+                     [](const Knot<T, U> &a, const Knot<T, U> &b) {
+                         return a.getPosition() < b.getPosition();
+                     });
+    // Merge the sorted runs; incoming knots replace existing ones at the same position
+    QVector<Knot<T, U>> merged;
+    merged.reserve(this->knots.count() + incoming.count());
+    int i = 0;
+    int j = 0;
+    int firstChanged = -1;
+    int lastChanged = -1;
+    while (i < this->knots.count() || j < incoming.count()) {
+        bool takeIncoming =
+            i == this->knots.count() ||
+            (j < incoming.count() &&
+             incoming.at(j).getPosition() <= this->knots.at(i).getPosition());
+        if (takeIncoming) {
+            if (i < this->knots.count() && this->knots.at(i) == incoming.at(j))
+                i++;
+            // Later duplicates in the incoming list win as well
+            if (lastChanged >= 0 && lastChanged == merged.count() - 1 &&
+                merged.last() == incoming.at(j))
+                merged.last() = incoming.at(j);
+            else
+                merged.append(incoming.at(j));
+            if (firstChanged < 0)
+                firstChanged = merged.count() - 1;
+            lastChanged = merged.count() - 1;
+            j++;
+        } else {
+            merged.append(this->knots.at(i++));
+        }
+    }
+    this->knots = merged;
+    segments.resize(qMax(0, this->knots.count() - 1));
+    update(firstChanged - 1, lastChanged + 1);
+    // Knots after the merged ones have shifted, so their segments are rebuilt as well.
+    // This is a plain copy; slopes outside the changed range are kept.
+    for (int k = 0; k < segments.count(); k++)
+        segments[k] = Segment<T, U>(this->knots[k], this->knots[k + 1]);
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::merge(const AnchoredCurve &other) {
+    merge(other.getKnots());
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::merge(std::initializer_list<T> positions,
+                                std::initializer_list<U> values) {
+    QVector<Knot<T, U>> knots_new;
+    auto value = values.begin();
+    for (auto position = positions.begin(); position != positions.end() && value != values.end();
+         ++position, ++value)
+        knots_new.append(Knot<T, U>(*position, *value));
+    merge(knots_new);
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::remove(T x) {
+    auto index = lowerBound(x);
+    if (index == knots.count() || knots.at(index).getPosition() != x)
+        return;
+    knots.remove(index);
+    if (!segments.isEmpty())
+        segments.remove(qMin(index, segments.count() - 1));
+    update(index - 1, index);
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::removeRange(T l, T r) {
+    auto start_index = lowerBound(l);
+    auto end_index = start_index;
+    while (end_index < knots.count() && knots.at(end_index).getPosition() <= r)
+        end_index++;
+    if (end_index == start_index)
+        return;
+    auto removed = end_index - start_index;
+    knots.remove(start_index, removed);
+    // Drop the segments that ended at removed knots, or those at the tail when the range
+    // reaches the last knot
+    auto segmentCount = qMax(0, knots.count() - 1);
+    auto first = qBound(0, start_index, segmentCount);
+    segments.remove(first, segments.count() - segmentCount);
+    update(start_index - 1, start_index);
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::clear() {
+    knots.clear();
+    segments.clear();
+}
+
+template <typename T, typename U>
+int AnchoredCurve<T, U>::lowerBound(T position) const {
+    auto it = std::lower_bound(
+        knots.cbegin(), knots.cend(), position,
+        [](const Knot<T, U> &knot, T pos) { return knot.getPosition() < pos; });
+    return static_cast<int>(it - knots.cbegin());
+}
+
+template <typename T, typename U>
+double AnchoredCurve<T, U>::getInteriorSlope(int index) const {
+    double delta_y_l = static_cast<double>(knots[index].getValue()) - knots[index - 1].getValue();
+    double delta_y_r = static_cast<double>(knots[index + 1].getValue()) - knots[index].getValue();
+    if ((delta_y_l * delta_y_r) <= 0)
+        return 0;
+    double delta_x_l = static_cast<double>(knots[index].getPosition()) -
+                       knots[index - 1].getPosition();
+    double delta_x_r = static_cast<double>(knots[index + 1].getPosition()) -
+                       knots[index].getPosition();
+    double slope_l = delta_y_l / delta_x_l;
+    double slope_r = delta_y_r / delta_x_r;
+    double w_l = delta_x_l + 2 * delta_x_r, w_r = 2 * delta_x_l + delta_x_r;
+    return (w_l + w_r) / (w_l / slope_l + w_r / slope_r);
+}
+
+template <typename T, typename U>
+double AnchoredCurve<T, U>::getEndSlope(int index) const {
+    // One-sided secant at either end
+    auto other = index == 0 ? 1 : index - 1;
+    double dx = static_cast<double>(knots[index].getPosition()) - knots[other].getPosition();
+    double dy = static_cast<double>(knots[index].getValue()) - knots[other].getValue();
+    return dx == 0 ? 0 : dy / dx;
+}
+
+template <typename T, typename U>
+void AnchoredCurve<T, U>::update(int start_index, int end_index) {
+    auto len = knots.count();
+    if (len <= 1) {
+        if (len == 1)
+            knots[0].setSlope(0);
+        segments.clear();
+        return;
+    }
+    start_index = qMax(0, start_index);
+    end_index = qMin(len - 1, end_index);
+    // A knot's slope depends on its direct neighbours only
+    for (int i = start_index; i <= end_index; i++) {
+        if (i == 0 || i == len - 1)
+            knots[i].setSlope(getEndSlope(i));
+        else
+            knots[i].setSlope(getInteriorSlope(i));
+    }
+    // Segments starting at start_index - 1 up to end_index touch the updated knots
+    for (int i = qMax(0, start_index - 1); i <= qMin(end_index, len - 2); i++)
+        segments[i] = Segment<T, U>(knots[i], knots[i + 1]);
+}
+
+#endif // ANCHOREDCURVE_H
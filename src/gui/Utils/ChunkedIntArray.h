@@ -0,0 +1,226 @@
+//
+// Created by fluty on 2024/2/13.
+//
+
+#ifndef CHUNKEDINTARRAY_H
+#define CHUNKEDINTARRAY_H
+
+#include <algorithm>
+
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+// Compact array of ints for densely sampled parameter curves.
+//
+// Values are split into chunks of ChunkSize. Each chunk stores its minimum as a base and
+// every value as an unsigned delta from it, using 1, 2 or 4 bytes per value depending on the
+// range of the chunk. Smooth curves such as pitch in cents or energy mostly fit in 1 or 2
+// bytes. Random access stays O(1), sequential decoding runs over contiguous bytes, and a
+// range write only re-encodes the chunks it touches.
+class ChunkedIntArray {
+public:
+    static constexpr int ChunkSize = 256;
+
+    ChunkedIntArray() = default;
+    explicit ChunkedIntArray(const QList<int> &values) {
+        setValues(values);
+    }
+
+    int count() const {
+        return m_count;
+    }
+    bool isEmpty() const {
+        return m_count == 0;
+    }
+    int at(int index) const {
+        Q_ASSERT(index >= 0 && index < m_count);
+        return m_chunks.at(index / ChunkSize).at(index % ChunkSize);
+    }
+    void clear() {
+        m_chunks.clear();
+        m_count = 0;
+    }
+
+    void append(int value) {
+        write(m_count, &value, 1);
+    }
+    void setValues(const QList<int> &values) {
+        clear();
+        auto buffer = values.toVector();
+        write(0, buffer.constData(), buffer.count());
+    }
+    QList<int> toList() const {
+        QVector<int> buffer(m_count);
+        read(0, m_count, buffer.data());
+        return buffer.toList();
+    }
+
+    // Decodes count values starting at index into out
+    void read(int index, int count, int *out) const {
+        Q_ASSERT(index >= 0 && index + count <= m_count);
+        while (count > 0) {
+            const auto &chunk = m_chunks.at(index / ChunkSize);
+            auto offset = index % ChunkSize;
+            auto n = qMin(count, chunk.count - offset);
+            chunk.decode(offset, n, out);
+            index += n;
+            count -= n;
+            out += n;
+        }
+    }
+
+    // Overwrites count values starting at index. Writing past the end extends the array, so
+    // index may be at most count().
+    void write(int index, const int *values, int count) {
+        Q_ASSERT(index >= 0 && index <= m_count);
+        while (count > 0) {
+            auto chunkIndex = index / ChunkSize;
+            auto offset = index % ChunkSize;
+            if (chunkIndex == m_chunks.count())
+                m_chunks.append(Chunk());
+            auto &chunk = m_chunks[chunkIndex];
+            auto n = qMin(count, ChunkSize - offset);
+            chunk.write(offset, values, n);
+            m_count = qMax(m_count, index + n);
+            index += n;
+            count -= n;
+            values += n;
+        }
+    }
+    void write(int index, const QList<int> &values) {
+        auto buffer = values.toVector();
+        write(index, buffer.constData(), buffer.count());
+    }
+
+    // Drops the values from count on
+    void truncate(int count) {
+        Q_ASSERT(count >= 0);
+        if (count >= m_count)
+            return;
+        m_chunks.resize((count + ChunkSize - 1) / ChunkSize);
+        if (count % ChunkSize != 0)
+            m_chunks.last().truncate(count % ChunkSize);
+        m_count = count;
+    }
+
+    // Approximate heap usage in bytes
+    qint64 memoryUsage() const {
+        qint64 bytes = m_chunks.capacity() * static_cast<qint64>(sizeof(Chunk));
+        for (const auto &chunk : m_chunks)
+            bytes += chunk.data.capacity();
+        return bytes;
+    }
+
+private:
+    class Chunk {
+    public:
+        int base = 0;
+        int width = 1; // bytes per delta
+        int count = 0;
+        QByteArray data;
+
+        int at(int offset) const {
+            auto p = reinterpret_cast<const uchar *>(data.constData());
+            switch (width) {
+                case 1:
+                    return base + p[offset];
+                case 2:
+                    return base + reinterpret_cast<const quint16 *>(p)[offset];
+                default:
+                    return static_cast<int>(base + reinterpret_cast<const quint32 *>(p)[offset]);
+            }
+        }
+        void decode(int offset, int n, int *out) const {
+            auto p = reinterpret_cast<const uchar *>(data.constData());
+            if (width == 1) {
+                for (int i = 0; i < n; i++)
+                    out[i] = base + p[offset + i];
+            } else if (width == 2) {
+                auto p16 = reinterpret_cast<const quint16 *>(p) + offset;
+                for (int i = 0; i < n; i++)
+                    out[i] = base + p16[i];
+            } else {
+                auto p32 = reinterpret_cast<const quint32 *>(p) + offset;
+                for (int i = 0; i < n; i++)
+                    out[i] = static_cast<int>(base + p32[i]);
+            }
+        }
+        void truncate(int n) {
+            // The remaining values still fit the frame of the chunk
+            count = n;
+            data.resize(n * width);
+        }
+        void write(int offset, const int *values, int n) {
+            auto newCount = qMax(count, offset + n);
+            bool fits = count > 0;
+            for (int i = 0; fits && i < n; i++) {
+                auto delta = static_cast<qint64>(values[i]) - base;
+                fits = delta >= 0 && delta <= maxDelta();
+            }
+            if (!fits) {
+                // Re-encode the whole chunk with a frame that covers the new values
+                int buffer[ChunkSize];
+                decode(0, count, buffer);
+                std::copy(values, values + n, buffer + offset);
+                auto low = buffer[0];
+                auto high = buffer[0];
+                for (int i = 1; i < newCount; i++) {
+                    low = qMin(low, buffer[i]);
+                    high = qMax(high, buffer[i]);
+                }
+                encode(buffer, newCount, low, widthFor(static_cast<qint64>(high) - low));
+                return;
+            }
+            if (newCount > count) {
+                data.resize(newCount * width);
+                count = newCount;
+            }
+            auto p = reinterpret_cast<uchar *>(data.data());
+            for (int i = 0; i < n; i++)
+                store(p, offset + i, static_cast<quint32>(values[i]) - static_cast<quint32>(base));
+        }
+
+    private:
+        static int widthFor(qint64 range) {
+            if (range <= 0xFF)
+                return 1;
+            if (range <= 0xFFFF)
+                return 2;
+            return 4;
+        }
+        qint64 maxDelta() const {
+            switch (width) {
+                case 1:
+                    return 0xFF;
+                case 2:
+                    return 0xFFFF;
+                default:
+                    return 0xFFFFFFFF;
+            }
+        }
+        void store(uchar *p, int offset, quint32 delta) const {
+            if (width == 1)
+                p[offset] = static_cast<uchar>(delta);
+            else if (width == 2)
+                reinterpret_cast<quint16 *>(p)[offset] = static_cast<quint16>(delta);
+            else
+                reinterpret_cast<quint32 *>(p)[offset] = delta;
+        }
+        void encode(const int *values, int n, int newBase, int newWidth) {
+            base = newBase;
+            width = newWidth;
+            count = n;
+            data.resize(n * width);
+            data.squeeze();
+            auto p = reinterpret_cast<uchar *>(data.data());
+            for (int i = 0; i < n; i++)
+                store(p, i, static_cast<quint32>(values[i]) - static_cast<quint32>(base));
+        }
+    };
+
+    QVector<Chunk> m_chunks;
+    int m_count = 0;
+};
+
+#endif // CHUNKEDINTARRAY_H
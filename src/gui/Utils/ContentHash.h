@@ -0,0 +1,59 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef CONTENTHASH_H
+#define CONTENTHASH_H
+
+#include <cstring>
+
+#include <QString>
+
+// Incremental 64-bit hash of model content, used to detect changes.
+//
+// Unlike qHash(), which is seeded per process, the result only depends on what was added, so
+// hashes may be compared across sessions and stored with caches. Not cryptographic.
+class ContentHash {
+public:
+    ContentHash &add(quint64 value) {
+        m_state = mix(m_state ^ (value + 0x9E3779B97F4A7C15ULL + (m_state << 6) + (m_state >> 2)));
+        return *this;
+    }
+    ContentHash &add(int value) {
+        return add(static_cast<quint64>(static_cast<quint32>(value)));
+    }
+    ContentHash &add(bool value) {
+        return add(static_cast<quint64>(value));
+    }
+    ContentHash &add(double value) {
+        quint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return add(bits);
+    }
+    ContentHash &add(const QString &string) {
+        // FNV-1a over the UTF-16 code units, then the length so that "ab", "c" differs
+        // from "a", "bc"
+        quint64 h = 0xCBF29CE484222325ULL;
+        for (const auto c : string) {
+            h ^= c.unicode();
+            h *= 0x100000001B3ULL;
+        }
+        return add(h).add(string.size());
+    }
+
+    quint64 result() const {
+        return m_state;
+    }
+
+private:
+    // Finalizer of splitmix64
+    static quint64 mix(quint64 x) {
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    quint64 m_state = 0;
+};
+
+#endif // CONTENTHASH_H
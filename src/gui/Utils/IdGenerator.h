@@ -5,17 +5,98 @@
 #ifndef IDGENERATOR_H
 #define IDGENERATOR_H
 
+#include <atomic>
+
+#include <QMultiHash>
+#include <QMutex>
+#include <QMutexLocker>
+
 #include "Singleton.h"
 
+class UniqueObject;
+
+// Ids of the model objects. Objects may be created on any thread, e.g. by parallel loaders.
 class IdGenerator : public Singleton<IdGenerator> {
 public:
+    static constexpr int BlockSize = 1024;
+
+    // Runtime id, unique within the session. Lock-free: each thread hands out ids from a block
+    // it reserved from the shared counter, so ids only increase within one thread.
     int id() {
-        m_id++;
-        return m_id;
+        thread_local IdBlock block;
+        if (block.next == block.end) {
+            block.next = m_nextBlock.fetch_add(BlockSize, std::memory_order_relaxed);
+            block.end = block.next + BlockSize;
+        }
+        return block.next++;
+    }
+
+    // Id that is saved with the object in the project file, so that it stays the same across
+    // sessions. Never 0.
+    quint64 persistentId() {
+        return m_nextPersistentId.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Makes later persistent ids larger than id, which was restored from a project file
+    void reservePersistentId(quint64 id) {
+        auto next = m_nextPersistentId.load(std::memory_order_relaxed);
+        while (next <= id &&
+               !m_nextPersistentId.compare_exchange_weak(next, id + 1, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Live objects by id. View items are created with the id of the model object they
+    // show, so several objects of different types may share one id.
+    //
+    // The registry is split into shards by id block, each with its own lock. A thread takes
+    // its ids from one block, so threads creating objects at the same time, like the parallel
+    // loaders, mostly register them in different shards and do not wait for each other.
+    void registerObject(int id, UniqueObject *object) {
+        auto &shard = shardOf(id);
+        QMutexLocker locker(&shard.mutex);
+        shard.objects.insert(id, object);
+    }
+    void unregisterObject(int id, UniqueObject *object) {
+        auto &shard = shardOf(id);
+        QMutexLocker locker(&shard.mutex);
+        shard.objects.remove(id, object);
+    }
+    // Returns the first live object with the given id for which match(object) is true
+    template <typename Fn>
+    UniqueObject *findObject(int id, Fn match) const {
+        const auto &shard = shardOf(id);
+        QMutexLocker locker(&shard.mutex);
+        for (auto it = shard.objects.constFind(id); it != shard.objects.cend() && it.key() == id;
+             ++it)
+            if (match(it.value()))
+                return it.value();
+        return nullptr;
     }
 
 private:
-    int m_id = -1;
+    class IdBlock {
+    public:
+        int next = 0;
+        int end = 0;
+    };
+
+    static constexpr int ShardCount = 64;
+    // On its own cache line, so that threads locking neighbouring shards do not slow each
+    // other down
+    class alignas(64) Shard {
+    public:
+        mutable QMutex mutex;
+        QMultiHash<int, UniqueObject *> objects;
+    };
+    Shard &shardOf(int id) {
+        return m_shards[static_cast<quint32>(id) / BlockSize % ShardCount];
+    }
+    const Shard &shardOf(int id) const {
+        return m_shards[static_cast<quint32>(id) / BlockSize % ShardCount];
+    }
+
+    std::atomic<int> m_nextBlock{0};
+    std::atomic<quint64> m_nextPersistentId{1};
+    Shard m_shards[ShardCount];
 };
 
 #endif // IDGENERATOR_H
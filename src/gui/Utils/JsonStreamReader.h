@@ -0,0 +1,370 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+
+// Pull reader for JSON documents read from a device in fixed-size blocks.
+//
+// Unlike QJsonDocument, no tree is built: the caller walks the document and takes each
+// value as it comes, so memory stays at one block plus the current string no matter how large
+// the document is. Objects and arrays are walked with
+//     if (reader.readStartObject())
+//         while (reader.readNextKey())
+//             if (reader.key() == "name") name = reader.readString(); else reader.skipValue();
+// and every key must have its value read or skipped. After an error every read fails and
+// returns a default value, so walking loops end by themselves.
+class JsonStreamReader {
+public:
+    static constexpr int BlockSize = 64 * 1024;
+
+    // offset is where in the document the device is positioned, for reading a value out of
+    // the middle of it
+    explicit JsonStreamReader(QIODevice *device, qint64 offset = 0)
+        : m_device(device), m_blockOffset(offset) {
+    }
+
+    bool hasError() const {
+        return !m_errorString.isEmpty();
+    }
+    QString errorString() const {
+        return m_errorString;
+    }
+    void raiseError(const QString &message) {
+        if (!hasError())
+            m_errorString = QString("%1 at byte %2").arg(message).arg(bytesRead());
+    }
+    // Takes the error of another reader of the same document as is
+    void setError(const QString &errorString) {
+        if (!hasError())
+            m_errorString = errorString;
+    }
+    // Bytes of the document consumed so far
+    qint64 bytesRead() const {
+        return m_blockOffset + m_pos;
+    }
+    // Where the next value starts in the document
+    qint64 valueOffset() {
+        peek();
+        return bytesRead();
+    }
+
+    // Enters an object. Returns false for null, which callers treat as an empty object.
+    bool readStartObject() {
+        return readStart('{');
+    }
+    bool readStartArray() {
+        return readStart('[');
+    }
+    // Moves to the next key of the current object, or leaves the object at its end
+    bool readNextKey() {
+        if (!readNextItem('}'))
+            return false;
+        if (peek() != '"') {
+            raiseError("Expected a key");
+            return false;
+        }
+        readStringBytes(m_key);
+        if (!consume(':')) {
+            raiseError("Expected ':'");
+            return false;
+        }
+        return !hasError();
+    }
+    // Moves to the next element of the current array, or leaves the array at its end
+    bool readNextElement() {
+        return readNextItem(']');
+    }
+    const QByteArray &key() const {
+        return m_key;
+    }
+
+    QString readString() {
+        if (peek() == 'n') {
+            readLiteral("null");
+            return {};
+        }
+        if (peek() != '"') {
+            raiseError("Expected a string");
+            return {};
+        }
+        readStringBytes(m_string);
+        return QString::fromUtf8(m_string);
+    }
+    double readNumber() {
+        if (peek() == 'n') {
+            readLiteral("null");
+            return 0;
+        }
+        // Plain integers, by far the most common numbers in a project, skip the conversion
+        // from text
+        m_string.clear();
+        qint64 integer = 0;
+        bool isInteger = true;
+        for (auto c = current(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+                                 c == 'e' || c == 'E';
+             c = current()) {
+            if (c >= '0' && c <= '9')
+                integer = integer * 10 + (c - '0');
+            else if (c != '-' || !m_string.isEmpty())
+                isInteger = false;
+            m_string.append(c);
+            m_pos++;
+        }
+        if (isInteger && m_string.size() > 0 && m_string.size() < 16 && m_string != "-")
+            return static_cast<double>(m_string.at(0) == '-' ? -integer : integer);
+        bool ok = false;
+        auto value = m_string.toDouble(&ok);
+        if (!ok) {
+            raiseError("Expected a number");
+            return 0;
+        }
+        return value;
+    }
+    int readInt() {
+        return qRound(readNumber());
+    }
+    bool readBool() {
+        if (peek() == 't')
+            return readLiteral("true");
+        if (peek() != 'f' && peek() != 'n')
+            raiseError("Expected a boolean");
+        readLiteral(peek() == 'f' ? "false" : "null");
+        return false;
+    }
+    // Skips the next value, including everything nested in it. Objects and arrays are skipped
+    // by matching their brackets, without reading or checking what is inside.
+    void skipValue() {
+        switch (peek()) {
+            case '{':
+            case '[':
+                skipContainer();
+                break;
+            case '"':
+                readStringBytes(m_string);
+                break;
+            case 't':
+            case 'f':
+            case 'n':
+                readBool();
+                break;
+            default:
+                readNumber();
+                break;
+        }
+    }
+
+private:
+    // Next significant character without consuming it, or 0 at the end of the document
+    char peek() {
+        while (!hasError()) {
+            if (m_pos == m_block.size() && !readBlock())
+                return 0;
+            auto c = m_block.at(m_pos);
+            if (c != ' ' && c != '\n' && c != '\r' && c != '\t')
+                return c;
+            m_pos++;
+        }
+        return 0;
+    }
+    bool consume(char c) {
+        if (peek() != c)
+            return false;
+        m_pos++;
+        return true;
+    }
+    bool readBlock() {
+        m_blockOffset += m_block.size();
+        m_pos = 0;
+        m_block.resize(BlockSize);
+        auto size = m_device->read(m_block.data(), BlockSize);
+        m_block.resize(qMax(size, qint64(0)));
+        return size > 0;
+    }
+    // Raw character without consuming it, where whitespace counts
+    char current() {
+        if (m_pos == m_block.size() && !readBlock())
+            return 0;
+        return m_block.at(m_pos);
+    }
+    // Raw character inside a string or literal
+    char next() {
+        if (m_pos == m_block.size() && !readBlock()) {
+            raiseError("Unexpected end of document");
+            return 0;
+        }
+        return m_block.at(m_pos++);
+    }
+
+    bool readStart(char open) {
+        if (peek() == 'n') {
+            readLiteral("null");
+            return false;
+        }
+        if (!consume(open)) {
+            raiseError(open == '{' ? "Expected an object" : "Expected an array");
+            return false;
+        }
+        m_nesting.append(true);
+        return true;
+    }
+    bool readNextItem(char close) {
+        if (hasError() || m_nesting.isEmpty())
+            return false;
+        if (consume(close)) {
+            m_nesting.removeLast();
+            return false;
+        }
+        if (m_nesting.last())
+            m_nesting.last() = false;
+        else if (!consume(',')) {
+            raiseError("Expected ',' or the end of a container");
+            return false;
+        }
+        return !hasError();
+    }
+    void skipContainer() {
+        m_pos++;
+        int depth = 1;
+        while (depth > 0 && !hasError()) {
+            if (m_pos == m_block.size() && !readBlock()) {
+                raiseError("Unexpected end of document");
+                return;
+            }
+            // Scans the rest of the block without a call per character
+            auto data = m_block.constData();
+            auto size = m_block.size();
+            for (; m_pos < size && depth > 0; m_pos++) {
+                auto c = data[m_pos];
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if (c == '}' || c == ']') {
+                    depth--;
+                } else if (c == '"') {
+                    m_pos++;
+                    // May read further blocks, so the scan starts over after it
+                    skipStringBytes();
+                    break;
+                }
+            }
+        }
+    }
+    // Skips the rest of a string whose opening quote has been consumed
+    void skipStringBytes() {
+        while (!hasError()) {
+            auto c = next();
+            if (c == '"')
+                return;
+            if (c == '\\')
+                next();
+        }
+    }
+    bool readLiteral(const char *literal) {
+        peek();
+        for (auto p = literal; *p; p++)
+            if (next() != *p) {
+                raiseError("Unexpected character");
+                return false;
+            }
+        return true;
+    }
+    // Reads a string into out as UTF-8, resolving escapes
+    void readStringBytes(QByteArray &out) {
+        out.clear();
+        consume('"');
+        while (!hasError()) {
+            auto c = next();
+            if (c == '"')
+                return;
+            if (c != '\\') {
+                out.append(c);
+                continue;
+            }
+            switch (c = next()) {
+                case 'b':
+                    out.append('\b');
+                    break;
+                case 'f':
+                    out.append('\f');
+                    break;
+                case 'n':
+                    out.append('\n');
+                    break;
+                case 'r':
+                    out.append('\r');
+                    break;
+                case 't':
+                    out.append('\t');
+                    break;
+                case 'u':
+                    appendCodePoint(out, readEscapedCodePoint());
+                    break;
+                default:
+                    out.append(c);
+                    break;
+            }
+        }
+    }
+    uint readHex4() {
+        uint value = 0;
+        for (int i = 0; i < 4; i++) {
+            auto c = next();
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                value |= c - 'A' + 10;
+            else
+                raiseError("Invalid escape");
+        }
+        return value;
+    }
+    uint readEscapedCodePoint() {
+        auto value = readHex4();
+        // A surrogate pair is written as two escapes
+        if (value >= 0xD800 && value < 0xDC00 && next() == '\\' && next() == 'u') {
+            auto low = readHex4();
+            return 0x10000 + ((value - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return value;
+    }
+    static void appendCodePoint(QByteArray &out, uint c) {
+        if (c < 0x80) {
+            out.append(static_cast<char>(c));
+        } else if (c < 0x800) {
+            out.append(static_cast<char>(0xC0 | (c >> 6)));
+            out.append(static_cast<char>(0x80 | (c & 0x3F)));
+        } else if (c < 0x10000) {
+            out.append(static_cast<char>(0xE0 | (c >> 12)));
+            out.append(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (c & 0x3F)));
+        } else {
+            out.append(static_cast<char>(0xF0 | (c >> 18)));
+            out.append(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+            out.append(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+            out.append(static_cast<char>(0x80 | (c & 0x3F)));
+        }
+    }
+
+    QIODevice *m_device;
+    QByteArray m_block;
+    int m_pos = 0;
+    qint64 m_blockOffset = 0;
+    // Per open container, whether no item has been read from it yet
+    QVector<bool> m_nesting;
+    QByteArray m_key;
+    QByteArray m_string;
+    QString m_errorString;
+};
+
+
+
+#endif // JSONSTREAMREADER_H
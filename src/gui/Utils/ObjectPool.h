@@ -0,0 +1,136 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <utility>
+
+#include <QVector>
+
+// Pool of objects of type T, allocated in blocks of BlockSize slots.
+//
+// Objects created one after another sit next to each other in memory, a whole block costs
+// one heap allocation, destroyed objects leave their slot to the next create(), and clear()
+// destroys every live object and frees the blocks at once. Only objects of exactly type T
+// may be destroyed through the pool, and destroy() refuses any pointer that is not a live
+// object of the pool. Not thread-safe.
+template <typename T, int BlockSize = 256>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+    ~ObjectPool() {
+        clear();
+    }
+
+    template <typename... Args>
+    T *create(Args &&...args) {
+        if (!m_free)
+            grow();
+        auto slot = m_free;
+        m_free = slot->next;
+        slot->live = true;
+        m_count++;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+    // Returns false and leaves the pool untouched if object is not a live object of this pool
+    bool destroy(T *object) {
+        auto slot = liveSlot(object);
+        if (!slot)
+            return false;
+        object->~T();
+        slot->live = false;
+        slot->next = m_free;
+        m_free = slot;
+        m_count--;
+        return true;
+    }
+    // Whether object was created by this pool and not destroyed since
+    bool contains(const T *object) const {
+        return liveSlot(object) != nullptr;
+    }
+    void clear() {
+        for (const auto block : m_blocks) {
+            for (auto &slot : block->items)
+                if (slot.live)
+                    reinterpret_cast<T *>(slot.storage)->~T();
+            delete block;
+        }
+        m_blocks.clear();
+        m_free = nullptr;
+        m_count = 0;
+    }
+
+    // Live objects
+    int count() const {
+        return m_count;
+    }
+    // Heap allocations made for the objects so far
+    int blockCount() const {
+        return m_blocks.count();
+    }
+    qint64 memoryUsage() const {
+        return m_blocks.count() * static_cast<qint64>(sizeof(Block));
+    }
+
+private:
+    class Slot {
+    public:
+        alignas(T) unsigned char storage[sizeof(T)];
+        Slot *next;
+        bool live;
+    };
+    class Block {
+    public:
+        Slot items[BlockSize];
+    };
+
+    // Blocks are kept sorted by address, so the block an object would sit in is found by a
+    // binary search. The pointer itself is not dereferenced unless it is the start of a slot.
+    Slot *liveSlot(const T *object) const {
+        if (!object)
+            return nullptr;
+        const std::less<const void *> less;
+        auto it = std::upper_bound(
+            m_blocks.cbegin(), m_blocks.cend(), static_cast<const void *>(object),
+            [&less](const void *address, const Block *block) { return less(address, block); });
+        if (it == m_blocks.cbegin())
+            return nullptr;
+        auto block = *(it - 1);
+        auto offset = reinterpret_cast<quintptr>(object) - reinterpret_cast<quintptr>(block);
+        if (offset >= sizeof(Block) || offset % sizeof(Slot) != 0)
+            return nullptr;
+        // The object is the first member of its slot
+        auto &slot = block->items[offset / sizeof(Slot)];
+        return slot.live ? &slot : nullptr;
+    }
+
+    void grow() {
+        auto block = new Block;
+        const std::less<const void *> less;
+        m_blocks.insert(std::upper_bound(m_blocks.begin(), m_blocks.end(), block,
+                                         [&less](const Block *a, const Block *b) {
+                                             return less(a, b);
+                                         }),
+                        block);
+        // Linked backwards, so that slots are handed out in address order
+        for (int i = BlockSize - 1; i >= 0; i--) {
+            auto &slot = block->items[i];
+            slot.live = false;
+            slot.next = m_free;
+            m_free = &slot;
+        }
+    }
+
+    QVector<Block *> m_blocks;
+    Slot *m_free = nullptr;
+    int m_count = 0;
+};
+
+#endif // OBJECTPOOL_H
@@ -5,122 +5,372 @@
 #ifndef SERIALLIST_H
 #define SERIALLIST_H
 
+#include <algorithm>
+#include <climits>
+#include <iterator>
+
 #include <QList>
+#include <QSet>
+#include <QVector>
 
+// Sorted container of overlapable items.
+//
+// Items are kept ordered by overlapStart() in a list of small sorted buckets (sorted-array
+// hybrid). A Fenwick tree over the bucket sizes makes at() and indexOf() logarithmic, and a
+// max tree over the largest overlapEnd() of each bucket finds the buckets that reach a tick in
+// logarithmic time. The overlap scans of add(), remove() and findOverlappedItems() skip every
+// other bucket, and within a bucket the items starting before the range by more than its
+// longest item, so a few long items only slow down the scans of their own buckets.
+// The set of overlapped items is maintained along with add() and remove(), and the range
+// queries (forEachInRange(), itemsInRange()) visit the matching items without allocating.
+//
+// T must provide:
+//     int overlapStart() const;          // sort key, same order as compareTo()
+//     int overlapEnd() const;            // exclusive end used by isOverlappedWith()
+//     bool isOverlappedWith(T *) const;
+// and inherit IOverlapable.
 template <typename T>
 class OverlapableSerialList {
+private:
+    using Bucket = QVector<T *>;
+
 public:
     int count() const;
     void add(T *item);
     void remove(T *item);
     void update(T *item);
+    // Calls edit(item) for each of items, which must be in the list and may have their keys
+    // changed, then restores the order and the overlap state. A large batch is merged back
+    // in one pass over the list, instead of a remove() and add() per item.
+    template <typename Fn>
+    void updateItems(const QList<T *> &items, Fn edit);
     void clear();
-    int indexOf(const T *item);
-    bool contains(const T *item);
+    int indexOf(const T *item) const;
+    bool contains(const T *item) const;
     T *at(int index) const;
     bool isOverlappedItemExists() const;
     QList<T *> findOverlappedItems(T *obj) const;
-    QList<T *> overlappedItems() const;
+    const QSet<T *> &overlappedItems() const;
+    // Calls fn(item) in order for every item intersecting [startTick, endTick)
+    template <typename Fn>
+    void forEachInRange(int startTick, int endTick, Fn fn) const;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T *;
+        using difference_type = int;
+        using pointer = T *const *;
+        using reference = T *const &;
+
+        const_iterator() = default;
+        reference operator*() const {
+            return m_buckets->at(m_bucket).at(m_offset);
+        }
+        pointer operator->() const {
+            return &operator*();
+        }
+        const_iterator &operator++() {
+            if (++m_offset >= m_buckets->at(m_bucket).size()) {
+                m_bucket++;
+                m_offset = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            auto it = *this;
+            ++*this;
+            return it;
+        }
+        const_iterator &operator--() {
+            if (m_offset == 0) {
+                m_bucket--;
+                m_offset = m_buckets->at(m_bucket).size() - 1;
+            } else
+                m_offset--;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            auto it = *this;
+            --*this;
+            return it;
+        }
+        bool operator==(const const_iterator &other) const {
+            return m_bucket == other.m_bucket && m_offset == other.m_offset;
+        }
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
 
-    using iterator = typename QList<T *>::const_iterator;
-    using const_iterator = typename QList<T *>::const_iterator;
-    using reverse_iterator = typename QList<T *>::const_reverse_iterator;
-    using const_reverse_iterator = typename QList<T *>::const_reverse_iterator;
+    private:
+        friend class OverlapableSerialList;
+        const_iterator(const QVector<Bucket> *buckets, int bucket, int offset)
+            : m_buckets(buckets), m_bucket(bucket), m_offset(offset) {
+        }
+        const QVector<Bucket> *m_buckets = nullptr;
+        int m_bucket = 0;
+        int m_offset = 0;
+    };
+
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<const_iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     iterator begin() {
-        return m_list.cbegin();
+        return cbegin();
     }
     iterator end() {
-        return m_list.cend();
+        return cend();
     }
     const_iterator begin() const {
-        return m_list.cbegin();
+        return cbegin();
     }
     const_iterator end() const {
-        return m_list.cend();
+        return cend();
     }
     const_iterator cbegin() const {
-        return m_list.cbegin();
+        return const_iterator(&m_buckets, 0, 0);
     }
     const_iterator cend() const {
-        return m_list.cend();
+        return const_iterator(&m_buckets, m_buckets.size(), 0);
     }
     reverse_iterator rbegin() {
-        return m_list.crbegin();
+        return crbegin();
     }
     reverse_iterator rend() {
-        return m_list.crend();
+        return crend();
     }
     const_reverse_iterator rbegin() const {
-        return m_list.crbegin();
+        return crbegin();
     }
     const_reverse_iterator rend() const {
-        return m_list.crend();
+        return crend();
     }
     const_reverse_iterator crbegin() const {
-        return m_list.crbegin();
+        return const_reverse_iterator(cend());
     }
     const_reverse_iterator crend() const {
-        return m_list.crend();
+        return const_reverse_iterator(cbegin());
+    }
+
+    // Lightweight view over the items intersecting a tick window. It refers to the list
+    // directly, so it is only valid until the list is modified.
+    class Range {
+    public:
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T *;
+            using difference_type = int;
+            using pointer = T *const *;
+            using reference = T *const &;
+
+            reference operator*() const {
+                return *m_it;
+            }
+            const_iterator &operator++() {
+                ++m_it;
+                skipItemsBefore();
+                return *this;
+            }
+            const_iterator operator++(int) {
+                auto it = *this;
+                ++*this;
+                return it;
+            }
+            bool operator==(const const_iterator &other) const {
+                return m_it == other.m_it;
+            }
+            bool operator!=(const const_iterator &other) const {
+                return m_it != other.m_it;
+            }
+
+        private:
+            friend class Range;
+            using BaseIterator = typename OverlapableSerialList::const_iterator;
+            const_iterator(const OverlapableSerialList *list, BaseIterator it, BaseIterator end,
+                           int startTick)
+                : m_list(list), m_it(it), m_end(end), m_startTick(startTick) {
+                skipItemsBefore();
+            }
+            void skipItemsBefore() {
+                m_it = m_list->firstEndingAfter(m_it, m_end, m_startTick);
+            }
+            const OverlapableSerialList *m_list;
+            BaseIterator m_it;
+            BaseIterator m_end;
+            int m_startTick;
+        };
+
+        const_iterator begin() const {
+            return const_iterator(m_list, m_begin, m_end, m_startTick);
+        }
+        const_iterator end() const {
+            return const_iterator(m_list, m_end, m_end, m_startTick);
+        }
+        bool isEmpty() const {
+            return begin() == end();
+        }
+
+    private:
+        friend class OverlapableSerialList;
+        using BaseIterator = typename OverlapableSerialList::const_iterator;
+        Range(const OverlapableSerialList *list, BaseIterator begin, BaseIterator end,
+              int startTick)
+            : m_list(list), m_begin(begin), m_end(end), m_startTick(startTick) {
+        }
+        const OverlapableSerialList *m_list;
+        BaseIterator m_begin;
+        BaseIterator m_end;
+        int m_startTick;
+    };
+    Range itemsInRange(int startTick, int endTick) const;
+
+    // Read-only copy of the list. Taking it is O(1) since the storage is implicitly shared
+    // until the list is modified, and it stays consistent while the owner keeps editing,
+    // so it can be handed to another thread. Only the membership and order are frozen;
+    // the items themselves are still shared.
+    class Snapshot {
+    public:
+        Snapshot() = default;
+        int count() const {
+            return m_list.count();
+        }
+        bool isEmpty() const {
+            return m_list.count() == 0;
+        }
+        T *at(int index) const {
+            return m_list.at(index);
+        }
+        bool contains(const T *item) const {
+            return m_list.contains(item);
+        }
+        template <typename Fn>
+        void forEachInRange(int startTick, int endTick, Fn fn) const {
+            m_list.forEachInRange(startTick, endTick, fn);
+        }
+        Range itemsInRange(int startTick, int endTick) const {
+            return m_list.itemsInRange(startTick, endTick);
+        }
+        const_iterator begin() const {
+            return m_list.cbegin();
+        }
+        const_iterator end() const {
+            return m_list.cend();
+        }
+
+    private:
+        friend class OverlapableSerialList;
+        explicit Snapshot(const OverlapableSerialList &list) : m_list(list) {
+        }
+        OverlapableSerialList m_list;
+    };
+    Snapshot snapshot() const {
+        return Snapshot(*this);
     }
 
 private:
-    QList<T *> &overlappedIOverlapables();
-    QList<T *> m_list;
+    static constexpr int MaxBucketSize = 512;
+    static constexpr int MinBucketSize = MaxBucketSize / 8;
+
+    // Batches smaller than count() / BulkUpdateRatio are updated item by item
+    static constexpr int BulkUpdateRatio = 8;
+
+    // Largest overlapEnd() and length of the items of a bucket
+    class Extent {
+    public:
+        int end = INT_MIN;
+        int length = 0;
+    };
+    static Extent extentOf(const Bucket &bucket);
+    // Index of the bucket an item with the given start belongs to
+    int bucketOf(int start, bool afterEqual) const;
+    // First position whose item starts after the given tick
+    const_iterator upperBound(int tick) const;
+    const_iterator find(const T *item) const;
+    // First position in [it, end) whose item ends after tick
+    const_iterator firstEndingAfter(const_iterator it, const_iterator end, int tick) const;
+    // Calls fn(item) for every item that may overlap [start, end), in order
+    template <typename Fn>
+    void forEachCandidate(int start, int end, Fn fn) const;
+    bool hasOverlapWith(T *item) const;
+    void setOverlapped(T *item, bool overlapped);
+
+    // Replaces the content with the given items, sorted by overlapStart()
+    void rebuild(const Bucket &sorted);
+    void eraseAt(int bucket, int offset);
+    void rebuildIndex();
+    void adjustIndex(int bucket, int delta);
+    int countBefore(int bucket) const;
+    void setExtent(int bucket, const Extent &extent);
+    // First bucket from the given one on with an item ending after tick, or the bucket count
+    int firstBucketEndingAfter(int bucket, int tick) const;
+
+    QVector<Bucket> m_buckets;
+    QVector<int> m_tree;       // Fenwick tree over bucket sizes
+    QVector<Extent> m_extents; // of each bucket
+    QVector<int> m_endTree;    // max tree over the extent ends, leaves from m_endLeaves on
+    int m_endLeaves = 1;
+    QSet<T *> m_overlappedItems;
+    int m_count = 0;
 };
 template <typename T>
 int OverlapableSerialList<T>::count() const {
-    return m_list.size();
+    return m_count;
 }
 template <typename T>
 void OverlapableSerialList<T>::add(T *item) {
-    item->setOverlapped(false);
-    if (m_list.empty()) {
-        m_list.append(item);
-        return;
-    }
-    int num = -1;
-    for (int i = 0; i < m_list.size(); i++) {
-        auto t = m_list.at(i);
-        if (num == -1 && t->compareTo(item) > 0)
-            num = i;
-        if (num == -1) {
-            if (t->isOverlappedWith(item)) {
-                t->setOverlapped(true);
-                item->setOverlapped(true);
-            }
+    setOverlapped(item, false);
+    auto itemStart = item->overlapStart();
+    forEachCandidate(itemStart, item->overlapEnd(), [&](T *t) {
+        if (t->isOverlappedWith(item)) {
+            setOverlapped(t, true);
+            setOverlapped(item, true);
+        }
+    });
+
+    if (m_buckets.isEmpty()) {
+        m_buckets.append(Bucket{item});
+        m_extents.append(extentOf(m_buckets.first()));
+        rebuildIndex();
+    } else {
+        auto b = bucketOf(itemStart, true);
+        auto &bucket = m_buckets[b];
+        auto pos = std::upper_bound(bucket.cbegin(), bucket.cend(), itemStart,
+                                    [](int tick, const T *t) { return tick < t->overlapStart(); });
+        bucket.insert(pos - bucket.cbegin(), item);
+        if (bucket.size() > MaxBucketSize) {
+            auto half = bucket.size() / 2;
+            auto tail = bucket.mid(half);
+            bucket.resize(half);
+            m_extents[b] = extentOf(bucket);
+            m_buckets.insert(b + 1, tail);
+            m_extents.insert(b + 1, extentOf(tail));
+            rebuildIndex();
         } else {
-            if (!t->isOverlappedWith(item))
-                break;
-            t->setOverlapped(true);
-            item->setOverlapped(true);
+            adjustIndex(b, 1);
+            auto extent = m_extents.at(b);
+            extent.end = qMax(extent.end, item->overlapEnd());
+            extent.length = qMax(extent.length, item->overlapEnd() - itemStart);
+            setExtent(b, extent);
         }
     }
-    if (num != -1) {
-        m_list.insert(num, item);
-        return;
-    }
-    m_list.append(item);
+    m_count++;
 }
 template <typename T>
 void OverlapableSerialList<T>::remove(T *item) {
+    auto it = find(item);
+    if (it == cend())
+        return;
+    eraseAt(it.m_bucket, it.m_offset);
+
     if (item->overlapped()) {
-        item->setOverlapped(false);
-        auto overlapedItemsInside = this->overlappedIOverlapables();
-        for (auto t : overlapedItemsInside) {
-            if (t->isOverlappedWith(item)) {
-                bool flag = false;
-                for (auto t2 : overlapedItemsInside) {
-                    if (t2 != t && t2->isOverlappedWith(t)) {
-                        flag = true;
-                        break;
-                    }
-                }
-                t->setOverlapped(flag);
-            }
-        }
+        setOverlapped(item, false);
+        forEachCandidate(item->overlapStart(), item->overlapEnd(), [&](T *t) {
+            if (t->overlapped() && t->isOverlappedWith(item))
+                setOverlapped(t, hasOverlapWith(t));
+        });
     }
-    m_list.removeOne(item);
 }
 // template <typename T>
 // void OverlapableSerialList<T>::update(T *item) {
@@ -128,54 +378,337 @@ void OverlapableSerialList<T>::remove(T *item) {
 //     add(item);
 // }
 template <typename T>
+template <typename Fn>
+void OverlapableSerialList<T>::updateItems(const QList<T *> &items, Fn edit) {
+    if (items.count() * BulkUpdateRatio < m_count) {
+        for (const auto item : items)
+            remove(item);
+        for (const auto item : items)
+            edit(item);
+        for (const auto item : items)
+            add(item);
+        return;
+    }
+
+    QSet<const T *> edited;
+    edited.reserve(items.count());
+    for (const auto item : items)
+        edited.insert(item);
+    Bucket kept;
+    kept.reserve(m_count);
+    for (const auto &bucket : m_buckets)
+        for (const auto item : bucket)
+            if (!edited.contains(item))
+                kept.append(item);
+    Q_ASSERT(kept.size() + items.count() == m_count);
+
+    Bucket moved;
+    moved.reserve(items.count());
+    for (const auto item : items) {
+        edit(item);
+        moved.append(item);
+    }
+    auto byStart = [](const T *a, const T *b) { return a->overlapStart() < b->overlapStart(); };
+    std::stable_sort(moved.begin(), moved.end(), byStart);
+    // Kept items come first among equal starts, as if the moved ones were added afterwards
+    Bucket sorted(kept.size() + moved.size());
+    std::merge(kept.cbegin(), kept.cend(), moved.cbegin(), moved.cend(), sorted.begin(), byStart);
+    rebuild(sorted);
+}
+template <typename T>
 void OverlapableSerialList<T>::clear() {
-    m_list.clear();
+    m_buckets.clear();
+    m_tree.clear();
+    m_extents.clear();
+    m_endTree.clear();
+    m_endLeaves = 1;
+    m_overlappedItems.clear();
+    m_count = 0;
 }
 template <typename T>
-int OverlapableSerialList<T>::indexOf(const T *item) {
-    return m_list.indexOf(item);
+int OverlapableSerialList<T>::indexOf(const T *item) const {
+    auto it = find(item);
+    if (it == cend())
+        return -1;
+    return countBefore(it.m_bucket) + it.m_offset;
 }
 template <typename T>
-bool OverlapableSerialList<T>::contains(const T *item) {
-    return m_list.contains(item);
+bool OverlapableSerialList<T>::contains(const T *item) const {
+    return find(item) != cend();
 }
 template <typename T>
 T *OverlapableSerialList<T>::at(int index) const {
-    return m_list.at(index);
+    Q_ASSERT(index >= 0 && index < m_count);
+    // Descend the Fenwick tree to the last bucket whose prefix count does not exceed index
+    int bucket = 0;
+    int rest = index;
+    int step = 1;
+    while (step * 2 <= m_buckets.size())
+        step *= 2;
+    for (; step > 0; step /= 2) {
+        if (bucket + step <= m_buckets.size() && m_tree.at(bucket + step) <= rest) {
+            bucket += step;
+            rest -= m_tree.at(bucket);
+        }
+    }
+    return m_buckets.at(bucket).at(rest);
 }
 template <typename T>
 bool OverlapableSerialList<T>::isOverlappedItemExists() const {
-    bool overlapped = false;
-    for (const auto &item : m_list)
-        if (item->overlapped()) {
-            overlapped = true;
-            break;
-        }
-    return overlapped;
+    return !m_overlappedItems.isEmpty();
 }
 template <typename T>
 QList<T *> OverlapableSerialList<T>::findOverlappedItems(T *obj) const {
-    auto list = new QList<T *>;
-    for (const auto &item : m_list)
-        if (item->isOverlappedWith(obj))
-            list->append(item);
-    return *list;
-}
-template <typename T>
-QList<T *> OverlapableSerialList<T>::overlappedItems() const {
-    auto list = new QList<T *>;
-    for (const auto &item : m_list)
-        if (item->overlapped())
-            list->append(item);
-    return *list;
-}
-template <typename T>
-QList<T *> &OverlapableSerialList<T>::overlappedIOverlapables() {
-    auto list = new QList<T *>;
-    for (const auto &item : m_list)
-        if (item->overlapped())
-            list->append(item);
-    return *list;
+    QList<T *> list;
+    forEachCandidate(obj->overlapStart(), obj->overlapEnd(), [&](T *t) {
+        if (t->isOverlappedWith(obj))
+            list.append(t);
+    });
+    return list;
+}
+template <typename T>
+const QSet<T *> &OverlapableSerialList<T>::overlappedItems() const {
+    return m_overlappedItems;
+}
+template <typename T>
+template <typename Fn>
+void OverlapableSerialList<T>::forEachInRange(int startTick, int endTick, Fn fn) const {
+    if (endTick <= startTick)
+        return;
+    forEachCandidate(startTick, endTick, [&](T *t) {
+        if (t->overlapEnd() > startTick)
+            fn(t);
+    });
+}
+template <typename T>
+typename OverlapableSerialList<T>::Range OverlapableSerialList<T>::itemsInRange(int startTick,
+                                                                                int endTick) const {
+    if (endTick <= startTick)
+        return Range(this, cend(), cend(), startTick);
+    return Range(this, cbegin(), upperBound(endTick - 1), startTick);
+}
+template <typename T>
+int OverlapableSerialList<T>::bucketOf(int start, bool afterEqual) const {
+    // Last bucket whose first item starts before (or at, when afterEqual) the given tick
+    int low = 0;
+    int high = m_buckets.size() - 1;
+    while (low < high) {
+        auto mid = (low + high + 1) / 2;
+        auto first = m_buckets.at(mid).first()->overlapStart();
+        if (first < start || (afterEqual && first == start))
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
+}
+template <typename T>
+typename OverlapableSerialList<T>::const_iterator
+    OverlapableSerialList<T>::upperBound(int tick) const {
+    if (m_buckets.isEmpty())
+        return cend();
+    auto b = bucketOf(tick, true);
+    const auto &bucket = m_buckets.at(b);
+    auto pos = std::upper_bound(bucket.cbegin(), bucket.cend(), tick,
+                                [](int t, const T *item) { return t < item->overlapStart(); });
+    auto offset = static_cast<int>(pos - bucket.cbegin());
+    if (offset == bucket.size())
+        return const_iterator(&m_buckets, b + 1, 0);
+    return const_iterator(&m_buckets, b, offset);
+}
+template <typename T>
+typename OverlapableSerialList<T>::const_iterator
+    OverlapableSerialList<T>::find(const T *item) const {
+    if (m_buckets.isEmpty())
+        return cend();
+    // Items sharing the same start are adjacent, so only that run has to be compared
+    auto start = item->overlapStart();
+    auto it = upperBound(start - 1);
+    for (; it != cend() && (*it)->overlapStart() == start; ++it)
+        if (*it == item)
+            return it;
+    // The key may have been changed in place (e.g. a clip shifted while in the list)
+    for (it = cbegin(); it != cend(); ++it)
+        if (*it == item)
+            return it;
+    return cend();
+}
+template <typename T>
+typename OverlapableSerialList<T>::const_iterator
+    OverlapableSerialList<T>::firstEndingAfter(const_iterator it, const_iterator end,
+                                               int tick) const {
+    while (it != end) {
+        auto bucket = it.m_bucket;
+        if (m_extents.at(bucket).end <= tick) {
+            bucket = firstBucketEndingAfter(bucket + 1, tick);
+            if (bucket > end.m_bucket || (bucket == end.m_bucket && end.m_offset == 0))
+                return end;
+            it = const_iterator(&m_buckets, bucket, 0);
+        }
+        const auto &items = m_buckets.at(bucket);
+        if (it.m_offset == 0) {
+            // Nothing that starts at or before tick - the longest length can reach tick
+            auto pos = std::upper_bound(
+                items.cbegin(), items.cend(), tick - m_extents.at(bucket).length,
+                [](int t, const T *item) { return t < item->overlapStart(); });
+            it.m_offset = static_cast<int>(pos - items.cbegin());
+            if (bucket == end.m_bucket && it.m_offset >= end.m_offset)
+                return end;
+            if (it.m_offset == items.size()) {
+                it = const_iterator(&m_buckets, bucket + 1, 0);
+                continue;
+            }
+        }
+        for (; it != end && it.m_bucket == bucket; ++it)
+            if ((*it)->overlapEnd() > tick)
+                return it;
+    }
+    return it;
+}
+template <typename T>
+template <typename Fn>
+void OverlapableSerialList<T>::forEachCandidate(int start, int end, Fn fn) const {
+    auto last = upperBound(end - 1);
+    for (auto it = firstEndingAfter(cbegin(), last, start); it != last;
+         it = firstEndingAfter(++it, last, start))
+        fn(*it);
+}
+template <typename T>
+bool OverlapableSerialList<T>::hasOverlapWith(T *item) const {
+    // Stops at the first overlap, as a long item overlaps many
+    auto start = item->overlapStart();
+    auto last = upperBound(item->overlapEnd() - 1);
+    for (auto it = firstEndingAfter(cbegin(), last, start); it != last;
+         it = firstEndingAfter(++it, last, start))
+        if (*it != item && (*it)->isOverlappedWith(item))
+            return true;
+    return false;
+}
+template <typename T>
+void OverlapableSerialList<T>::setOverlapped(T *item, bool overlapped) {
+    item->setOverlapped(overlapped);
+    if (overlapped)
+        m_overlappedItems.insert(item);
+    else
+        m_overlappedItems.remove(item);
+}
+template <typename T>
+void OverlapableSerialList<T>::rebuild(const Bucket &sorted) {
+    clear();
+    const auto bucketSize = MaxBucketSize / 2;
+    for (int i = 0; i < sorted.size(); i += bucketSize) {
+        m_buckets.append(sorted.mid(i, bucketSize));
+        m_extents.append(extentOf(m_buckets.last()));
+    }
+    rebuildIndex();
+    m_count = sorted.size();
+
+    for (const auto item : sorted)
+        item->setOverlapped(false);
+
+    // Sorted by start, so each item can only overlap the items after it that start before
+    // its end
+    for (int i = 0; i < sorted.size(); i++) {
+        auto item = sorted.at(i);
+        auto end = item->overlapEnd();
+        for (int j = i + 1; j < sorted.size() && sorted.at(j)->overlapStart() < end; j++)
+            if (sorted.at(j)->isOverlappedWith(item)) {
+                setOverlapped(item, true);
+                setOverlapped(sorted.at(j), true);
+            }
+    }
+}
+template <typename T>
+typename OverlapableSerialList<T>::Extent
+    OverlapableSerialList<T>::extentOf(const Bucket &bucket) {
+    Extent extent;
+    for (const auto item : bucket) {
+        extent.end = qMax(extent.end, item->overlapEnd());
+        extent.length = qMax(extent.length, item->overlapEnd() - item->overlapStart());
+    }
+    return extent;
+}
+template <typename T>
+void OverlapableSerialList<T>::eraseAt(int bucket, int offset) {
+    m_buckets[bucket].remove(offset);
+    m_count--;
+    auto size = m_buckets.at(bucket).size();
+    if (size == 0) {
+        m_buckets.remove(bucket);
+        m_extents.remove(bucket);
+        rebuildIndex();
+    } else if (size < MinBucketSize && bucket + 1 < m_buckets.size() &&
+               size + m_buckets.at(bucket + 1).size() <= MaxBucketSize / 2) {
+        m_buckets[bucket] += m_buckets.at(bucket + 1);
+        m_buckets.remove(bucket + 1);
+        m_extents.remove(bucket + 1);
+        m_extents[bucket] = extentOf(m_buckets.at(bucket));
+        rebuildIndex();
+    } else {
+        adjustIndex(bucket, -1);
+        // Recomputed, as the erased item may have been the longest or changed in place
+        setExtent(bucket, extentOf(m_buckets.at(bucket)));
+    }
+}
+template <typename T>
+void OverlapableSerialList<T>::rebuildIndex() {
+    auto n = m_buckets.size();
+    m_tree.fill(0, n + 1);
+    for (int i = 1; i <= n; i++) {
+        m_tree[i] += m_buckets.at(i - 1).size();
+        auto parent = i + (i & -i);
+        if (parent <= n)
+            m_tree[parent] += m_tree.at(i);
+    }
+
+    m_endLeaves = 1;
+    while (m_endLeaves < n)
+        m_endLeaves *= 2;
+    m_endTree.fill(INT_MIN, 2 * m_endLeaves);
+    for (int i = 0; i < n; i++)
+        m_endTree[m_endLeaves + i] = m_extents.at(i).end;
+    for (int i = m_endLeaves - 1; i > 0; i--)
+        m_endTree[i] = qMax(m_endTree.at(2 * i), m_endTree.at(2 * i + 1));
+}
+template <typename T>
+void OverlapableSerialList<T>::adjustIndex(int bucket, int delta) {
+    for (int i = bucket + 1; i <= m_buckets.size(); i += i & -i)
+        m_tree[i] += delta;
+}
+template <typename T>
+int OverlapableSerialList<T>::countBefore(int bucket) const {
+    int sum = 0;
+    for (int i = bucket; i > 0; i -= i & -i)
+        sum += m_tree.at(i);
+    return sum;
+}
+template <typename T>
+void OverlapableSerialList<T>::setExtent(int bucket, const Extent &extent) {
+    m_extents[bucket] = extent;
+    auto i = m_endLeaves + bucket;
+    m_endTree[i] = extent.end;
+    for (i /= 2; i > 0; i /= 2)
+        m_endTree[i] = qMax(m_endTree.at(2 * i), m_endTree.at(2 * i + 1));
+}
+template <typename T>
+int OverlapableSerialList<T>::firstBucketEndingAfter(int bucket, int tick) const {
+    if (bucket >= m_buckets.size())
+        return m_buckets.size();
+    auto i = m_endLeaves + bucket;
+    while (m_endTree.at(i) <= tick) {
+        // Climb while i is a right child, then go on with the subtree right of it
+        while (i & 1)
+            i /= 2;
+        if (i == 0)
+            return m_buckets.size();
+        i++;
+    }
+    while (i < m_endLeaves) {
+        i *= 2;
+        if (m_endTree.at(i) <= tick)
+            i++;
+    }
+    return i - m_endLeaves;
 }
 
 #endif // SERIALLIST_H
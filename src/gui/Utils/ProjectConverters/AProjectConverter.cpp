@@ -28,11 +28,11 @@ bool AProjectConverter::load(const QString &path, AppModel *model, QString &errM
         return true;
     };
 
-    auto decodeNotes = [](const QJsonArray &arrNotes) {
+    auto decodeNotes = [](const QJsonArray &arrNotes, DsSingingClip *clip) {
         QList<DsNote *> notes;
         for (const auto valNote : qAsConst(arrNotes)) {
             auto objNote = valNote.toObject();
-            auto note = new DsNote;
+            auto note = clip->createNote();
             note->setStart(objNote.value("pos").toInt());
             note->setLength(objNote.value("dur").toInt());
             note->setKeyIndex(objNote.value("pitch").toInt());
@@ -55,7 +55,7 @@ bool AProjectConverter::load(const QString &path, AppModel *model, QString &errM
                 singingClip->setLength(objClip.value("dur").toInt());
                 singingClip->setClipLen(objClip.value("clipDur").toInt());
                 auto arrNotes = objClip.value("notes").toArray();
-                auto notes = decodeNotes(arrNotes);
+                auto notes = decodeNotes(arrNotes, singingClip);
                 for (auto &note : notes)
                     singingClip->insertNote(note);
                 dsTack->insertClip(singingClip);
@@ -8,158 +8,55 @@
 #include "opendspx/qdspxtimeline.h"
 #include "opendspx/qdspxmodel.h"
 
+#include <QFile>
 #include <QMessageBox>
 
-bool DspxProjectConverter::load(const QString &path, AppModel *model, QString &errMsg,
-                             ImportMode mode) {
-    auto decodeCurves = [&](const QList<QDspx::ParamCurveRef> &dspxCurveRefs) {
-        QVector<DsCurve*> curves;
-        for (const QDspx::ParamCurveRef &dspxCurveRef : dspxCurveRefs) {
-            if (dspxCurveRef->type == QDspx::ParamCurve::Type::Free) {
-                auto castCurveRef = dspxCurveRef.dynamicCast<QDspx::ParamFree>();
-                auto curve = new DsDrawCurve;
-                curve->setStart(castCurveRef->start);
-                curve->step = castCurveRef->step;
-                curve->setValues(castCurveRef->values);
-                curves.append(curve);
-            } else if (dspxCurveRef->type == QDspx::ParamCurve::Type::Anchor) {
-                auto castCurveRef = dspxCurveRef.dynamicCast<QDspx::ParamAnchor>();
-                auto curve = new DsAnchorCurve;
-                curve->setStart(castCurveRef->start);
-                for (const auto &dspxNode : castCurveRef->nodes) {
-                    auto node = new DsAnchorNode(dspxNode.x, dspxNode.y);
-                    node->setInterpMode(DsAnchorNode::None);
-                    if (dspxNode.interp == QDspx::AnchorPoint::Interpolation::Linear) {
-                        node->setInterpMode(DsAnchorNode::Linear);
-                    } else if (dspxNode.interp == QDspx::AnchorPoint::Interpolation::Hermite) {
-                        node->setInterpMode(DsAnchorNode::Hermite);
-                    } /*else if (dspxNode.interp == QDspx::AnchorPoint::Interpolation::Cubic) {
-                        node->setInterpMode(DsAnchorNode::Cubic);
-                    }*/
-                    curve->insertNode(node);
-                }
-                curves.append(curve);
-            }
-        }
-        return curves;
-    };
-
-    auto decodeSingingParam = [&](const QDspx::ParamInfo &dspxParam) {
-        DsParam param;
-        for (auto &curve : decodeCurves(dspxParam.org)) {
-            param.original.add(curve);
-        }
-        for (auto &curve : decodeCurves(dspxParam.edited)) {
-            param.edited.add(curve);
-        }
-        for (auto &curve: decodeCurves(dspxParam.envelope)) {
-            param.envelope.add(curve);
-        }
-        return param;
-    };
-
-    auto decodeSingingParams = [&](const QDspx::SingleParam &dspxParams) {
-        DsParams params;
-        params.pitch = decodeSingingParam(dspxParams.pitch);
-        params.energy = decodeSingingParam(dspxParams.energy);
-        params.tension = decodeSingingParam(dspxParams.tension);
-        params.breathiness = decodeSingingParam(dspxParams.breathiness);
-        return params;
-    };
+static const QString WorkspaceKey = DspxStreamReader::WorkspaceKey;
+static const QString PersistentIdKey = DspxStreamReader::PersistentIdKey;
 
-    auto decodePhonemes = [&](const QList<QDspx::Phoneme> &dspxPhonemes) {
-        QList<DsPhoneme> phonemes;
-        for (const QDspx::Phoneme &dspxPhoneme : dspxPhonemes) {
-            DsPhoneme phoneme(DsPhoneme::DsPhonemeType::Normal, dspxPhoneme.token, dspxPhoneme.start);
-            if (dspxPhoneme.type == QDspx::Phoneme::Type::Ahead) {
-                phoneme.type = DsPhoneme::DsPhonemeType::Ahead;
-            } else if (dspxPhoneme.type == QDspx::Phoneme::Type::Final) {
-                phoneme.type = DsPhoneme::DsPhonemeType::Final;
-            }
-            phonemes.append(phoneme);
-        }
-        return phonemes;
-    };
-    auto decodeNotes = [&](const QList<QDspx::Note> &dspxNotes) {
-        QList<DsNote *> notes;
-        for (const QDspx::Note &dspxNote : dspxNotes) {
-            auto note = new DsNote;
-            note->setStart(dspxNote.pos);
-            note->setLength(dspxNote.length);
-            note->setKeyIndex(dspxNote.keyNum);
-            note->setLyric(dspxNote.lyric);
-            note->setPronunciation(dspxNote.pronunciation);
-            note->setPhonemes(DsPhonemes::Original, decodePhonemes(dspxNote.phonemes.org));
-            note->setPhonemes(DsPhonemes::Edited, decodePhonemes(dspxNote.phonemes.edited));
-            notes.append(note);
-        }
-        return notes;
-    };
-    auto decodeClips = [&](const QList<QDspx::ClipRef> &dspxClips, DsTrack *track) {
-        for (const auto &dspxClip : dspxClips) {
-            if (dspxClip->type == QDspx::Clip::Type::Singing) {
-                auto castClip = dspxClip.dynamicCast<QDspx::SingingClip>();
-                auto clip = new DsSingingClip;
-                clip->setName(castClip->name);
-                clip->setStart(castClip->time.start);
-                clip->setClipStart(castClip->time.clipStart);
-                clip->setLength(castClip->time.length);
-                clip->setClipLen(castClip->time.clipLen);
-                clip->setGain(castClip->control.gain);
-                clip->setMute(castClip->control.mute);
-                auto notes = decodeNotes(castClip->notes);
-                for (auto &note : notes)
-                    clip->insertNoteQuietly(note);
-                clip->params = decodeSingingParams(castClip->params);
-                track->insertClipQuietly(clip);
-            } else if (dspxClip->type == QDspx::Clip::Type::Audio) {
-                auto castClip = dspxClip.dynamicCast<QDspx::AudioClip>();
-                auto clip = new DsAudioClip;
-                clip->setName(castClip->name);
-                clip->setStart(castClip->time.start);
-                clip->setClipStart(castClip->time.clipStart);
-                clip->setLength(castClip->time.length);
-                clip->setClipLen(castClip->time.clipLen);
-                clip->setGain(castClip->control.gain);
-                clip->setMute(castClip->control.mute);
-                clip->setPath(castClip->path);
-                track->insertClipQuietly(clip);
-            }
-        }
-    };
-
-    auto decodeTracks = [&](const QList<QDspx::Track> &dspxTracks, AppModel *model) {
-        int i = 0;
-        for (const auto &dspxTrack : dspxTracks) {
-            auto track = new DsTrack;
-            auto trackControl = DsTrackControl();
-            trackControl.setGain(dspxTrack.control.gain);
-            trackControl.setPan(dspxTrack.control.pan);
-            trackControl.setMute(dspxTrack.control.mute);
-            trackControl.setSolo(dspxTrack.control.solo);
-            track->setName(dspxTrack.name);
-            track->setControl(trackControl);
-            decodeClips(dspxTrack.clips, track);
-            model->insertTrackQuietly(track, i);
-            i++;
-        }
-    };
+template <typename Workspace>
+static void writePersistentId(Workspace &workspace, UniqueObject *object) {
+    auto data = workspace.value(WorkspaceKey);
+    // Stored as a JSON number, exact up to 2^53
+    data.insert(PersistentIdKey, static_cast<double>(object->ensurePersistentId()));
+    workspace.insert(WorkspaceKey, data);
+}
 
-    QDspxModel dspxModel;
-    auto returnCode = dspxModel.load(path);
-    if (returnCode.type == QDspx::ReturnCode::Success) {
-        auto timeline = dspxModel.content.timeline;
-        model->setTimeSignature(AppModel::TimeSignature(timeline.timeSignatures[0].num, timeline.timeSignatures[0].den));
-        model->setTempo(timeline.tempos[0].value);
-        decodeTracks(dspxModel.content.tracks, model);
-        return true;
-    } else {
-        errMsg = QString("Failed to load project file.\r\npath: %1\r\ntype: %2 code: %3")
+bool DspxProjectConverter::load(const QString &path, AppModel *model, QString &errMsg,
+                             ImportMode mode) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errMsg = QString("Failed to open project file.\r\npath: %1\r\n%2")
+                     .arg(path)
+                     .arg(file.errorString());
+        return false;
+    }
+    DspxStreamReader reader(&file);
+    reader.setProgressCallback(m_progressCallback);
+    reader.setCancelFlag(&m_cancelled);
+    // Objects appended to another project get new ids, which can not clash with its own
+    reader.setRestorePersistentIds(mode == ImportMode::NewProject);
+    if (!reader.read()) {
+        errMsg = QString("Failed to load project file.\r\npath: %1\r\n%2")
                      .arg(path)
-                     .arg(returnCode.type)
-                     .arg(returnCode.code);
+                     .arg(reader.errorString());
         return false;
     }
+    model->setTimeSignature(AppModel::TimeSignature(reader.numerator(), reader.denominator()));
+    model->setTempo(reader.tempo());
+    int i = 0;
+    for (const auto track : reader.takeTracks()) {
+        model->insertTrackQuietly(track, i);
+        i++;
+    }
+    return true;
+}
+void DspxProjectConverter::setProgressCallback(
+    const DspxStreamReader::ProgressCallback &callback) {
+    m_progressCallback = callback;
+}
+void DspxProjectConverter::cancel() {
+    m_cancelled = true;
 }
 
 bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &errMsg) {
@@ -216,7 +113,7 @@ bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &e
         for (const auto &dsPhoneme : dsPhonemes) {
             QDspx::Phoneme phoneme;
             phoneme.start = dsPhoneme.start;
-            phoneme.token = dsPhoneme.name;
+            phoneme.token = dsPhoneme.name.toString();
             if (dsPhoneme.type == DsPhoneme::DsPhonemeType::Ahead) {
                 phoneme.type = QDspx::Phoneme::Type::Ahead;
             } else if (dsPhoneme.type == DsPhoneme::DsPhonemeType::Final) {
@@ -236,6 +133,7 @@ bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &e
             note.keyNum = dsNote->keyIndex();
             note.lyric = dsNote->lyric();
             note.pronunciation = dsNote->pronunciation();
+            writePersistentId(note.workspace, dsNote);
             encodePhonemes(dsNote->phonemes().original, note.phonemes.org);
             encodePhonemes(dsNote->phonemes().original, note.phonemes.edited);
             notes.append(note);
@@ -254,6 +152,7 @@ bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &e
                 singClip->time.clipLen = clip->clipLen();
                 singClip->control.gain = clip->gain();
                 singClip->control.mute = clip->mute();
+                writePersistentId(singClip->workspace, clip);
                 encodeNotes(singingClip->notes(), singClip->notes);
                 encodeSingingParams(singingClip->params, singClip->params);
                 track.clips.append(singClip);
@@ -268,6 +167,7 @@ bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &e
                 audioClipRef->control.gain = clip->gain();
                 audioClipRef->control.mute = clip->mute();
                 audioClipRef->path = audioClip->path();
+                writePersistentId(audioClipRef->workspace, clip);
                 track.clips.append(audioClipRef);
             }
         }
@@ -281,6 +181,7 @@ bool DspxProjectConverter::save(const QString &path, AppModel *model, QString &e
             track.control.pan = dsTrack->control().pan();
             track.control.mute = dsTrack->control().mute();
             track.control.solo = dsTrack->control().solo();
+            writePersistentId(track.workspace, dsTrack);
             encodeClips(dsTrack, track);
             dspx.content.tracks.append(track);
         }
@@ -5,6 +5,7 @@
 #ifndef DSPXPROJECTCONVERTER_H
 #define DSPXPROJECTCONVERTER_H
 
+#include "DspxStreamReader.h"
 #include "IProjectConverter.h"
 
 using ImportMode = IProjectConverter::ImportMode;
@@ -13,6 +14,15 @@ public:
     bool load(const QString &path, AppModel *track, QString &errMsg,
               ImportMode mode = ImportMode::NewProject) override;
     bool save(const QString &dsParam, AppModel *phonemes, QString &errMsg) override;
+
+    // Reports how much of the file load() has read
+    void setProgressCallback(const DspxStreamReader::ProgressCallback &callback);
+    // Makes a running load() fail. May be called from another thread.
+    void cancel();
+
+private:
+    DspxStreamReader::ProgressCallback m_progressCallback;
+    std::atomic<bool> m_cancelled{false};
 };
 
 #endif // DSPXPROJECTCONVERTER_H
@@ -0,0 +1,226 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "DspxSnapshotEncoder.h"
+
+#include <QLocale>
+
+#include "DspxStreamReader.h"
+
+bool DspxSnapshotEncoder::write(const AppModelSnapshot &snapshot, QIODevice &device) {
+    m_encodedTrackCount = 0;
+    m_encodedClipCount = 0;
+    // Only the fragments of this snapshot are kept for the next one
+    QHash<int, Fragment<TrackSnapshot>> tracks;
+    QHash<int, Fragment<ClipSnapshot>> clips;
+
+    QByteArray json = R"({"version":"1.0.0","content":{"timeline":{"timeSignatures":)"
+                      R"([{"pos":0,"numerator":)";
+    json += QByteArray::number(snapshot.numerator) + R"(,"denominator":)" +
+            QByteArray::number(snapshot.denominator) + R"(}],"tempos":[{"pos":0,"value":)";
+    encodeNumber(snapshot.tempo, json);
+    json += R"(}]},"tracks":[)";
+    auto ok = device.write(json) == json.size();
+    for (int i = 0; i < snapshot.tracks.count() && ok; i++) {
+        const auto &track = snapshot.tracks.at(i);
+        auto it = m_tracks.constFind(track->id);
+        if (it != m_tracks.cend() && it.value().snapshot == track) {
+            for (const auto &clip : track->clips)
+                clips.insert(clip->id, m_clips.value(clip->id));
+            tracks.insert(track->id, it.value());
+        } else {
+            tracks.insert(track->id, {track, encodeTrack(*track, clips)});
+        }
+        if (i > 0)
+            ok = device.write(",", 1) == 1;
+        const auto &trackJson = tracks.value(track->id).json;
+        ok = ok && device.write(trackJson) == trackJson.size();
+    }
+    ok = ok && device.write("]}}", 3) == 3;
+
+    m_tracks.swap(tracks);
+    m_clips.swap(clips);
+    return ok;
+}
+int DspxSnapshotEncoder::encodedTrackCount() const {
+    return m_encodedTrackCount;
+}
+int DspxSnapshotEncoder::encodedClipCount() const {
+    return m_encodedClipCount;
+}
+QByteArray DspxSnapshotEncoder::encodeTrack(const TrackSnapshot &track,
+                                            QHash<int, Fragment<ClipSnapshot>> &clips) {
+    m_encodedTrackCount++;
+    QByteArray json = R"({"name":)";
+    encodeString(track.name, json);
+    json += R"(,"control":{"gain":)";
+    encodeNumber(track.control.gain(), json);
+    json += R"(,"pan":)";
+    encodeNumber(track.control.pan(), json);
+    json += R"(,"mute":)";
+    json += track.control.mute() ? "true" : "false";
+    json += R"(,"solo":)";
+    json += track.control.solo() ? "true" : "false";
+    json += R"(},"clips":[)";
+    auto first = true;
+    for (const auto &clip : track.clips) {
+        if (clip->type != DsClip::Singing && clip->type != DsClip::Audio)
+            continue;
+        auto it = m_clips.constFind(clip->id);
+        auto reused = it != m_clips.cend() && it.value().snapshot == clip;
+        auto clipJson = reused ? it.value().json : encodeClip(*clip);
+        clips.insert(clip->id, {clip, clipJson});
+        if (!first)
+            json += ',';
+        json += clipJson;
+        first = false;
+    }
+    json += ']';
+    encodeWorkspace(track.persistentId, json);
+    json += '}';
+    return json;
+}
+QByteArray DspxSnapshotEncoder::encodeClip(const ClipSnapshot &clip) {
+    m_encodedClipCount++;
+    QByteArray json = clip.type == DsClip::Singing ? R"({"type":"singing","name":)"
+                                                   : R"({"type":"audio","name":)";
+    encodeString(clip.name, json);
+    json += R"(,"time":{"start":)" + QByteArray::number(clip.start) + R"(,"length":)" +
+            QByteArray::number(clip.length) + R"(,"clipStart":)" +
+            QByteArray::number(clip.clipStart) + R"(,"clipLen":)" +
+            QByteArray::number(clip.clipLen) + R"(},"control":{"gain":)";
+    encodeNumber(clip.gain, json);
+    json += R"(,"mute":)";
+    json += clip.mute ? "true}" : "false}";
+    if (clip.type == DsClip::Audio) {
+        json += R"(,"path":)";
+        encodeString(clip.path, json);
+    } else {
+        json += R"(,"notes":[)";
+        encodeNotes(clip.notes, json);
+        json += ']';
+        if (clip.params) {
+            json += R"(,"params":)";
+            encodeParams(*clip.params, json);
+        }
+    }
+    encodeWorkspace(clip.persistentId, json);
+    json += '}';
+    return json;
+}
+void DspxSnapshotEncoder::encodeNotes(const QVector<NoteSnapshot> &notes, QByteArray &json) {
+    for (int i = 0; i < notes.count(); i++) {
+        const auto &note = notes.at(i);
+        json += i > 0 ? R"(,{"pos":)" : R"({"pos":)";
+        json += QByteArray::number(note.start) + R"(,"length":)" +
+                QByteArray::number(note.length) + R"(,"keyNum":)" +
+                QByteArray::number(note.keyIndex) + R"(,"lyric":)";
+        encodeString(note.lyric.toString(), json);
+        json += R"(,"pronunciation":)";
+        encodeString(note.pronunciation.toString(), json);
+        // The edited phonemes are saved as the original ones, as by the converter
+        json += R"(,"phonemes":{"original":)";
+        encodePhonemes(note.phonemes.original, json);
+        json += R"(,"edited":)";
+        encodePhonemes(note.phonemes.original, json);
+        json += '}';
+        encodeWorkspace(note.persistentId, json);
+        json += '}';
+    }
+}
+void DspxSnapshotEncoder::encodePhonemes(const QList<DsPhoneme> &phonemes, QByteArray &json) {
+    json += '[';
+    for (int i = 0; i < phonemes.count(); i++) {
+        const auto &phoneme = phonemes.at(i);
+        if (i > 0)
+            json += ',';
+        json += phoneme.type == DsPhoneme::Ahead   ? R"({"type":"ahead","token":)"
+                : phoneme.type == DsPhoneme::Final ? R"({"type":"final","token":)"
+                                                   : R"({"type":"normal","token":)";
+        encodeString(phoneme.name.toString(), json);
+        json += R"(,"start":)" + QByteArray::number(phoneme.start) + '}';
+    }
+    json += ']';
+}
+void DspxSnapshotEncoder::encodeParams(const ParamsSnapshot &params, QByteArray &json) {
+    const QPair<const char *, const ParamSnapshot *> named[] = {
+        {R"({"pitch":)", &params.pitch},
+        {R"(,"energy":)", &params.energy},
+        {R"(,"tension":)", &params.tension},
+        {R"(,"breathiness":)", &params.breathiness},
+    };
+    for (const auto &[key, param] : named) {
+        json += key;
+        json += R"({"original":)";
+        encodeCurves(param->original, json);
+        json += R"(,"edited":)";
+        encodeCurves(param->edited, json);
+        json += R"(,"envelope":)";
+        encodeCurves(param->envelope, json);
+        json += '}';
+    }
+    json += '}';
+}
+void DspxSnapshotEncoder::encodeCurves(const QVector<CurveSnapshot> &curves, QByteArray &json) {
+    json += '[';
+    auto first = true;
+    for (const auto &curve : curves) {
+        if (curve.type != DsCurve::Draw && curve.type != DsCurve::Anchor)
+            continue;
+        if (!first)
+            json += ',';
+        first = false;
+        if (curve.type == DsCurve::Draw) {
+            json += R"({"type":"free","start":)" + QByteArray::number(curve.start) +
+                    R"(,"step":)" + QByteArray::number(curve.step) + R"(,"values":[)";
+            for (int i = 0; i < curve.values.count(); i++) {
+                if (i > 0)
+                    json += ',';
+                json += QByteArray::number(curve.values.at(i));
+            }
+        } else {
+            json += R"({"type":"anchor","start":)" + QByteArray::number(curve.start) +
+                    R"(,"nodes":[)";
+            for (int i = 0; i < curve.nodes.count(); i++) {
+                const auto &node = curve.nodes.at(i);
+                json += i > 0 ? R"(,{"x":)" : R"({"x":)";
+                json += QByteArray::number(node.pos) + R"(,"y":)" + QByteArray::number(node.value);
+                json += node.interpMode == DsAnchorNode::Linear    ? R"(,"interp":"linear"})"
+                        : node.interpMode == DsAnchorNode::Hermite ? R"(,"interp":"hermite"})"
+                                                                   : R"(,"interp":"none"})";
+            }
+        }
+        json += "]}";
+    }
+    json += ']';
+}
+void DspxSnapshotEncoder::encodeWorkspace(quint64 persistentId, QByteArray &json) {
+    if (persistentId == 0)
+        return;
+    json += R"(,"workspace":{")";
+    json += DspxStreamReader::WorkspaceKey;
+    json += R"(":{")";
+    json += DspxStreamReader::PersistentIdKey;
+    json += R"(":)" + QByteArray::number(persistentId) + "}}";
+}
+void DspxSnapshotEncoder::encodeString(const QString &string, QByteArray &json) {
+    static const char hex[] = "0123456789abcdef";
+    json += '"';
+    for (const auto c : string.toUtf8()) {
+        if (c == '"' || c == '\\') {
+            json += '\\';
+            json += c;
+        } else if (static_cast<uchar>(c) < 0x20) {
+            json += "\\u00";
+            json += hex[c >> 4];
+            json += hex[c & 0xF];
+        } else {
+            json += c;
+        }
+    }
+    json += '"';
+}
+void DspxSnapshotEncoder::encodeNumber(double value, QByteArray &json) {
+    json += QByteArray::number(value, 'g', QLocale::FloatingPointShortest);
+}
@@ -0,0 +1,57 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef DSPXSNAPSHOTENCODER_H
+#define DSPXSNAPSHOTENCODER_H
+
+#include <QHash>
+#include <QIODevice>
+
+#include "Model/AppModelSnapshot.h"
+
+// Writes snapshots of a project as dspx documents, on any thread.
+//
+// The JSON of every track and clip written is kept. Snapshots share the subtrees of tracks
+// and clips that did not change, so a track or clip whose snapshot is the one written last
+// time is copied from there, and after an edit only the tracks and clips it touched are
+// encoded again. The kept JSON takes about as much memory as the document.
+//
+// The document holds what DspxProjectConverter::save() writes, except that persistent ids
+// not assigned yet are left out.
+class DspxSnapshotEncoder {
+public:
+    bool write(const AppModelSnapshot &snapshot, QIODevice &device);
+
+    // Tracks and clips the last write() encoded rather than copied
+    int encodedTrackCount() const;
+    int encodedClipCount() const;
+
+private:
+    template <typename T>
+    class Fragment {
+    public:
+        std::shared_ptr<const T> snapshot;
+        QByteArray json;
+    };
+
+    // Adds the fragments of the clips of track to clips
+    QByteArray encodeTrack(const TrackSnapshot &track, QHash<int, Fragment<ClipSnapshot>> &clips);
+    QByteArray encodeClip(const ClipSnapshot &clip);
+    static void encodeNotes(const QVector<NoteSnapshot> &notes, QByteArray &json);
+    static void encodePhonemes(const QList<DsPhoneme> &phonemes, QByteArray &json);
+    static void encodeParams(const ParamsSnapshot &params, QByteArray &json);
+    static void encodeCurves(const QVector<CurveSnapshot> &curves, QByteArray &json);
+    static void encodeWorkspace(quint64 persistentId, QByteArray &json);
+    static void encodeString(const QString &string, QByteArray &json);
+    static void encodeNumber(double value, QByteArray &json);
+
+    QHash<int, Fragment<TrackSnapshot>> m_tracks; // by track id
+    QHash<int, Fragment<ClipSnapshot>> m_clips;   // by clip id
+    int m_encodedTrackCount = 0;
+    int m_encodedClipCount = 0;
+};
+
+
+
+#endif // DSPXSNAPSHOTENCODER_H
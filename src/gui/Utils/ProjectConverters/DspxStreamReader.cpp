@@ -0,0 +1,573 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "DspxStreamReader.h"
+
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include "Utils/ChunkedIntArray.h"
+
+DspxStreamReader::DspxStreamReader(QIODevice *device) : DspxStreamReader(device, 0) {
+}
+DspxStreamReader::DspxStreamReader(QIODevice *device, qint64 offset)
+    : m_reader(device, offset), m_totalBytes(device->size()),
+      m_threadCount(QThread::idealThreadCount()) {
+    auto file = qobject_cast<QFile *>(device);
+    if (file)
+        m_fileName = file->fileName();
+}
+DspxStreamReader::~DspxStreamReader() {
+    for (const auto track : m_tracks) {
+        QList<DsClip *> clips;
+        for (const auto clip : track->clips())
+            clips.append(clip);
+        delete track;
+        qDeleteAll(clips);
+    }
+}
+void DspxStreamReader::setProgressCallback(const ProgressCallback &callback) {
+    m_progressCallback = callback;
+}
+void DspxStreamReader::setCancelFlag(const std::atomic<bool> *cancelled) {
+    m_cancelFlag = cancelled;
+}
+void DspxStreamReader::setRestorePersistentIds(bool restore) {
+    m_restorePersistentIds = restore;
+}
+void DspxStreamReader::setClipCallback(const ClipCallback &callback) {
+    m_clipCallback = callback;
+}
+void DspxStreamReader::setOutlineOnly(bool outlineOnly) {
+    m_outlineOnly = outlineOnly;
+}
+void DspxStreamReader::setThreadCount(int count) {
+    m_threadCount = qMax(count, 1);
+}
+bool DspxStreamReader::read() {
+    if (m_reader.readStartObject())
+        while (m_reader.readNextKey())
+            if (m_reader.key() == "content")
+                readContent();
+            else
+                m_reader.skipValue();
+    if (m_reader.hasError())
+        return false;
+    if (m_progressCallback)
+        m_progressCallback(m_reader.bytesRead(), m_totalBytes);
+    return true;
+}
+bool DspxStreamReader::isCancelled() const {
+    return m_cancelled;
+}
+QString DspxStreamReader::errorString() const {
+    return m_reader.errorString();
+}
+double DspxStreamReader::tempo() const {
+    return m_tempo;
+}
+int DspxStreamReader::numerator() const {
+    return m_numerator;
+}
+int DspxStreamReader::denominator() const {
+    return m_denominator;
+}
+QList<DsTrack *> DspxStreamReader::takeTracks() {
+    QList<DsTrack *> tracks;
+    tracks.swap(m_tracks);
+    return tracks;
+}
+
+void DspxStreamReader::readContent() {
+    if (!m_reader.readStartObject())
+        return;
+    while (m_reader.readNextKey()) {
+        if (m_reader.key() == "timeline") {
+            readTimeline();
+        } else if (m_reader.key() == "tracks") {
+            if (!m_reader.readStartArray())
+                continue;
+            if (m_threadCount > 1 && !m_outlineOnly && !m_fileName.isEmpty())
+                readTracksInParallel();
+            else
+                readTracks();
+        } else {
+            m_reader.skipValue();
+        }
+    }
+}
+void DspxStreamReader::readTracks() {
+    while (m_reader.readNextElement()) {
+        m_trackIndex = m_tracks.count();
+        m_tracks.append(readTrack());
+        if (!m_reader.hasError())
+            reportClips();
+        m_readClips.clear();
+    }
+}
+void DspxStreamReader::reportClips() {
+    if (m_clipCallback)
+        for (const auto clip : m_readClips)
+            m_clipCallback(m_trackIndex, clip);
+}
+void DspxStreamReader::readTracksInParallel() {
+    QList<qint64> offsets;
+    while (m_reader.readNextElement()) {
+        offsets.append(m_reader.valueOffset());
+        m_reader.skipValue();
+    }
+    if (m_reader.hasError() || offsets.isEmpty())
+        return;
+
+    auto trackCount = offsets.count();
+    QVector<DsTrack *> tracks(trackCount, nullptr);
+    QVector<QString> errors(trackCount);
+    auto targetThread = QThread::currentThread();
+    // Serializes the callbacks and guards the progress made
+    QMutex mutex;
+    auto bytesDecoded = offsets.first();
+    auto decodeTrack = [&](int index) {
+        QFile file(m_fileName);
+        if (!file.open(QIODevice::ReadOnly) || !file.seek(offsets.at(index))) {
+            errors[index] = file.errorString();
+            return;
+        }
+        DspxStreamReader reader(&file, offsets.at(index));
+        reader.m_cancelFlag = m_cancelFlag;
+        reader.m_restorePersistentIds = m_restorePersistentIds;
+        reader.m_trackIndex = index;
+        auto bytesReported = offsets.at(index);
+        if (m_progressCallback)
+            reader.m_progressCallback = [&](qint64 bytesRead, qint64) {
+                QMutexLocker locker(&mutex);
+                bytesDecoded += bytesRead - bytesReported;
+                bytesReported = bytesRead;
+                m_progressCallback(bytesDecoded, m_totalBytes);
+            };
+        reader.m_tracks.append(reader.readTrack());
+        if (reader.m_reader.hasError())
+            errors[index] = reader.errorString();
+        // Kept on errors as well, as clips of it may have been reported already. Objects can
+        // only be pushed to another thread by the thread they live in.
+        auto track = reader.takeTracks().first();
+        track->moveToThread(targetThread);
+        for (const auto clip : track->clips())
+            clip->moveToThread(targetThread);
+        tracks[index] = track;
+        if (errors.at(index).isEmpty() && m_clipCallback) {
+            QMutexLocker locker(&mutex);
+            for (const auto clip : reader.m_readClips)
+                m_clipCallback(index, clip);
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMin(m_threadCount, trackCount));
+    for (int i = 0; i < trackCount; i++)
+        pool.start([&decodeTrack, i] { decodeTrack(i); });
+    pool.waitForDone();
+
+    for (int i = 0; i < trackCount; i++) {
+        if (tracks.at(i))
+            m_tracks.append(tracks.at(i));
+        if ((!tracks.at(i) || !errors.at(i).isEmpty()) && !m_reader.hasError())
+            m_reader.setError(errors.at(i));
+    }
+    if (m_reader.hasError() && m_cancelFlag && m_cancelFlag->load())
+        m_cancelled = true;
+}
+void DspxStreamReader::readTimeline() {
+    // Only the first time signature and tempo are used
+    auto readFirst = [&](const std::function<void()> &readElement) {
+        if (!m_reader.readStartArray())
+            return;
+        for (int i = 0; m_reader.readNextElement(); i++)
+            if (i == 0)
+                readElement();
+            else
+                m_reader.skipValue();
+    };
+    if (!m_reader.readStartObject())
+        return;
+    while (m_reader.readNextKey()) {
+        if (m_reader.key() == "timeSignatures") {
+            readFirst([&] {
+                if (!m_reader.readStartObject())
+                    return;
+                while (m_reader.readNextKey())
+                    if (m_reader.key() == "numerator")
+                        m_numerator = m_reader.readInt();
+                    else if (m_reader.key() == "denominator")
+                        m_denominator = m_reader.readInt();
+                    else
+                        m_reader.skipValue();
+            });
+        } else if (m_reader.key() == "tempos") {
+            readFirst([&] {
+                if (!m_reader.readStartObject())
+                    return;
+                while (m_reader.readNextKey())
+                    if (m_reader.key() == "value")
+                        m_tempo = m_reader.readNumber();
+                    else
+                        m_reader.skipValue();
+            });
+        } else {
+            m_reader.skipValue();
+        }
+    }
+}
+DsTrack *DspxStreamReader::readTrack() {
+    auto track = new DsTrack;
+    if (!m_reader.readStartObject())
+        return track;
+    auto control = DsTrackControl();
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "name") {
+            track->setName(m_reader.readString());
+        } else if (key == "control") {
+            if (!m_reader.readStartObject())
+                continue;
+            while (m_reader.readNextKey())
+                if (m_reader.key() == "gain")
+                    control.setGain(m_reader.readNumber());
+                else if (m_reader.key() == "pan")
+                    control.setPan(m_reader.readNumber());
+                else if (m_reader.key() == "mute")
+                    control.setMute(m_reader.readBool());
+                else if (m_reader.key() == "solo")
+                    control.setSolo(m_reader.readBool());
+                else
+                    m_reader.skipValue();
+        } else if (key == "clips") {
+            if (m_reader.readStartArray())
+                while (m_reader.readNextElement())
+                    readClip(track);
+        } else if (key == "workspace") {
+            restoreId(track, readPersistentId());
+        } else {
+            m_reader.skipValue();
+        }
+    }
+    track->setControl(control);
+    return track;
+}
+void DspxStreamReader::readClip(DsTrack *track) {
+    if (!checkProgress() || !m_reader.readStartObject())
+        return;
+    QString type;
+    QString name;
+    QString path;
+    int start = 0;
+    int clipStart = 0;
+    int length = 0;
+    int clipLen = 0;
+    double gain = 0;
+    bool mute = false;
+    quint64 persistentId = 0;
+    DsSingingClip *singingClip = nullptr;
+    auto singing = [&] {
+        if (!singingClip)
+            singingClip = new DsSingingClip;
+        return singingClip;
+    };
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "type") {
+            type = m_reader.readString();
+        } else if (key == "name") {
+            name = m_reader.readString();
+        } else if (key == "path") {
+            path = m_reader.readString();
+        } else if (key == "time") {
+            if (!m_reader.readStartObject())
+                continue;
+            while (m_reader.readNextKey())
+                if (m_reader.key() == "start")
+                    start = m_reader.readInt();
+                else if (m_reader.key() == "clipStart")
+                    clipStart = m_reader.readInt();
+                else if (m_reader.key() == "length")
+                    length = m_reader.readInt();
+                else if (m_reader.key() == "clipLen")
+                    clipLen = m_reader.readInt();
+                else
+                    m_reader.skipValue();
+        } else if (key == "control") {
+            if (!m_reader.readStartObject())
+                continue;
+            while (m_reader.readNextKey())
+                if (m_reader.key() == "gain")
+                    gain = m_reader.readNumber();
+                else if (m_reader.key() == "mute")
+                    mute = m_reader.readBool();
+                else
+                    m_reader.skipValue();
+        } else if (m_outlineOnly && (key == "notes" || key == "params")) {
+            m_reader.skipValue();
+        } else if (key == "notes") {
+            auto clip = singing();
+            if (m_reader.readStartArray())
+                while (m_reader.readNextElement())
+                    readNote(clip);
+        } else if (key == "params") {
+            readParams(singing());
+        } else if (key == "workspace") {
+            persistentId = readPersistentId();
+        } else {
+            m_reader.skipValue();
+        }
+    }
+
+    DsClip *clip;
+    if (type == "singing") {
+        clip = singing();
+    } else if (type == "audio") {
+        delete singingClip;
+        auto audioClip = new DsAudioClip;
+        audioClip->setPath(path);
+        clip = audioClip;
+    } else {
+        delete singingClip;
+        return;
+    }
+    restoreId(clip, persistentId);
+    clip->setName(name);
+    clip->setStart(start);
+    clip->setClipStart(clipStart);
+    clip->setLength(length);
+    clip->setClipLen(clipLen);
+    clip->setGain(gain);
+    clip->setMute(mute);
+    track->insertClipQuietly(clip);
+    m_readClips.append(clip);
+}
+void DspxStreamReader::readNote(DsSingingClip *clip) {
+    if (!checkProgress() || !m_reader.readStartObject())
+        return;
+    auto note = clip->createNote();
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "pos") {
+            note->setStart(m_reader.readInt());
+        } else if (key == "length") {
+            note->setLength(m_reader.readInt());
+        } else if (key == "keyNum") {
+            note->setKeyIndex(m_reader.readInt());
+        } else if (key == "lyric") {
+            note->setLyric(m_reader.readString());
+        } else if (key == "pronunciation") {
+            note->setPronunciation(m_reader.readString());
+        } else if (key == "phonemes") {
+            if (!m_reader.readStartObject())
+                continue;
+            while (m_reader.readNextKey())
+                if (m_reader.key() == "original")
+                    note->setPhonemes(DsPhonemes::Original, readPhonemes());
+                else if (m_reader.key() == "edited")
+                    note->setPhonemes(DsPhonemes::Edited, readPhonemes());
+                else
+                    m_reader.skipValue();
+        } else if (key == "workspace") {
+            restoreId(note, readPersistentId());
+        } else {
+            m_reader.skipValue();
+        }
+    }
+    clip->insertNoteQuietly(note);
+}
+QList<DsPhoneme> DspxStreamReader::readPhonemes() {
+    QList<DsPhoneme> phonemes;
+    if (!m_reader.readStartArray())
+        return phonemes;
+    while (m_reader.readNextElement()) {
+        DsPhoneme phoneme(DsPhoneme::DsPhonemeType::Normal, Symbol(), 0);
+        if (!m_reader.readStartObject())
+            continue;
+        while (m_reader.readNextKey()) {
+            auto &key = m_reader.key();
+            if (key == "type") {
+                auto type = m_reader.readString();
+                if (type == "ahead")
+                    phoneme.type = DsPhoneme::DsPhonemeType::Ahead;
+                else if (type == "final")
+                    phoneme.type = DsPhoneme::DsPhonemeType::Final;
+            } else if (key == "token") {
+                phoneme.name = Symbol(m_reader.readString());
+            } else if (key == "start") {
+                phoneme.start = m_reader.readInt();
+            } else {
+                m_reader.skipValue();
+            }
+        }
+        phonemes.append(phoneme);
+    }
+    return phonemes;
+}
+void DspxStreamReader::readParams(DsSingingClip *clip) {
+    if (!m_reader.readStartObject())
+        return;
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "pitch")
+            readParam(clip->params.pitch, clip);
+        else if (key == "energy")
+            readParam(clip->params.energy, clip);
+        else if (key == "tension")
+            readParam(clip->params.tension, clip);
+        else if (key == "breathiness")
+            readParam(clip->params.breathiness, clip);
+        else
+            m_reader.skipValue();
+    }
+}
+void DspxStreamReader::readParam(DsParam &param, DsSingingClip *clip) {
+    if (!m_reader.readStartObject())
+        return;
+    while (m_reader.readNextKey()) {
+        OverlapableSerialList<DsCurve> *curves;
+        auto &key = m_reader.key();
+        if (key == "original")
+            curves = &param.original;
+        else if (key == "edited")
+            curves = &param.edited;
+        else if (key == "envelope")
+            curves = &param.envelope;
+        else {
+            m_reader.skipValue();
+            continue;
+        }
+        if (m_reader.readStartArray())
+            while (m_reader.readNextElement())
+                readCurve(*curves, clip);
+    }
+}
+void DspxStreamReader::readCurve(OverlapableSerialList<DsCurve> &curves, DsSingingClip *clip) {
+    if (!checkProgress() || !m_reader.readStartObject())
+        return;
+    QString type;
+    int start = 0;
+    int step = 5;
+    DsDrawCurve *drawCurve = nullptr;
+    DsAnchorCurve *anchorCurve = nullptr;
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "type") {
+            type = m_reader.readString();
+        } else if (key == "start") {
+            start = m_reader.readInt();
+        } else if (key == "step") {
+            step = m_reader.readInt();
+        } else if (key == "values") {
+            if (!drawCurve)
+                drawCurve = clip->createDrawCurve();
+            m_values.clear();
+            if (m_reader.readStartArray()) {
+                while (m_reader.readNextElement()) {
+                    m_values.append(m_reader.readInt());
+                    if (m_values.count() == ChunkedIntArray::ChunkSize) {
+                        drawCurve->writeValues(drawCurve->valueCount(), m_values);
+                        m_values.clear();
+                    }
+                }
+            }
+            if (!m_values.isEmpty())
+                drawCurve->writeValues(drawCurve->valueCount(), m_values);
+        } else if (key == "nodes") {
+            if (!anchorCurve)
+                anchorCurve = clip->createAnchorCurve();
+            if (m_reader.readStartArray())
+                while (m_reader.readNextElement())
+                    readAnchorNode(anchorCurve, clip);
+        } else {
+            m_reader.skipValue();
+        }
+    }
+
+    DsCurve *curve = nullptr;
+    if (type == "free") {
+        curve = drawCurve ? drawCurve : clip->createDrawCurve();
+        drawCurve = nullptr;
+    } else if (type == "anchor") {
+        curve = anchorCurve ? anchorCurve : clip->createAnchorCurve();
+        anchorCurve = nullptr;
+    }
+    // Content of the other type, or of an unknown one
+    if (drawCurve)
+        clip->destroyCurve(drawCurve);
+    if (anchorCurve)
+        clip->destroyCurve(anchorCurve);
+    if (!curve)
+        return;
+    curve->setStart(start);
+    if (curve->type() == DsCurve::Draw)
+        dynamic_cast<DsDrawCurve *>(curve)->step = step;
+    curves.add(curve);
+}
+void DspxStreamReader::readAnchorNode(DsAnchorCurve *curve, DsSingingClip *clip) {
+    if (!m_reader.readStartObject())
+        return;
+    int x = 0;
+    int y = 0;
+    auto interpMode = DsAnchorNode::None;
+    while (m_reader.readNextKey()) {
+        auto &key = m_reader.key();
+        if (key == "x") {
+            x = m_reader.readInt();
+        } else if (key == "y") {
+            y = m_reader.readInt();
+        } else if (key == "interp") {
+            auto interp = m_reader.readString();
+            if (interp == "linear")
+                interpMode = DsAnchorNode::Linear;
+            else if (interp == "hermite")
+                interpMode = DsAnchorNode::Hermite;
+        } else {
+            m_reader.skipValue();
+        }
+    }
+    auto node = clip->createAnchorNode(x, y);
+    node->setInterpMode(interpMode);
+    curve->insertNode(node);
+}
+quint64 DspxStreamReader::readPersistentId() {
+    quint64 persistentId = 0;
+    if (!m_reader.readStartObject())
+        return persistentId;
+    while (m_reader.readNextKey()) {
+        if (m_reader.key() != WorkspaceKey) {
+            m_reader.skipValue();
+            continue;
+        }
+        if (!m_reader.readStartObject())
+            continue;
+        while (m_reader.readNextKey())
+            if (m_reader.key() == PersistentIdKey)
+                persistentId = static_cast<quint64>(m_reader.readNumber());
+            else
+                m_reader.skipValue();
+    }
+    return persistentId;
+}
+void DspxStreamReader::restoreId(UniqueObject *object, quint64 persistentId) const {
+    if (m_restorePersistentIds && persistentId != 0)
+        object->setPersistentId(persistentId);
+}
+bool DspxStreamReader::checkProgress() {
+    if (m_cancelFlag && m_cancelFlag->load(std::memory_order_relaxed)) {
+        m_cancelled = true;
+        m_reader.raiseError("Cancelled");
+        return false;
+    }
+    auto bytesRead = m_reader.bytesRead();
+    if (m_progressCallback && bytesRead >= m_nextProgress) {
+        m_progressCallback(bytesRead, m_totalBytes);
+        m_nextProgress = bytesRead + qMax(m_totalBytes / 100, qint64(1));
+    }
+    return !m_reader.hasError();
+}
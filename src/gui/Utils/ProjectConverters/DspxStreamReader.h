@@ -0,0 +1,118 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef DSPXSTREAMREADER_H
+#define DSPXSTREAMREADER_H
+
+#include <atomic>
+#include <functional>
+
+#include <QList>
+
+#include "Model/DsTrack.h"
+#include "Utils/JsonStreamReader.h"
+
+// Reads a dspx project in one pass, creating tracks, clips, notes and curves as their JSON
+// is read. Nothing but the current block of the file, the current string and the values of
+// the curve being read is held besides the model objects themselves.
+//
+// Keys may come in any order. A clip or curve whose type is read after its content is
+// created from the content (notes and params make a singing clip, values a free curve and
+// nodes an anchor curve) and dropped at its end if the type disagrees.
+//
+// Tracks do not depend on each other. When reading from a QFile, the tracks array is first
+// skipped over to find where each track starts, and the tracks are then decoded on a thread
+// pool, each from a file handle of its own, and added in the order of the file.
+class DspxStreamReader {
+public:
+    // Persistent ids are kept in the workspace data of the tracks, clips and notes, which
+    // other editors carry along without reading
+    static constexpr const char *WorkspaceKey = "diffscope";
+    static constexpr const char *PersistentIdKey = "id";
+
+    using ProgressCallback = std::function<void(qint64 bytesRead, qint64 totalBytes)>;
+    using ClipCallback = std::function<void(int trackIndex, DsClip *clip)>;
+
+    explicit DspxStreamReader(QIODevice *device);
+    ~DspxStreamReader();
+
+    // Called about every percent of the file
+    void setProgressCallback(const ProgressCallback &callback);
+    // Checked at every note and curve. The flag may be set from another thread.
+    void setCancelFlag(const std::atomic<bool> *cancelled);
+    // Off when appending to another project, whose ids the read ones could clash with
+    void setRestorePersistentIds(bool restore);
+    // Called with each clip of a track, in the order of the file, once the whole track has been
+    // read (and moved to the thread of the reader), so the reader does not write to the clip
+    // again. The clip is freed with the reader or its track only, also when the read fails.
+    void setClipCallback(const ClipCallback &callback);
+    // Reads tracks and the bounds of their clips only, skipping notes and params. Much faster
+    // than a full read, for laying out a project before it is loaded.
+    void setOutlineOnly(bool outlineOnly);
+    // Threads the tracks of a file are decoded on, QThread::idealThreadCount() by default. With
+    // 1, or when reading an outline, they are read in order on the calling thread. Callbacks
+    // are never called concurrently, but may come from the decoding threads, and tracks may
+    // have their clips reported in any order.
+    void setThreadCount(int count);
+
+    bool read();
+    bool isCancelled() const;
+    QString errorString() const;
+
+    double tempo() const;
+    int numerator() const;
+    int denominator() const;
+    // The tracks read, owned by the caller afterwards. Tracks not taken are freed with the
+    // reader. After a failed read, these are the tracks read up to the error.
+    QList<DsTrack *> takeTracks();
+
+private:
+    DspxStreamReader(QIODevice *device, qint64 offset);
+
+    void readContent();
+    void readTimeline();
+    void readTracks();
+    void readTracksInParallel();
+    DsTrack *readTrack();
+    void readClip(DsTrack *track);
+    void readNote(DsSingingClip *clip);
+    QList<DsPhoneme> readPhonemes();
+    void readParams(DsSingingClip *clip);
+    void readParam(DsParam &param, DsSingingClip *clip);
+    void readCurve(OverlapableSerialList<DsCurve> &curves, DsSingingClip *clip);
+    void readAnchorNode(DsAnchorCurve *curve, DsSingingClip *clip);
+    quint64 readPersistentId();
+    // Passes the clips of the track just read to the clip callback
+    void reportClips();
+    void restoreId(UniqueObject *object, quint64 persistentId) const;
+    bool checkProgress();
+
+    JsonStreamReader m_reader;
+    // Set when reading from a file, which other threads can then open as well
+    QString m_fileName;
+    qint64 m_totalBytes;
+    qint64 m_nextProgress = 0;
+    ProgressCallback m_progressCallback;
+    ClipCallback m_clipCallback;
+    const std::atomic<bool> *m_cancelFlag = nullptr;
+    bool m_cancelled = false;
+    bool m_restorePersistentIds = true;
+    bool m_outlineOnly = false;
+    int m_threadCount;
+
+    double m_tempo = 120;
+    int m_numerator = 4;
+    int m_denominator = 4;
+    QList<DsTrack *> m_tracks;
+    // Index of the track being read
+    int m_trackIndex = 0;
+    // Clips of the track being read, in the order of the file
+    QList<DsClip *> m_readClips;
+    // Values of the free curve being read, written to it one chunk at a time
+    QList<int> m_values;
+};
+
+
+
+#endif // DSPXSTREAMREADER_H
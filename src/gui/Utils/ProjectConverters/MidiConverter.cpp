@@ -110,15 +110,16 @@ bool MidiConverter::load(const QString &path, AppModel *model, QString &errMsg,
 
     auto midi = new QDspx::MidiConverter;
 
-    auto decodeNotes = [](const QList<QDspx::Note> &arrNotes) {
+    auto decodeNotes = [](const QList<QDspx::Note> &arrNotes, DsSingingClip *clip) {
+        const Symbol defaultPronunciation(QStringLiteral("la"));
         QList<DsNote *> notes;
         for (const QDspx::Note &dsNote : arrNotes) {
-            auto note = new DsNote;
+            auto note = clip->createNote();
             note->setStart(dsNote.pos);
             note->setLength(dsNote.length);
             note->setKeyIndex(dsNote.keyNum);
             note->setLyric(dsNote.lyric);
-            note->setPronunciation("la");
+            note->setPronunciation(defaultPronunciation);
             notes.append(note);
         }
         return notes;
@@ -134,7 +135,7 @@ bool MidiConverter::load(const QString &path, AppModel *model, QString &errMsg,
                 singingClip->setClipStart(clip->time.clipStart);
                 singingClip->setLength(clip->time.length);
                 singingClip->setClipLen(clip->time.clipLen);
-                auto notes = decodeNotes(singClip->notes);
+                auto notes = decodeNotes(singClip->notes, singingClip);
                 for (auto &note : notes)
                     singingClip->insertNote(note);
                 dsTack->insertClip(singingClip);
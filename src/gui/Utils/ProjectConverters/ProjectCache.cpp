@@ -0,0 +1,567 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "ProjectCache.h"
+
+#include <cstring>
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+
+#include "Utils/ChunkedIntArray.h"
+#include "Utils/ContentHash.h"
+
+namespace {
+    constexpr quint32 Magic = 0x43505344; // "DSPC"
+    constexpr quint32 Version = 1;
+    // Records are stored in native byte order, so a cache written on a machine of the other
+    // byte order is ignored
+    constexpr quint32 ByteOrderMark = 0x01020304;
+
+    enum Section { Tracks, Clips, Notes, Phonemes, Curves, Values, Strings, SectionCount };
+
+    struct SectionRecord {
+        qint64 offset; // from the start of the file, a multiple of 8
+        qint64 count;  // of records, or of bytes for the strings
+    };
+    struct HeaderRecord {
+        quint32 magic;
+        quint32 version;
+        quint32 byteOrder;
+        qint32 numerator;
+        qint64 projectSize;
+        qint64 projectModified;
+        quint64 projectHash;
+        double tempo;
+        qint32 denominator;
+        qint32 reserved;
+        SectionRecord sections[SectionCount];
+    };
+    // Strings are byte offsets into the strings section, -1 for an empty string. Every entry
+    // there is its length in bytes followed by the UTF-8 bytes, padded to 4 bytes.
+    struct TrackRecord {
+        quint64 persistentId;
+        double gain;
+        double pan;
+        qint32 name;
+        qint32 firstClip;
+        qint32 clipCount;
+        quint8 mute;
+        quint8 solo;
+        quint8 reserved[2];
+    };
+    struct ClipRecord {
+        quint64 persistentId;
+        double gain;
+        qint32 type; // DsClip::ClipType
+        qint32 name;
+        qint32 path;
+        qint32 start;
+        qint32 clipStart;
+        qint32 length;
+        qint32 clipLen;
+        qint32 firstNote;
+        qint32 noteCount;
+        qint32 firstCurve;
+        qint32 curveCount;
+        quint8 mute;
+        quint8 reserved[3];
+    };
+    struct NoteRecord {
+        quint64 persistentId;
+        qint32 start;
+        qint32 length;
+        qint32 keyIndex;
+        qint32 lyric;
+        qint32 pronunciation;
+        qint32 firstOriginal;
+        qint32 originalCount;
+        qint32 firstEdited;
+        qint32 editedCount;
+        qint32 reserved;
+    };
+    struct PhonemeRecord {
+        qint32 type; // DsPhoneme::DsPhonemeType
+        qint32 name;
+        qint32 start;
+    };
+    struct CurveRecord {
+        qint64 firstValue;
+        qint32 param; // DsParams::ParamType
+        qint32 layer; // DsParam::ParamCurveType
+        qint32 type;  // DsCurve::DsCurveType
+        qint32 start;
+        qint32 step;
+        // Values of a draw curve. An anchor curve has three per node: its position, value
+        // and DsAnchorNode::InterpMode.
+        qint32 valueCount;
+    };
+
+    qint64 alignedTo8(qint64 size) {
+        return (size + 7) & ~qint64(7);
+    }
+
+    // Builds the sections in memory, as the header that locates them comes first
+    class CacheWriter {
+    public:
+        qint32 count(Section section) const {
+            return static_cast<qint32>(m_counts[section]);
+        }
+        template <typename T>
+        void append(Section section, const T &record) {
+            m_sections[section].append(reinterpret_cast<const char *>(&record), sizeof(T));
+            m_counts[section]++;
+        }
+        void appendValues(const int *values, int count) {
+            m_sections[Values].append(reinterpret_cast<const char *>(values),
+                                      count * static_cast<int>(sizeof(int)));
+            m_counts[Values] += count;
+        }
+        qint32 string(const QString &string) {
+            if (string.isEmpty())
+                return -1;
+            auto it = m_strings.constFind(string);
+            if (it != m_strings.cend())
+                return it.value();
+            auto &section = m_sections[Strings];
+            auto ref = static_cast<qint32>(section.size());
+            auto bytes = string.toUtf8();
+            auto length = static_cast<qint32>(bytes.size());
+            section.append(reinterpret_cast<const char *>(&length), sizeof(length));
+            section.append(bytes);
+            section.append(QByteArray((4 - bytes.size() % 4) % 4, '\0'));
+            m_counts[Strings] = section.size();
+            m_strings.insert(string, ref);
+            return ref;
+        }
+        bool write(QIODevice &device, HeaderRecord &header) const {
+            auto offset = alignedTo8(sizeof(HeaderRecord));
+            for (int i = 0; i < SectionCount; i++) {
+                header.sections[i] = {offset, m_counts[i]};
+                offset += alignedTo8(m_sections[i].size());
+            }
+            if (device.write(reinterpret_cast<const char *>(&header), sizeof(header)) !=
+                sizeof(header))
+                return false;
+            device.write(QByteArray(alignedTo8(sizeof(header)) - sizeof(header), '\0'));
+            for (const auto &section : m_sections) {
+                if (device.write(section) != section.size())
+                    return false;
+                device.write(QByteArray(alignedTo8(section.size()) - section.size(), '\0'));
+            }
+            return true;
+        }
+
+    private:
+        QByteArray m_sections[SectionCount];
+        qint64 m_counts[SectionCount] = {};
+        QHash<QString, qint32> m_strings;
+    };
+
+    void writePhonemes(CacheWriter &writer, const QList<DsPhoneme> &phonemes) {
+        for (const auto &phoneme : phonemes)
+            writer.append(Phonemes, PhonemeRecord{static_cast<qint32>(phoneme.type),
+                                                  writer.string(phoneme.name.toString()),
+                                                  phoneme.start});
+    }
+    void writeCurve(CacheWriter &writer, DsCurve *curve, int param, int layer) {
+        CurveRecord record{};
+        record.firstValue = writer.count(Values);
+        record.param = param;
+        record.layer = layer;
+        record.type = curve->type();
+        record.start = curve->start();
+        if (curve->type() == DsCurve::Draw) {
+            auto drawCurve = dynamic_cast<DsDrawCurve *>(curve);
+            record.step = drawCurve->step;
+            int buffer[ChunkedIntArray::ChunkSize];
+            for (int i = 0; i < drawCurve->valueCount(); i += ChunkedIntArray::ChunkSize) {
+                auto n = qMin(ChunkedIntArray::ChunkSize, drawCurve->valueCount() - i);
+                drawCurve->readValues(i, n, buffer);
+                writer.appendValues(buffer, n);
+            }
+        } else {
+            for (const auto node : dynamic_cast<DsAnchorCurve *>(curve)->nodes()) {
+                // What the dspx keeps of the mode
+                auto interpMode = node->interpMode();
+                if (interpMode != DsAnchorNode::Linear && interpMode != DsAnchorNode::Hermite)
+                    interpMode = DsAnchorNode::None;
+                int values[] = {node->pos(), node->value(), interpMode};
+                writer.appendValues(values, 3);
+            }
+        }
+        record.valueCount = static_cast<qint32>(writer.count(Values) - record.firstValue);
+        writer.append(Curves, record);
+    }
+    void writeClip(CacheWriter &writer, DsClip *clip) {
+        ClipRecord record{};
+        record.persistentId = clip->persistentId();
+        record.gain = clip->gain();
+        record.type = clip->type();
+        record.name = writer.string(clip->name());
+        record.path = -1;
+        record.start = clip->start();
+        record.clipStart = clip->clipStart();
+        record.length = clip->length();
+        record.clipLen = clip->clipLen();
+        record.mute = clip->mute();
+        record.firstNote = writer.count(Notes);
+        record.firstCurve = writer.count(Curves);
+        if (clip->type() == DsClip::Audio) {
+            record.path = writer.string(dynamic_cast<DsAudioClip *>(clip)->path());
+        } else {
+            auto singingClip = dynamic_cast<DsSingingClip *>(clip);
+            for (const auto note : singingClip->notes()) {
+                NoteRecord noteRecord{};
+                noteRecord.persistentId = note->persistentId();
+                noteRecord.start = note->start();
+                noteRecord.length = note->length();
+                noteRecord.keyIndex = note->keyIndex();
+                noteRecord.lyric = writer.string(note->lyric());
+                noteRecord.pronunciation = writer.string(note->pronunciation());
+                auto phonemes = note->phonemes();
+                noteRecord.firstOriginal = writer.count(Phonemes);
+                noteRecord.originalCount = phonemes.original.count();
+                writePhonemes(writer, phonemes.original);
+                // The dspx saves the original phonemes as the edited ones too
+                noteRecord.firstEdited = noteRecord.firstOriginal;
+                noteRecord.editedCount = noteRecord.originalCount;
+                writer.append(Notes, noteRecord);
+            }
+            for (const auto type :
+                 {DsParams::Pitch, DsParams::Energy, DsParams::Tension, DsParams::Breathiness})
+                for (const auto layer : {DsParam::Original, DsParam::Edited, DsParam::Envelope})
+                    for (const auto curve : singingClip->params.param(type).curves(layer))
+                        if (curve->type() == DsCurve::Draw || curve->type() == DsCurve::Anchor)
+                            writeCurve(writer, curve, type, layer);
+        }
+        record.noteCount = writer.count(Notes) - record.firstNote;
+        record.curveCount = writer.count(Curves) - record.firstCurve;
+        writer.append(Clips, record);
+    }
+}
+
+class ProjectCache::Mapping {
+public:
+    explicit Mapping(const QString &path) : m_file(path) {
+    }
+
+    // Maps the file and checks its header
+    bool map() {
+        if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(HeaderRecord)))
+            return false;
+        m_size = m_file.size();
+        m_data = m_file.map(0, m_size);
+        if (!m_data)
+            return false;
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        if (m_header.magic != Magic || m_header.version != Version ||
+            m_header.byteOrder != ByteOrderMark)
+            return false;
+        const qint64 recordSizes[] = {sizeof(TrackRecord),   sizeof(ClipRecord),
+                                      sizeof(NoteRecord),    sizeof(PhonemeRecord),
+                                      sizeof(CurveRecord),   sizeof(int),
+                                      1};
+        for (int i = 0; i < SectionCount; i++) {
+            const auto &section = m_header.sections[i];
+            if (section.offset < qint64(sizeof(HeaderRecord)) || section.count < 0 ||
+                section.count > (m_size - section.offset) / recordSizes[i])
+                return false;
+        }
+        return true;
+    }
+    // Whether every range a record refers to lies within its section, so that reading the
+    // tracks and notes needs no more checks
+    bool isConsistent() const {
+        auto inSection = [this](qint64 first, qint64 count, Section section) {
+            return first >= 0 && count >= 0 && first + count <= this->count(section);
+        };
+        for (qint64 i = 0; i < count(Tracks); i++) {
+            auto track = record<TrackRecord>(Tracks, i);
+            if (!inSection(track.firstClip, track.clipCount, Clips))
+                return false;
+        }
+        for (qint64 i = 0; i < count(Clips); i++) {
+            auto clip = record<ClipRecord>(Clips, i);
+            if ((clip.type != DsClip::Singing && clip.type != DsClip::Audio) ||
+                !inSection(clip.firstNote, clip.noteCount, Notes) ||
+                !inSection(clip.firstCurve, clip.curveCount, Curves))
+                return false;
+        }
+        for (qint64 i = 0; i < count(Notes); i++) {
+            auto note = record<NoteRecord>(Notes, i);
+            if (!inSection(note.firstOriginal, note.originalCount, Phonemes) ||
+                !inSection(note.firstEdited, note.editedCount, Phonemes))
+                return false;
+        }
+        for (qint64 i = 0; i < count(Curves); i++) {
+            auto curve = record<CurveRecord>(Curves, i);
+            if (curve.param < DsParams::Pitch || curve.param > DsParams::Breathiness ||
+                curve.layer < DsParam::Original || curve.layer > DsParam::Envelope ||
+                (curve.type != DsCurve::Draw && curve.type != DsCurve::Anchor) ||
+                (curve.type == DsCurve::Anchor && curve.valueCount % 3 != 0) ||
+                !inSection(curve.firstValue, curve.valueCount, Values))
+                return false;
+        }
+        return true;
+    }
+
+    const HeaderRecord &header() const {
+        return m_header;
+    }
+    qint64 count(Section section) const {
+        return m_header.sections[section].count;
+    }
+    template <typename T>
+    T record(Section section, qint64 index) const {
+        T result;
+        std::memcpy(&result, m_data + m_header.sections[section].offset + index * sizeof(T),
+                    sizeof(T));
+        return result;
+    }
+    QString string(qint32 ref) const {
+        const auto &section = m_header.sections[Strings];
+        qint32 length = 0;
+        if (ref < 0 || ref + qint64(sizeof(length)) > section.count)
+            return {};
+        auto entry = m_data + section.offset + ref;
+        std::memcpy(&length, entry, sizeof(length));
+        if (length < 0 || ref + qint64(sizeof(length)) + length > section.count)
+            return {};
+        return QString::fromUtf8(reinterpret_cast<const char *>(entry + sizeof(length)), length);
+    }
+
+    DsClip *readClip(const ClipRecord &record) {
+        DsClip *clip;
+        if (record.type == DsClip::Audio) {
+            auto audioClip = new DsAudioClip;
+            audioClip->setPath(string(record.path));
+            clip = audioClip;
+        } else {
+            auto singingClip = new DsSingingClip;
+            for (auto i = record.firstCurve; i < record.firstCurve + record.curveCount; i++)
+                readCurve(singingClip, this->record<CurveRecord>(Curves, i));
+            readNotes(singingClip, record.firstNote, record.noteCount);
+            clip = singingClip;
+        }
+        if (record.persistentId != 0)
+            clip->setPersistentId(record.persistentId);
+        clip->setName(string(record.name));
+        clip->setStart(record.start);
+        clip->setClipStart(record.clipStart);
+        clip->setLength(record.length);
+        clip->setClipLen(record.clipLen);
+        clip->setGain(record.gain);
+        clip->setMute(record.mute != 0);
+        return clip;
+    }
+
+private:
+    int value(qint64 index) const {
+        int value;
+        std::memcpy(&value, m_data + m_header.sections[Values].offset + index * sizeof(int),
+                    sizeof(int));
+        return value;
+    }
+    Symbol symbol(qint32 ref) {
+        auto it = m_symbols.constFind(ref);
+        if (it != m_symbols.cend())
+            return it.value();
+        auto symbol = Symbol(string(ref));
+        m_symbols.insert(ref, symbol);
+        return symbol;
+    }
+
+    void readCurve(DsSingingClip *clip, const CurveRecord &record) {
+        DsCurve *curve;
+        if (record.type == DsCurve::Draw) {
+            auto drawCurve = clip->createDrawCurve();
+            drawCurve->step = record.step;
+            QList<int> values;
+            for (int i = 0; i < record.valueCount; i += ChunkedIntArray::ChunkSize) {
+                values.clear();
+                auto end = qMin(i + ChunkedIntArray::ChunkSize, record.valueCount);
+                for (int j = i; j < end; j++)
+                    values.append(value(record.firstValue + j));
+                drawCurve->writeValues(i, values);
+            }
+            curve = drawCurve;
+        } else {
+            auto anchorCurve = clip->createAnchorCurve();
+            for (int i = 0; i < record.valueCount; i += 3) {
+                auto node = clip->createAnchorNode(value(record.firstValue + i),
+                                                   value(record.firstValue + i + 1));
+                auto interpMode = value(record.firstValue + i + 2);
+                node->setInterpMode(interpMode >= DsAnchorNode::Linear &&
+                                            interpMode <= DsAnchorNode::None
+                                        ? static_cast<DsAnchorNode::InterpMode>(interpMode)
+                                        : DsAnchorNode::None);
+                anchorCurve->insertNode(node);
+            }
+            curve = anchorCurve;
+        }
+        curve->setStart(record.start);
+        clip->params.param(static_cast<DsParams::ParamType>(record.param))
+            .curves(static_cast<DsParam::ParamCurveType>(record.layer))
+            .add(curve);
+    }
+    QList<DsPhoneme> readPhonemes(qint64 first, qint64 count) {
+        QList<DsPhoneme> phonemes;
+        phonemes.reserve(static_cast<int>(count));
+        for (auto i = first; i < first + count; i++) {
+            auto record = this->record<PhonemeRecord>(Phonemes, i);
+            auto type = record.type >= DsPhoneme::Ahead && record.type <= DsPhoneme::Final
+                            ? static_cast<DsPhoneme::DsPhonemeType>(record.type)
+                            : DsPhoneme::Normal;
+            phonemes.append(DsPhoneme(type, symbol(record.name), record.start));
+        }
+        return phonemes;
+    }
+    void readNotes(DsSingingClip *clip, qint64 first, qint64 count) {
+        for (auto i = first; i < first + count; i++) {
+            auto record = this->record<NoteRecord>(Notes, i);
+            auto note = clip->createNote();
+            if (record.persistentId != 0)
+                note->setPersistentId(record.persistentId);
+            note->setStart(record.start);
+            note->setLength(record.length);
+            note->setKeyIndex(record.keyIndex);
+            note->setLyric(symbol(record.lyric));
+            note->setPronunciation(symbol(record.pronunciation));
+            if (record.originalCount > 0)
+                note->setPhonemes(DsPhonemes::Original,
+                                  readPhonemes(record.firstOriginal, record.originalCount));
+            if (record.editedCount > 0)
+                note->setPhonemes(DsPhonemes::Edited,
+                                  readPhonemes(record.firstEdited, record.editedCount));
+            clip->insertNoteQuietly(note);
+        }
+    }
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    HeaderRecord m_header{};
+    // Lyrics and phoneme names repeat a lot, so each is interned once
+    QHash<qint32, Symbol> m_symbols;
+};
+
+QString ProjectCache::pathOf(const QString &projectPath) {
+    return projectPath + ".cache";
+}
+bool ProjectCache::write(const QString &projectPath, const AppModel &model) {
+    QFileInfo info(projectPath);
+    HeaderRecord header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.byteOrder = ByteOrderMark;
+    header.projectSize = info.size();
+    header.projectModified = info.lastModified().toMSecsSinceEpoch();
+    header.tempo = model.tempo();
+    header.numerator = model.timeSignature().numerator;
+    header.denominator = model.timeSignature().denominator;
+
+    CacheWriter writer;
+    for (const auto track : model.tracks()) {
+        TrackRecord record{};
+        record.persistentId = track->persistentId();
+        record.gain = track->control().gain();
+        record.pan = track->control().pan();
+        record.mute = track->control().mute();
+        record.solo = track->control().solo();
+        record.name = writer.string(track->name());
+        record.firstClip = writer.count(Clips);
+        for (const auto clip : track->clips())
+            if (clip->type() == DsClip::Singing || clip->type() == DsClip::Audio)
+                writeClip(writer, clip);
+        record.clipCount = writer.count(Clips) - record.firstClip;
+        writer.append(Tracks, record);
+    }
+
+    QSaveFile file(pathOf(projectPath));
+    if (!hashFile(projectPath, header.projectHash) || !file.open(QIODevice::WriteOnly) ||
+        !writer.write(file, header) || !file.commit()) {
+        // A stale cache would fail validation anyway, but costs a hash of the project
+        QFile::remove(pathOf(projectPath));
+        return false;
+    }
+    return true;
+}
+bool ProjectCache::open(const QString &projectPath) {
+    m_mapping.reset();
+    QFileInfo projectInfo(projectPath);
+    QFileInfo cacheInfo(pathOf(projectPath));
+    if (!projectInfo.exists() || !cacheInfo.exists() ||
+        cacheInfo.lastModified() < projectInfo.lastModified())
+        return false;
+
+    auto mapping = std::make_shared<Mapping>(pathOf(projectPath));
+    if (!mapping->map())
+        return false;
+    const auto &header = mapping->header();
+    quint64 hash = 0;
+    if (header.projectSize != projectInfo.size() ||
+        header.projectModified != projectInfo.lastModified().toMSecsSinceEpoch() ||
+        !hashFile(projectPath, hash) || hash != header.projectHash || !mapping->isConsistent())
+        return false;
+    m_mapping = mapping;
+    return true;
+}
+double ProjectCache::tempo() const {
+    return m_mapping ? m_mapping->header().tempo : 120;
+}
+AppModel::TimeSignature ProjectCache::timeSignature() const {
+    if (!m_mapping)
+        return {};
+    return {m_mapping->header().numerator, m_mapping->header().denominator};
+}
+QList<DsTrack *> ProjectCache::readTracks() const {
+    QList<DsTrack *> tracks;
+    if (!m_mapping)
+        return tracks;
+    for (qint64 i = 0; i < m_mapping->count(Tracks); i++) {
+        auto record = m_mapping->record<TrackRecord>(Tracks, i);
+        auto track = new DsTrack;
+        if (record.persistentId != 0)
+            track->setPersistentId(record.persistentId);
+        track->setName(m_mapping->string(record.name));
+        DsTrackControl control;
+        control.setGain(record.gain);
+        control.setPan(record.pan);
+        control.setMute(record.mute != 0);
+        control.setSolo(record.solo != 0);
+        track->setControl(control);
+        for (auto c = record.firstClip; c < record.firstClip + record.clipCount; c++) {
+            auto clip = m_mapping->readClip(m_mapping->record<ClipRecord>(Clips, c));
+            track->insertClipQuietly(clip);
+        }
+        tracks.append(track);
+    }
+    return tracks;
+}
+bool ProjectCache::hashFile(const QString &path, quint64 &hash) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    ContentHash contentHash;
+    QByteArray block(1 << 20, Qt::Uninitialized);
+    qint64 size = 0;
+    qint64 n;
+    while ((n = file.read(block.data(), block.size())) > 0) {
+        // By words, the last one padded with zeros
+        for (qint64 i = 0; i < n; i += 8) {
+            quint64 word = 0;
+            std::memcpy(&word, block.constData() + i, static_cast<size_t>(qMin<qint64>(8, n - i)));
+            contentHash.add(word);
+        }
+        size += n;
+    }
+    if (n < 0)
+        return false;
+    hash = contentHash.add(static_cast<quint64>(size)).result();
+    return true;
+}
@@ -0,0 +1,51 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef PROJECTCACHE_H
+#define PROJECTCACHE_H
+
+#include <memory>
+
+#include "Model/AppModel.h"
+
+// Binary sidecar of a dspx project, "<project>.cache", from which the project is reopened
+// without parsing its JSON.
+//
+// The cache is a header followed by contiguous sections of fixed-size records in native byte
+// order: tracks, clips, notes, phonemes and curves, then the values of the curves and the
+// strings. Each record refers to a range of the next section, a track to its clips, a clip to
+// its notes and curves and so on. It is written after every save and read in place from a
+// memory mapping. A cache is used only if it is newer than the project, was written for a
+// file of the same size and modification time and for the same content, which is hashed
+// again; otherwise the project has to be read from its JSON.
+//
+// Everything is created when the tracks are read, which ProjectLoader does on its thread, so
+// the model and its snapshot never wait for notes to be decoded.
+class ProjectCache {
+public:
+    static QString pathOf(const QString &projectPath);
+    // Writes the cache of model, which has just been saved to projectPath. The previous cache
+    // is removed if it cannot be replaced.
+    static bool write(const QString &projectPath, const AppModel &model);
+
+    // Maps the cache of projectPath if it is valid for the project on disk
+    bool open(const QString &projectPath);
+
+    // Valid after open() has succeeded
+    double tempo() const;
+    AppModel::TimeSignature timeSignature() const;
+    // Creates the tracks of the project, owned by the caller
+    QList<DsTrack *> readTracks() const;
+
+private:
+    class Mapping;
+
+    static bool hashFile(const QString &path, quint64 &hash);
+
+    std::shared_ptr<Mapping> m_mapping;
+};
+
+
+
+#endif // PROJECTCACHE_H
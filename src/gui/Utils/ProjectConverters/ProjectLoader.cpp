@@ -0,0 +1,136 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include "ProjectLoader.h"
+
+#include <QFile>
+
+#include "DspxStreamReader.h"
+#include "ProjectCache.h"
+
+ProjectLoader::ProjectLoader(const QString &path, QObject *parent)
+    : QThread(parent), m_path(path) {
+}
+ProjectLoader::~ProjectLoader() {
+    cancel();
+    wait();
+    deleteTracks(m_tracks);
+    deleteTracks(m_outline);
+    deleteTracks(m_failedTracks);
+}
+QString ProjectLoader::path() const {
+    return m_path;
+}
+void ProjectLoader::cancel() {
+    m_cancelled = true;
+}
+bool ProjectLoader::isCancelled() const {
+    return m_cancelled;
+}
+bool ProjectLoader::isSuccessful() const {
+    return m_successful;
+}
+QString ProjectLoader::errorString() const {
+    return m_errorString;
+}
+double ProjectLoader::tempo() const {
+    return m_tempo;
+}
+AppModel::TimeSignature ProjectLoader::timeSignature() const {
+    return m_timeSignature;
+}
+QList<DsTrack *> ProjectLoader::takeTracks() {
+    QList<DsTrack *> tracks;
+    tracks.swap(m_tracks);
+    return tracks;
+}
+const QList<DsTrack *> &ProjectLoader::outline() const {
+    return m_outline;
+}
+void ProjectLoader::run() {
+    m_successful = readCache() || (readOutline() && readProject());
+}
+bool ProjectLoader::readCache() {
+    ProjectCache cache;
+    if (!cache.open(m_path))
+        return false;
+    m_tempo = cache.tempo();
+    m_timeSignature = cache.timeSignature();
+    m_tracks = cache.readTracks();
+    moveToOwnerThread(m_tracks);
+    emit progressChanged(100);
+    return true;
+}
+bool ProjectLoader::readOutline() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    DspxStreamReader reader(&file);
+    reader.setOutlineOnly(true);
+    reader.setCancelFlag(&m_cancelled);
+    reader.setClipCallback([this](int trackIndex, DsClip *clip) {
+        while (m_outlineClipIds.count() <= trackIndex)
+            m_outlineClipIds.append(QList<int>());
+        m_outlineClipIds[trackIndex].append(clip->id());
+    });
+    if (!reader.read()) {
+        m_errorString = reader.errorString();
+        return false;
+    }
+    m_outline = reader.takeTracks();
+    moveToOwnerThread(m_outline);
+    emit outlineLoaded();
+    return true;
+}
+bool ProjectLoader::readProject() {
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_errorString = file.errorString();
+        return false;
+    }
+    DspxStreamReader reader(&file);
+    reader.setCancelFlag(&m_cancelled);
+    reader.setProgressCallback([this](qint64 bytesRead, qint64 totalBytes) {
+        emit progressChanged(totalBytes > 0 ? static_cast<int>(bytesRead * 100 / totalBytes) : 0);
+    });
+    // Both passes see the same clips in the same order
+    QList<int> clipCounts;
+    reader.setClipCallback([&](int trackIndex, DsClip *clip) {
+        while (clipCounts.count() <= trackIndex)
+            clipCounts.append(0);
+        auto outlineClipId = m_outlineClipIds.value(trackIndex).value(clipCounts[trackIndex], -1);
+        clipCounts[trackIndex]++;
+        emit clipLoaded(outlineClipId, clip);
+    });
+    if (!reader.read()) {
+        m_errorString = reader.errorString();
+        // The queued clipLoaded() signals may still point into them
+        m_failedTracks = reader.takeTracks();
+        moveToOwnerThread(m_failedTracks);
+        return false;
+    }
+    m_tempo = reader.tempo();
+    m_timeSignature = AppModel::TimeSignature(reader.numerator(), reader.denominator());
+    m_tracks = reader.takeTracks();
+    moveToOwnerThread(m_tracks);
+    return true;
+}
+void ProjectLoader::moveToOwnerThread(const QList<DsTrack *> &tracks) {
+    for (const auto track : tracks) {
+        track->moveToThread(thread());
+        for (const auto clip : track->clips())
+            clip->moveToThread(thread());
+    }
+}
+void ProjectLoader::deleteTracks(const QList<DsTrack *> &tracks) {
+    for (const auto track : tracks) {
+        QList<DsClip *> clips;
+        for (const auto clip : track->clips())
+            clips.append(clip);
+        delete track;
+        qDeleteAll(clips);
+    }
+}
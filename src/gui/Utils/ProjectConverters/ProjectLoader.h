@@ -0,0 +1,88 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef PROJECTLOADER_H
+#define PROJECTLOADER_H
+
+#include <atomic>
+
+#include <QThread>
+
+#include "Model/AppModel.h"
+
+// Loads a dspx project on a thread of its own.
+//
+// The file is read twice. The first pass reads the tracks and the bounds of their clips only,
+// which takes a fraction of the time of the second, full pass, so that the editor can show the
+// layout of the project early: outlineLoaded() is emitted then. During the full pass
+// clipLoaded() reports the clips of each track once the whole track has been read, so nothing
+// writes to them anymore. The project is handed over in one piece once the thread has
+// finished.
+//
+// A project with a valid ProjectCache is read from the cache instead, in one step and without
+// an outline.
+//
+// Objects created by the loader are moved to the thread the loader lives in before they are
+// announced.
+class ProjectLoader final : public QThread {
+    Q_OBJECT
+
+public:
+    explicit ProjectLoader(const QString &path, QObject *parent = nullptr);
+    // Cancels a running load and waits for it
+    ~ProjectLoader() override;
+
+    QString path() const;
+    // Makes a running load stop soon. May be called from any thread.
+    void cancel();
+    bool isCancelled() const;
+
+    // Valid once the thread has finished
+    bool isSuccessful() const;
+    QString errorString() const;
+    double tempo() const;
+    AppModel::TimeSignature timeSignature() const;
+    // The tracks loaded, owned by the caller afterwards. Tracks not taken are freed with the
+    // loader.
+    QList<DsTrack *> takeTracks();
+
+    // Tracks with their clips but without notes and params, valid after outlineLoaded() for
+    // the lifetime of the loader
+    const QList<DsTrack *> &outline() const;
+
+signals:
+    void progressChanged(int percent);
+    void outlineLoaded();
+    // clip is the full counterpart of the outline clip with the given id. It may be read, but
+    // not changed, until the thread has finished, and stays valid for the lifetime of the
+    // loader, also when the load fails or is cancelled.
+    void clipLoaded(int outlineClipId, DsClip *clip);
+
+protected:
+    void run() override;
+
+private:
+    bool readCache();
+    bool readOutline();
+    bool readProject();
+    void moveToOwnerThread(const QList<DsTrack *> &tracks);
+    static void deleteTracks(const QList<DsTrack *> &tracks);
+
+    QString m_path;
+    std::atomic<bool> m_cancelled{false};
+    bool m_successful = false;
+    QString m_errorString;
+    double m_tempo = 120;
+    AppModel::TimeSignature m_timeSignature;
+    QList<DsTrack *> m_tracks;
+    QList<DsTrack *> m_outline;
+    // Tracks read before a load failed, kept for the clips clipLoaded() has reported
+    QList<DsTrack *> m_failedTracks;
+    // Ids of the outline clips of each track, in the order of the file
+    QList<QList<int>> m_outlineClipIds;
+};
+
+
+
+#endif // PROJECTLOADER_H
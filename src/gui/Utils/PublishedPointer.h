@@ -0,0 +1,67 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef PUBLISHEDPOINTER_H
+#define PUBLISHEDPOINTER_H
+
+#include <atomic>
+#include <memory>
+
+// Latest of the shared pointers published by one thread, to be read from any thread.
+//
+// std::atomic_load() on a shared_ptr takes a lock from a shared pool, so this keeps the
+// pointers in a few slots instead. A reader announces itself on the current slot, checks
+// that it is still current and copies the pointer out. The writer only fills a slot that is
+// neither current nor announced, so load() takes no lock and only retries when a store()
+// happened in between. store() must not be called from several threads at once.
+template <typename T, int SlotCount = 4>
+class PublishedPointer {
+public:
+    PublishedPointer() = default;
+    PublishedPointer(const PublishedPointer &) = delete;
+    PublishedPointer &operator=(const PublishedPointer &) = delete;
+
+    std::shared_ptr<T> load() const {
+        for (;;) {
+            auto index = m_current.load();
+            auto &slot = m_slots[index];
+            slot.readers.fetch_add(1);
+            auto current = m_current.load() == index;
+            std::shared_ptr<T> pointer;
+            if (current)
+                pointer = slot.pointer;
+            slot.readers.fetch_sub(1);
+            if (current)
+                return pointer;
+        }
+    }
+    void store(std::shared_ptr<T> pointer) {
+        auto current = m_current.load();
+        auto index = current;
+        do
+            index = (index + 1) % SlotCount;
+        while (index == current || m_slots[index].readers.load() != 0);
+        m_slots[index].pointer = std::move(pointer);
+        m_current.store(index);
+        // A reader announcing itself on another slot from now on sees it is not current, so
+        // the pointers no reader is copying can be released
+        for (int i = 0; i < SlotCount; i++)
+            if (i != index && m_slots[i].readers.load() == 0)
+                m_slots[i].pointer.reset();
+    }
+
+private:
+    class Slot {
+    public:
+        std::shared_ptr<T> pointer;
+        mutable std::atomic<int> readers{0};
+    };
+
+    Slot m_slots[SlotCount];
+    std::atomic<int> m_current{0};
+};
+
+
+
+#endif // PUBLISHEDPOINTER_H
@@ -0,0 +1,112 @@
+//
+// Created by fluty on 2024/2/14.
+//
+
+#ifndef SAMPLINGKERNELS_H
+#define SAMPLINGKERNELS_H
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SAMPLING_KERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+// Inner loops of parameter curve sampling. Each kernel has a portable scalar version and,
+// where the target has SSE2, a vectorized one that yields the same results; the unsuffixed
+// function picks the best available.
+namespace SamplingKernels {
+    // Cubic Hermite segment from v0 to v1 with tangents m0 and m1 (already scaled to the
+    // segment length), evaluated at t = t0 + i * dt for i in [0, n).
+    // m0 = m1 = v1 - v0 gives a straight line, m0 = m1 = 0 an ease-in-out curve.
+    inline void hermiteScalar(float t0, float dt, int n, float v0, float v1, float m0, float m1,
+                              float *out) {
+        const float a = 2 * (v0 - v1) + m0 + m1;
+        const float b = 3 * (v1 - v0) - 2 * m0 - m1;
+        for (int i = 0; i < n; i++) {
+            const float t = t0 + static_cast<float>(i) * dt;
+            out[i] = ((a * t + b) * t + m0) * t + v0;
+        }
+    }
+
+    inline void addScalar(const float *src, float *dst, int n) {
+        for (int i = 0; i < n; i++)
+            dst[i] += src[i];
+    }
+
+    inline void convertScalar(const int *src, float *dst, int n) {
+        for (int i = 0; i < n; i++)
+            dst[i] = static_cast<float>(src[i]);
+    }
+
+#ifdef SAMPLING_KERNELS_SSE2
+    inline void hermiteSse2(float t0, float dt, int n, float v0, float v1, float m0, float m1,
+                            float *out) {
+        const float a = 2 * (v0 - v1) + m0 + m1;
+        const float b = 3 * (v1 - v0) - 2 * m0 - m1;
+        const __m128 va = _mm_set1_ps(a);
+        const __m128 vb = _mm_set1_ps(b);
+        const __m128 vm0 = _mm_set1_ps(m0);
+        const __m128 vv0 = _mm_set1_ps(v0);
+        const __m128 vt0 = _mm_set1_ps(t0);
+        const __m128 vdt = _mm_set1_ps(dt);
+        const __m128i lanes = _mm_set_epi32(3, 2, 1, 0);
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 index = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(i), lanes));
+            const __m128 t = _mm_add_ps(vt0, _mm_mul_ps(index, vdt));
+            __m128 r = _mm_add_ps(_mm_mul_ps(va, t), vb);
+            r = _mm_add_ps(_mm_mul_ps(r, t), vm0);
+            r = _mm_add_ps(_mm_mul_ps(r, t), vv0);
+            _mm_storeu_ps(out + i, r);
+        }
+        for (; i < n; i++) {
+            const float t = t0 + static_cast<float>(i) * dt;
+            out[i] = ((a * t + b) * t + m0) * t + v0;
+        }
+    }
+
+    inline void addSse2(const float *src, float *dst, int n) {
+        int i = 0;
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+        for (; i < n; i++)
+            dst[i] += src[i];
+    }
+
+    inline void convertSse2(const int *src, float *dst, int n) {
+        int i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(v));
+        }
+        for (; i < n; i++)
+            dst[i] = static_cast<float>(src[i]);
+    }
+#endif
+
+    inline void hermite(float t0, float dt, int n, float v0, float v1, float m0, float m1,
+                        float *out) {
+#ifdef SAMPLING_KERNELS_SSE2
+        hermiteSse2(t0, dt, n, v0, v1, m0, m1, out);
+#else
+        hermiteScalar(t0, dt, n, v0, v1, m0, m1, out);
+#endif
+    }
+
+    inline void add(const float *src, float *dst, int n) {
+#ifdef SAMPLING_KERNELS_SSE2
+        addSse2(src, dst, n);
+#else
+        addScalar(src, dst, n);
+#endif
+    }
+
+    inline void convert(const int *src, float *dst, int n) {
+#ifdef SAMPLING_KERNELS_SSE2
+        convertSse2(src, dst, n);
+#else
+        convertScalar(src, dst, n);
+#endif
+    }
+}
+
+#endif // SAMPLINGKERNELS_H
@@ -0,0 +1,108 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <atomic>
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+
+#include "Singleton.h"
+
+// Table of the distinct strings used as lyrics, pronunciations and phoneme names.
+//
+// A song only has a few hundred distinct syllables and a few dozen phonemes, so the model
+// stores each string once here and refers to it by a compact id. Strings are never removed:
+// the table stays as small as the vocabulary of the projects opened in the session. Id 0 is
+// the empty string.
+//
+// Interning may happen on loader threads and takes a lock. The strings are kept in chunks
+// that never move, so string() takes no lock and the reference it returns stays valid.
+class SymbolTable : public Singleton<SymbolTable> {
+public:
+    static constexpr int ChunkSize = 1024;
+    static constexpr int MaxChunks = 4096;
+
+    SymbolTable() {
+        m_chunks[0].store(new QString[ChunkSize], std::memory_order_relaxed);
+    }
+    ~SymbolTable() {
+        for (auto &chunk : m_chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    quint32 intern(const QString &string) {
+        if (string.isEmpty())
+            return 0;
+        QMutexLocker locker(&m_mutex);
+        auto it = m_ids.constFind(string);
+        if (it != m_ids.cend())
+            return it.value();
+        auto id = m_count.load(std::memory_order_relaxed);
+        Q_ASSERT(id < static_cast<quint32>(ChunkSize) * MaxChunks);
+        auto &chunk = m_chunks[id / ChunkSize];
+        if (!chunk.load(std::memory_order_relaxed))
+            chunk.store(new QString[ChunkSize], std::memory_order_release);
+        chunk.load(std::memory_order_relaxed)[id % ChunkSize] = string;
+        m_ids.insert(string, id);
+        m_count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+    // id must come from intern(), on this thread or handed over to it
+    const QString &string(quint32 id) const {
+        return m_chunks[id / ChunkSize].load(std::memory_order_acquire)[id % ChunkSize];
+    }
+    int count() const {
+        return static_cast<int>(m_count.load(std::memory_order_acquire));
+    }
+
+private:
+    QMutex m_mutex;
+    QHash<QString, quint32> m_ids;
+    std::atomic<QString *> m_chunks[MaxChunks] = {};
+    std::atomic<quint32> m_count{1};
+};
+
+// An interned string. Symbols of equal strings have the same id, so comparing and hashing
+// them are integer operations. A default symbol is the empty string.
+class Symbol {
+public:
+    Symbol() = default;
+    explicit Symbol(const QString &string) : m_id(SymbolTable::instance()->intern(string)) {
+    }
+
+    quint32 id() const {
+        return m_id;
+    }
+    bool isEmpty() const {
+        return m_id == 0;
+    }
+    const QString &toString() const {
+        return SymbolTable::instance()->string(m_id);
+    }
+
+    bool operator==(const Symbol &other) const {
+        return m_id == other.m_id;
+    }
+    bool operator!=(const Symbol &other) const {
+        return m_id != other.m_id;
+    }
+
+private:
+    quint32 m_id = 0;
+};
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+inline size_t qHash(const Symbol &symbol, size_t seed = 0) {
+#else
+inline uint qHash(const Symbol &symbol, uint seed = 0) {
+#endif
+    return qHash(symbol.id(), seed);
+}
+
+#endif // SYMBOL_H
@@ -0,0 +1,103 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#ifndef TICKSAMPLECONVERTER_H
+#define TICKSAMPLECONVERTER_H
+
+#include <cmath>
+#include <numeric>
+
+#include <QtGlobal>
+
+// Converts between ticks and sample positions at a fixed tempo and sample rate.
+//
+// Sample positions are 64-bit and whole ticks map to samples exactly:
+//     sample = floor(tick * 60 * sampleRate / (tempo * 480))
+// is evaluated as a reduced integer ratio, with the tempo taken to 1/1000 BPM and the sample
+// rate to 1 Hz, so hour-long positions at high sample rates neither overflow nor drift.
+class TickSampleConverter {
+public:
+    static constexpr int TicksPerQuarterNote = 480;
+
+    TickSampleConverter() = default;
+    TickSampleConverter(double tempo, double sampleRate) {
+        set(tempo, sampleRate);
+    }
+
+    void set(double tempo, double sampleRate) {
+        m_tempo = tempo;
+        m_sampleRate = sampleRate;
+        auto milliBpm = qRound64(tempo * 1000);
+        auto rate = qRound64(sampleRate);
+        if (milliBpm <= 0 || rate <= 0) {
+            m_num = 0;
+            m_den = 1;
+            return;
+        }
+        // tick * 60 * rate / (milliBpm / 1000 * 480) = tick * rate * 125 / milliBpm
+        auto num = rate * 125;
+        auto den = milliBpm;
+        auto divisor = std::gcd(num, den);
+        m_num = num / divisor;
+        m_den = den / divisor;
+    }
+
+    double tempo() const {
+        return m_tempo;
+    }
+    double sampleRate() const {
+        return m_sampleRate;
+    }
+    bool isValid() const {
+        return m_num > 0;
+    }
+
+    qint64 tickToSample(int tick) const {
+        return tickToSample(static_cast<qint64>(tick));
+    }
+    qint64 tickToSample(qint64 tick) const {
+        auto whole = floorDiv(tick, m_den);
+        auto rest = tick - whole * m_den;
+        return whole * m_num + floorDiv(rest * m_num, m_den);
+    }
+    // Fractional ticks, e.g. the playback position
+    qint64 tickToSample(double tick) const {
+        auto wholeTick = static_cast<qint64>(std::floor(tick));
+        auto fraction = tick - static_cast<double>(wholeTick);
+        auto whole = floorDiv(wholeTick, m_den);
+        auto rest = wholeTick - whole * m_den;
+        auto part = (static_cast<double>(rest * m_num) + fraction * static_cast<double>(m_num)) /
+                    static_cast<double>(m_den);
+        // Keeps positions that came from sampleToTick() on their own sample. Whole ticks land
+        // on multiples of 1 / m_den, so anything below half of that leaves them exact.
+        auto epsilon = qMin(1e-3, 0.5 / static_cast<double>(m_den));
+        return whole * m_num + static_cast<qint64>(std::floor(part + epsilon));
+    }
+    double sampleToTick(qint64 sample) const {
+        if (!isValid())
+            return 0;
+        auto whole = floorDiv(sample, m_num);
+        auto rest = sample - whole * m_num;
+        return static_cast<double>(whole * m_den) +
+               static_cast<double>(rest * m_den) / static_cast<double>(m_num);
+    }
+
+private:
+    static qint64 floorDiv(qint64 a, qint64 b) {
+        auto q = a / b;
+        if ((a % b != 0) && ((a < 0) != (b < 0)))
+            q--;
+        return q;
+    }
+
+    double m_tempo = 0;
+    double m_sampleRate = 0;
+    // samples per tick = m_num / m_den
+    qint64 m_num = 0;
+    qint64 m_den = 1;
+};
+
+
+
+#endif // TICKSAMPLECONVERTER_H
@@ -11,15 +11,57 @@ class UniqueObject {
 public:
     UniqueObject() {
         m_id = IdGenerator::instance()->id();
+        IdGenerator::instance()->registerObject(m_id, this);
     }
     UniqueObject(int id) : m_id(id) {
+        IdGenerator::instance()->registerObject(m_id, this);
+    }
+    UniqueObject(const UniqueObject &other)
+        : m_id(other.m_id), m_persistentId(other.m_persistentId) {
+        IdGenerator::instance()->registerObject(m_id, this);
+    }
+    UniqueObject &operator=(const UniqueObject &other) {
+        if (m_id != other.m_id) {
+            IdGenerator::instance()->unregisterObject(m_id, this);
+            m_id = other.m_id;
+            IdGenerator::instance()->registerObject(m_id, this);
+        }
+        m_persistentId = other.m_persistentId;
+        return *this;
+    }
+    virtual ~UniqueObject() {
+        IdGenerator::instance()->unregisterObject(m_id, this);
     }
     int id() const {
         return m_id;
     }
 
+    // Id saved in the project file, stable across sessions and usable as a cache key. 0 until
+    // the object is restored from a file or first saved.
+    quint64 persistentId() const {
+        return m_persistentId;
+    }
+    void setPersistentId(quint64 id) {
+        m_persistentId = id;
+        IdGenerator::instance()->reservePersistentId(id);
+    }
+    // Assigns a new persistent id if the object has none yet
+    quint64 ensurePersistentId() {
+        if (m_persistentId == 0)
+            m_persistentId = IdGenerator::instance()->persistentId();
+        return m_persistentId;
+    }
+
+    // Returns a live object of type T with the given id, or nullptr
+    template <typename T>
+    static T *find(int id) {
+        return dynamic_cast<T *>(IdGenerator::instance()->findObject(
+            id, [](UniqueObject *object) { return dynamic_cast<T *>(object) != nullptr; }));
+    }
+
 protected:
     int m_id;
+    quint64 m_persistentId = 0;
 };
 
 #endif // UNIQUEOBJECT_H
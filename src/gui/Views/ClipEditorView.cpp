@@ -68,7 +68,7 @@ void ClipEditorView::onSelectedClipChanged(DsTrack *track, DsClip *clip) {
 
         if (m_track != nullptr) {
             qDebug() << "disconnect track and ClipEditorView";
-            disconnect(m_track, &DsTrack::clipChanged, this, &ClipEditorView::handleClipChanged);
+            disconnect(m_track, &DsTrack::clipsChanged, this, &ClipEditorView::handleClipsChanged);
         }
         m_track = nullptr;
         m_clip = nullptr;
@@ -78,7 +78,7 @@ void ClipEditorView::onSelectedClipChanged(DsTrack *track, DsClip *clip) {
     m_track = track;
     m_clip = clip;
     qDebug() << "connect track and ClipEditorView";
-    connect(m_track, &DsTrack::clipChanged, this, &ClipEditorView::handleClipChanged);
+    connect(m_track, &DsTrack::clipsChanged, this, &ClipEditorView::handleClipsChanged);
     m_toolbarView->setClipName(clip->name());
     m_toolbarView->setClipPropertyEditorEnabled(true);
 
@@ -111,11 +111,12 @@ void ClipEditorView::onClipNameEdited(const QString &name) {
 
     TracksViewController::instance()->onClipPropertyChanged(args);
 }
-void ClipEditorView::handleClipChanged(DsTrack::ClipChangeType type, int id, DsClip *clip) {
+void ClipEditorView::handleClipsChanged(DsTrack::ClipChangeType type,
+                                        const QList<DsClip *> &clips) {
     if (m_clip == nullptr)
         return;
 
-    if (id == m_clip->id()) {
+    if (clips.contains(m_clip)) {
         if (type == DsTrack::PropertyChanged) {
             handleClipPropertyChange();
         }
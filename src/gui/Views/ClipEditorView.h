@@ -22,7 +22,7 @@ public slots:
     void onClipNameEdited(const QString &name);
 
 private slots:
-    void handleClipChanged(DsTrack::ClipChangeType type, int id, DsClip *clip);
+    void handleClipsChanged(DsTrack::ClipChangeType type, const QList<DsClip *> &clips);
     void onEditModeChanged(PianoRollEditMode mode);
 
 private:
@@ -161,6 +161,8 @@ void TracksView::onModelChanged() {
         return;
 
     reset();
+    m_graphicsView->setInteractive(true);
+    m_trackListWidget->setEnabled(true);
     auto model = AppModel::instance();
     m_tempo = model->tempo();
     int index = 0;
@@ -172,6 +174,29 @@ void TracksView::onModelChanged() {
 
     // AppController::instance()->onRunG2p();
 }
+void TracksView::onProjectOutlineLoaded(const QList<DsTrack *> &tracks) {
+    if (m_tracksScene == nullptr)
+        return;
+
+    reset();
+    // The outline is not part of the model, so nothing on it can be edited
+    m_graphicsView->setInteractive(false);
+    m_trackListWidget->setEnabled(false);
+    int index = 0;
+    for (const auto track : tracks) {
+        insertTrackToView(track, index);
+        index++;
+    }
+    emit trackCountChanged(m_trackListViewModel.tracks.count());
+}
+void TracksView::onProjectClipLoaded(int outlineClipId, DsClip *clip) {
+    auto item = findClipItemById(outlineClipId);
+    if (!item || clip->type() != DsClip::Singing)
+        return;
+    auto singingItem = dynamic_cast<SingingClipGraphicsItem *>(item);
+    if (singingItem)
+        singingItem->loadNotes(dynamic_cast<DsSingingClip *>(clip)->notes());
+}
 void TracksView::onTempoChanged(double tempo) {
     // notify audio clips
     m_tempo = tempo;
@@ -198,30 +223,38 @@ void TracksView::onTrackChanged(AppModel::TrackChangeType type, int index) {
             break;
     }
 }
-void TracksView::onClipChanged(DsTrack::ClipChangeType type, int trackIndex, int clipId) {
-    auto trackModel = AppModel::instance()->tracks().at(trackIndex);
+void TracksView::onClipsChanged(DsTrack::ClipChangeType type, int trackIndex,
+                                const QList<DsClip *> &clips) {
+    qDebug() << "TracksView on clips changed" << type << trackIndex << clips.count();
     auto track = m_trackListViewModel.tracks.at(trackIndex);
-    auto dsClip = trackModel->findClipById(clipId);
-    switch (type) {
-        case DsTrack::Inserted:
-            qDebug() << "TracksView on clip inserted" << trackIndex << clipId;
-            insertClipToTrack(dsClip, track, trackIndex);
-            break;
+    for (auto dsClip : clips) {
+        auto clipId = dsClip->id();
+        // The view item still holds the range the clip had before this change
+        int prevStart = 0;
+        int prevEnd = 0;
+        if (auto clipItem = findClipItemById(clipId)) {
+            prevStart = clipItem->start() + clipItem->clipStart();
+            prevEnd = prevStart + clipItem->clipLen();
+        }
+        switch (type) {
+            case DsTrack::Inserted:
+                insertClipToTrack(dsClip, track, trackIndex);
+                break;
 
-        case DsTrack::PropertyChanged:
-            qDebug() << "TracksView on clip updated" << trackIndex << clipId;
-            updateClipOnView(dsClip, clipId);
-            break;
+            case DsTrack::PropertyChanged:
+                updateClipOnView(dsClip, clipId);
+                break;
 
-        case DsTrack::Removed:
-            qDebug() << "TracksView on clip removed" << trackIndex << clipId;
-            removeClipFromView(clipId);
-            break;
-    }
-    for (auto overlappedItem : trackModel->clips().overlappedItems()) {
-        qDebug() << "overlappedItem" << overlappedItem->id();
+            case DsTrack::Removed:
+                removeClipFromView(clipId);
+                break;
+        }
+        // Only clips intersecting the old or new range of the changed clip can change state
+        updateOverlappedState(trackIndex, prevStart, prevEnd);
+        if (type != DsTrack::Removed)
+            updateOverlappedState(trackIndex, dsClip->overlapStart(), dsClip->overlapEnd());
     }
-    updateOverlappedState(trackIndex);
+    m_graphicsView->update();
 }
 void TracksView::onPositionChanged(double tick) {
     m_timeline->setPosition(tick);
@@ -277,20 +310,15 @@ void TracksView::onViewScaleChanged(qreal sx, qreal sy) {
     }
 }
 void TracksView::insertTrackToView(DsTrack *dsTrack, int trackIndex) {
-    connect(dsTrack, &DsTrack::clipChanged, this, [=](DsTrack::ClipChangeType type, int clipId) {
-        // workaround for slot executed for 2 times
-        // if (m_prevClipId == clipId && m_prevClipChangeType == type)
-        //     return;
-
-        onClipChanged(type, trackIndex, clipId);
-        m_prevClipId = clipId;
-        m_prevClipChangeType = type;
-    });
+    // The track may have been shown before a model reload, so drop the old connection
+    disconnect(dsTrack, &DsTrack::clipsChanged, this, nullptr);
+    connect(dsTrack, &DsTrack::clipsChanged, this,
+            [=](DsTrack::ClipChangeType type, const QList<DsClip *> &clips) {
+                onClipsChanged(type, trackIndex, clips);
+            });
     auto track = new TrackViewModel;
-    for (int clipIndex = 0; clipIndex < dsTrack->clips().count(); clipIndex++) {
-        auto clip = dsTrack->clips().at(clipIndex);
+    for (const auto clip : dsTrack->clips())
         insertClipToTrack(clip, track, trackIndex);
-    }
     auto newTrackItem = new QListWidgetItem;
     auto newTrackControlWidget = new TrackControlWidget(newTrackItem);
     newTrackItem->setSizeHint(QSize(TracksEditorGlobal::trackListWidth,
@@ -375,7 +403,6 @@ void TracksView::insertClipToTrack(DsClip *clip, TrackViewModel *track,
         clipItem->setScaleX(m_graphicsView->scaleX());
         clipItem->setScaleY(m_graphicsView->scaleY());
         m_tracksScene->addItem(clipItem);
-        qDebug() << "Audio clip graphics item added to scene" << clipItem->id() << clipItem->name();
         connect(m_graphicsView, &TracksGraphicsView::scaleChanged, clipItem,
                 &AudioClipGraphicsItem::setScale);
         connect(m_graphicsView, &TracksGraphicsView::visibleRectChanged, clipItem,
@@ -420,8 +447,6 @@ void TracksView::insertClipToTrack(DsClip *clip, TrackViewModel *track,
         clipItem->setScaleX(m_graphicsView->scaleX());
         clipItem->setScaleY(m_graphicsView->scaleY());
         m_tracksScene->addItem(clipItem);
-        qDebug() << "Singing clip graphics item added to scene" << clipItem->id()
-                 << clipItem->name();
         connect(m_graphicsView, &TracksGraphicsView::scaleChanged, clipItem,
                 &SingingClipGraphicsItem::setScale);
         connect(m_graphicsView, &TracksGraphicsView::visibleRectChanged, clipItem,
@@ -452,20 +477,18 @@ void TracksView::insertClipToTrack(DsClip *clip, TrackViewModel *track,
 void TracksView::removeClipFromView(int clipId) {
     auto clipItem = findClipItemById(clipId);
     m_tracksScene->removeItem(clipItem);
-    int trackIndex = 0;
     for (const auto &track : m_trackListViewModel.tracks) {
-        if (track->clips.contains(clipItem)) {
-            track->clips.removeOne(clipItem);
+        if (track->clips.removeOne(clipItem))
             break;
-        }
-        trackIndex++;
     }
+    // The removal may be triggered from one of the item's own handlers
+    clipItem->deleteLater();
 }
 AbstractClipGraphicsItem *TracksView::findClipItemById(int id) {
-    for (const auto &track : m_trackListViewModel.tracks)
-        for (const auto clip : track->clips)
-            if (clip->id() == id)
-                return clip;
+    auto clipItem = UniqueObject::find<AbstractClipGraphicsItem>(id);
+    // Items removed from the view may still be waiting for deletion
+    if (clipItem && clipItem->scene() == m_tracksScene)
+        return clipItem;
     return nullptr;
 }
 void TracksView::updateTracksOnView() {
@@ -527,16 +550,12 @@ void TracksView::removeTrackFromView(int index) {
     connect(m_tracksScene, &TracksGraphicsScene::selectionChanged, this,
             &TracksView::onSceneSelectionChanged);
 }
-void TracksView::updateOverlappedState(int trackIndex) {
+void TracksView::updateOverlappedState(int trackIndex, int startTick, int endTick) {
     auto trackModel = AppModel::instance()->tracks().at(trackIndex);
-    // qDebug() << "app model track clip count" << trackModel->clips().count();
-    auto track = m_trackListViewModel.tracks.at(trackIndex);
-    // qDebug() << "tracks view model clip count" << track->clips.count();
-    for (auto clipItem : track->clips) {
-        auto dsClip = trackModel->findClipById(clipItem->id());
-        clipItem->setOverlapped(dsClip->overlapped());
-    }
-    m_graphicsView->update();
+    trackModel->clips().forEachInRange(startTick, endTick, [=](DsClip *dsClip) {
+        if (auto clipItem = findClipItemById(dsClip->id()))
+            clipItem->setOverlapped(dsClip->overlapped());
+    });
 }
 void TracksView::reset() {
     for (auto &track : m_trackListViewModel.tracks)
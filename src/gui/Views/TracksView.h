@@ -25,11 +25,15 @@ public:
 
 public slots:
     void onModelChanged();
+    // Shows the layout of a project being opened, read-only until onModelChanged()
+    void onProjectOutlineLoaded(const QList<DsTrack *> &tracks);
+    void onProjectClipLoaded(int outlineClipId, DsClip *clip);
     void onTempoChanged(double tempo);
     void onTrackChanged(AppModel::TrackChangeType type, int index);
     // void onPlaybackPositionChanged(long pos);
     // void onSamplerateChanged(int samplerate);
-    void onClipChanged(DsTrack::ClipChangeType type, int trackIndex, int clipIndex);
+    void onClipsChanged(DsTrack::ClipChangeType type, int trackIndex,
+                        const QList<DsClip *> &clips);
     void onPositionChanged(double tick);
     void onLastPositionChanged(double tick);
     void onLevelMetersUpdated(const AppModel::LevelMetersUpdatedArgs &args);
@@ -69,8 +73,6 @@ private:
     double m_tempo = 120;
     int m_samplerate = 48000;
 
-    DsTrack::ClipChangeType m_prevClipChangeType = DsTrack::Removed;
-    int m_prevClipId = -1;
 
     void insertTrackToView(DsTrack *dsTrack, int trackIndex);
     void insertClipToTrack(DsClip *clip, TrackViewModel *track, int trackIndex);
@@ -79,7 +81,7 @@ private:
     void updateTracksOnView();
     void updateClipOnView(DsClip *clip, int clipId);
     void removeTrackFromView(int index);
-    void updateOverlappedState(int trackIndex);
+    void updateOverlappedState(int trackIndex, int startTick, int endTick);
     void reset();
 };
 
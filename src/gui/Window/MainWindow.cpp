@@ -7,6 +7,7 @@
 #include <QFileDialog>
 #include <QSplitter>
 #include <QMenuBar>
+#include <QPushButton>
 
 #include "Audio/AudioSystem.h"
 #include "Audio/Dialogs/AudioSettingsDialog.h"
@@ -14,6 +15,7 @@
 #include "Controller/TracksViewController.h"
 #include "Controller/AppController.h"
 #include "Controller/PlaybackController.h"
+#include "Controls/Base/ProgressIndicator.h"
 #include "Views/ActionButtonsView.h"
 #include "Views/PlaybackView.h"
 #include "Controller/History/HistoryManager.h"
@@ -319,11 +321,49 @@ MainWindow::MainWindow() {
     connect(historyManager, &HistoryManager::undoRedoChanged, actionButtonsView,
             &ActionButtonsView::onUndoRedoChanged);
 
+    // Shown while a project is being opened
+    auto openProgressIndicator = new ProgressIndicator;
+    openProgressIndicator->setFixedWidth(160);
+    auto btnCancelOpen = new QPushButton("Cancel");
+    connect(btnCancelOpen, &QPushButton::clicked, appController,
+            &AppController::cancelOpenProject);
+    auto openProgressLayout = new QHBoxLayout;
+    openProgressLayout->addWidget(openProgressIndicator);
+    openProgressLayout->addWidget(btnCancelOpen);
+    openProgressLayout->setContentsMargins(6, 6, 6, 6);
+    auto openProgressView = new QWidget;
+    openProgressView->setLayout(openProgressLayout);
+    openProgressView->setVisible(false);
+    connect(appController, &AppController::openProjectStarted, this, [=] {
+        openProgressIndicator->reset();
+        openProgressIndicator->setIndeterminate(true);
+        openProgressView->setVisible(true);
+        m_clipEditView->setEnabled(false);
+    });
+    connect(appController, &AppController::openProjectProgressChanged, this, [=](int percent) {
+        openProgressIndicator->setIndeterminate(false);
+        openProgressIndicator->setValue(percent);
+    });
+    connect(appController, &AppController::openProjectOutlineLoaded, m_tracksView,
+            &TracksView::onProjectOutlineLoaded);
+    connect(appController, &AppController::openProjectClipLoaded, m_tracksView,
+            &TracksView::onProjectClipLoaded);
+    connect(appController, &AppController::openProjectFinished, this, [=](bool success) {
+        openProgressIndicator->setIndeterminate(false);
+        openProgressView->setVisible(false);
+        m_clipEditView->setEnabled(true);
+        // A loaded project has replaced the outline already, otherwise the current one is
+        // shown again
+        if (!success)
+            m_tracksView->onModelChanged();
+    });
+
     appController->instance()->onNewProject();
 
     auto actionButtonLayout = new QHBoxLayout;
     actionButtonLayout->addLayout(menuBarContainer);
     actionButtonLayout->addWidget(actionButtonsView);
+    actionButtonLayout->addWidget(openProgressView);
     actionButtonLayout->addSpacerItem(new QSpacerItem(20, 20, QSizePolicy::Expanding));
     actionButtonLayout->addWidget(playbackView);
     actionButtonLayout->setContentsMargins({});
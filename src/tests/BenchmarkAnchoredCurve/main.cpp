@@ -0,0 +1,81 @@
+//
+// Created by fluty on 2024/2/15.
+//
+
+#include <cmath>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include "../../gui/Utils/AnchoredCurve.h"
+
+// One knot per eighth note over one minute at 120 bpm
+constexpr int knotCount = 240;
+constexpr int knotInterval = 240;
+constexpr int samples = 20000;
+
+int main(int argc, char *argv[]) {
+    AnchoredCurve<int, double> curve;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < knotCount; i++) {
+        // Insert in a scattered order to exercise sorted insertion
+        auto index = i * 7 % knotCount;
+        curve.insert(index * knotInterval, 100 * std::sin(index * 0.3) + (index % 5) * 20);
+    }
+    qDebug() << "insert" << knotCount << "knots:" << timer.nsecsElapsed() / 1000 << "us";
+
+    bool sorted = true;
+    const auto &knots = curve.getKnots();
+    for (int i = 1; i < knots.count(); i++)
+        sorted = sorted && knots.at(i - 1).getPosition() < knots.at(i).getPosition();
+    qDebug() << "knots sorted:" << sorted
+             << "segments:" << curve.getSegments().count() << "/" << knots.count() - 1;
+
+    // Incremental updates must match a curve rebuilt from scratch
+    curve.remove(10 * knotInterval);
+    curve.insert(20 * knotInterval, 500);
+    curve.removeRange(100 * knotInterval, 110 * knotInterval);
+    AnchoredCurve<int, double> rebuilt(curve.getKnots());
+    double maxSlopeError = 0;
+    for (int i = 0; i < knots.count(); i++)
+        maxSlopeError = qMax(maxSlopeError, std::abs(knots.at(i).getSlope() -
+                                                      rebuilt.getKnots().at(i).getSlope()));
+    qDebug() << "max slope error after edits:" << maxSlopeError;
+
+    const double start = -1000;
+    const double end = knotCount * knotInterval + 1000;
+    QVector<double> batch(samples);
+    timer.restart();
+    curve.getValueLinspace(start, end, samples, batch.data());
+    auto batchNs = timer.nsecsElapsed();
+
+    QVector<double> single(samples);
+    timer.restart();
+    for (int i = 0; i < samples; i++)
+        single[i] = curve.getValue(static_cast<int>(start + i * (end - start) / samples));
+    auto singleNs = timer.nsecsElapsed();
+
+    // Compare at integer positions, where both evaluate the same point
+    double maxError = 0;
+    const double step = (end - start) / samples;
+    for (int i = 0; i < samples; i++) {
+        auto position = start + i * step;
+        if (position != std::floor(position))
+            continue;
+        maxError = qMax(maxError, std::abs(batch.at(i) - single.at(i)));
+    }
+    qDebug() << "linspace" << samples << "points:" << batchNs / 1000 << "us";
+    qDebug() << "getValue" << samples << "points:" << singleNs / 1000 << "us";
+    qDebug() << "max error:" << maxError;
+
+    AnchoredCurve<int, float> floatCurve;
+    for (const auto &knot : knots)
+        floatCurve.insert(knot.getPosition(), static_cast<float>(knot.getValue()));
+    QVector<float> floatBatch(samples);
+    timer.restart();
+    floatCurve.getValueLinspace(start, end, samples, floatBatch.data());
+    qDebug() << "float linspace" << samples << "points:" << timer.nsecsElapsed() / 1000 << "us";
+    return 0;
+}
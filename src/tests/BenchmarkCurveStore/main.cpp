@@ -0,0 +1,97 @@
+//
+// Created by fluty on 2024/2/13.
+//
+
+#include <cmath>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QList>
+
+#include "../../gui/Utils/ChunkedIntArray.h"
+
+// One minute at 120 bpm, sampled every 5 ticks like DsDrawCurve
+constexpr int ticksPerMinute = 120 * 480;
+constexpr int step = 5;
+constexpr int samplesPerMinute = ticksPerMinute / step;
+
+// Pitch in cents: notes a few semitones apart with vibrato and short transitions
+QList<int> pitchCurve() {
+    QList<int> values;
+    for (int i = 0; i < samplesPerMinute; i++) {
+        auto tick = i * step;
+        auto note = 6000 + ((tick / 480) * 7 % 12 - 6) * 100;
+        auto vibrato = 30 * std::sin(tick / 480.0 * 2 * M_PI * 5.5 / 2);
+        values.append(note + static_cast<int>(vibrato));
+    }
+    return values;
+}
+
+// Energy, tension and breathiness: slow envelopes in a small range
+QList<int> envelopeCurve(double phase) {
+    QList<int> values;
+    for (int i = 0; i < samplesPerMinute; i++) {
+        auto tick = i * step;
+        values.append(static_cast<int>(500 + 400 * std::sin(tick / 1920.0 + phase)));
+    }
+    return values;
+}
+
+// QList<int> in Qt 5 keeps every int in a pointer-sized node
+qint64 listMemoryUsage(const QList<int> &values) {
+    return values.count() * static_cast<qint64>(sizeof(void *));
+}
+
+int main(int argc, char *argv[]) {
+    // Four parameters, three layers each (original, edited, envelope)
+    QList<QList<int>> curves;
+    for (int layer = 0; layer < 3; layer++) {
+        curves.append(pitchCurve());
+        curves.append(envelopeCurve(layer));
+        curves.append(envelopeCurve(layer + 1));
+        curves.append(envelopeCurve(layer + 2));
+    }
+
+    qint64 listBytes = 0;
+    qint64 chunkedBytes = 0;
+    QList<ChunkedIntArray> arrays;
+    for (const auto &curve : curves) {
+        listBytes += listMemoryUsage(curve);
+        arrays.append(ChunkedIntArray(curve));
+        chunkedBytes += arrays.last().memoryUsage();
+    }
+    qDebug() << "memory per minute, 4 params x 3 layers:"
+             << "QList<int>:" << listBytes / 1024.0 << "KiB"
+             << "chunked:" << chunkedBytes / 1024.0 << "KiB";
+
+    bool valid = true;
+    for (int i = 0; i < curves.count(); i++)
+        valid = valid && arrays.at(i).toList() == curves.at(i);
+
+    const int rounds = 200;
+    QVector<int> buffer(samplesPerMinute);
+    qint64 sum = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        arrays.at(0).read(0, samplesPerMinute, buffer.data());
+        sum += buffer.at(r % samplesPerMinute);
+    }
+    auto decodeTime = static_cast<double>(timer.nsecsElapsed()) / rounds / samplesPerMinute;
+
+    // Redraw a two-beat stroke somewhere in the middle of the pitch curve
+    QList<int> stroke;
+    for (int i = 0; i < 960 / step; i++)
+        stroke.append(6500 + i);
+    auto &pitch = arrays[0];
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        pitch.write((r * 97) % (samplesPerMinute - stroke.count()), stroke);
+    auto writeTime = static_cast<double>(timer.nsecsElapsed()) / rounds / 1000;
+    valid = valid && pitch.at((199 * 97) % (samplesPerMinute - stroke.count())) == 6500;
+
+    qDebug() << "sequential decode:" << decodeTime << "ns/value"
+             << "range write of" << stroke.count() << "values:" << writeTime << "us"
+             << "valid:" << valid << sum;
+    return 0;
+}
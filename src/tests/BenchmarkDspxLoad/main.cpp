@@ -0,0 +1,229 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QThread>
+
+#ifdef Q_OS_WIN
+#  include <Windows.h>
+#  include <Psapi.h>
+#else
+#  include <sys/resource.h>
+#endif
+
+#include "opendspx/qdspxmodel.h"
+#include "opendspx/qdspxtrack.h"
+
+#include "Utils/ProjectConverters/DspxStreamReader.h"
+
+// Peak resident memory of the process in KiB
+static qint64 peakMemory() {
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<qint64>(counters.PeakWorkingSetSize / 1024);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#  ifdef Q_OS_MACOS
+    return usage.ru_maxrss / 1024;
+#  else
+    return usage.ru_maxrss;
+#  endif
+#endif
+}
+
+// A project of singing clips with phonemes on every note, a drawn pitch curve over each
+// clip and an anchor curve every few notes
+static void writeProject(const QString &path, int tracks, int clips, int notes) {
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write(R"({"version":"1.0.0","content":{"timeline":{"timeSignatures":)"
+               R"([{"pos":0,"numerator":4,"denominator":4}],"tempos":[{"pos":0,"value":120}]},)"
+               R"("tracks":[)");
+    for (int t = 0; t < tracks; t++) {
+        file.write(t ? "," : "");
+        file.write(R"({"name":"Track","control":{"gain":0,"pan":0,"mute":false,"solo":false},)"
+                   R"("clips":[)");
+        for (int c = 0; c < clips; c++) {
+            auto length = notes * 480;
+            file.write(c ? "," : "");
+            file.write(QString(R"({"type":"singing","name":"Clip","time":{"start":%1,"length":%2,)"
+                               R"("clipStart":0,"clipLen":%2},"control":{"gain":0,"mute":false},)"
+                               R"("notes":[)")
+                           .arg(c * length)
+                           .arg(length)
+                           .toUtf8());
+            QByteArray block;
+            for (int n = 0; n < notes; n++) {
+                block.append(n ? "," : "");
+                block.append(QString(R"({"pos":%1,"length":480,"keyNum":%2,"lyric":"la",)"
+                                     R"("pronunciation":"la","phonemes":{"original":[)"
+                                     R"({"type":"ahead","token":"l","start":0},)"
+                                     R"({"type":"normal","token":"a","start":0}],"edited":[]}})")
+                                 .arg(n * 480)
+                                 .arg(60 + n % 12)
+                                 .toUtf8());
+                if (block.size() > 1 << 20) {
+                    file.write(block);
+                    block.clear();
+                }
+            }
+            block.append(R"(],"params":{"pitch":{"original":[{"type":"free","start":0,)"
+                         R"("step":5,"values":[)");
+            for (int v = 0; v < length / 5; v++) {
+                block.append(v ? "," : "");
+                block.append(QByteArray::number(6000 + v % 200));
+                if (block.size() > 1 << 20) {
+                    file.write(block);
+                    block.clear();
+                }
+            }
+            block.append(R"(]}],"edited":[)");
+            for (int a = 0; a < notes / 8; a++) {
+                block.append(a ? "," : "");
+                block.append(QString(R"({"type":"anchor","start":%1,"nodes":[)"
+                                     R"({"x":%1,"y":6000,"interp":"hermite"},)"
+                                     R"({"x":%2,"y":6100,"interp":"hermite"}]})")
+                                 .arg(a * 3840)
+                                 .arg(a * 3840 + 960)
+                                 .toUtf8());
+            }
+            block.append(R"(],"envelope":[]}}})");
+            file.write(block);
+        }
+        file.write("]}");
+    }
+    file.write("]}}");
+}
+
+// The previous path: the whole project as QDspx structs first, then copied into the model
+static int loadThroughModel(const QString &path) {
+    QDspxModel dspxModel;
+    if (dspxModel.load(path).type != QDspx::ReturnCode::Success)
+        return -1;
+    QList<DsTrack *> tracks;
+    int noteCount = 0;
+    for (const auto &dspxTrack : dspxModel.content.tracks) {
+        auto track = new DsTrack;
+        track->setName(dspxTrack.name);
+        for (const auto &dspxClip : dspxTrack.clips) {
+            if (dspxClip->type != QDspx::Clip::Type::Singing)
+                continue;
+            auto castClip = dspxClip.dynamicCast<QDspx::SingingClip>();
+            auto clip = new DsSingingClip;
+            clip->setStart(castClip->time.start);
+            clip->setLength(castClip->time.length);
+            clip->setClipLen(castClip->time.clipLen);
+            for (const auto &dspxNote : castClip->notes) {
+                auto note = clip->createNote();
+                note->setStart(dspxNote.pos);
+                note->setLength(dspxNote.length);
+                note->setKeyIndex(dspxNote.keyNum);
+                note->setLyric(dspxNote.lyric);
+                note->setPronunciation(dspxNote.pronunciation);
+                QList<DsPhoneme> phonemes;
+                for (const auto &dspxPhoneme : dspxNote.phonemes.org)
+                    phonemes.append(DsPhoneme(DsPhoneme::Normal, dspxPhoneme.token,
+                                              dspxPhoneme.start));
+                note->setPhonemes(DsPhonemes::Original, phonemes);
+                clip->insertNoteQuietly(note);
+                noteCount++;
+            }
+            for (const auto &dspxCurve : castClip->params.pitch.org) {
+                if (dspxCurve->type != QDspx::ParamCurve::Type::Free)
+                    continue;
+                auto castCurve = dspxCurve.dynamicCast<QDspx::ParamFree>();
+                auto curve = clip->createDrawCurve();
+                curve->setStart(castCurve->start);
+                curve->setValues(castCurve->values);
+                clip->params.pitch.original.add(curve);
+            }
+            for (const auto &dspxCurve : castClip->params.pitch.edited) {
+                if (dspxCurve->type != QDspx::ParamCurve::Type::Anchor)
+                    continue;
+                auto castCurve = dspxCurve.dynamicCast<QDspx::ParamAnchor>();
+                auto curve = clip->createAnchorCurve();
+                curve->setStart(castCurve->start);
+                for (const auto &dspxNode : castCurve->nodes)
+                    curve->insertNode(clip->createAnchorNode(dspxNode.x, dspxNode.y));
+                clip->params.pitch.edited.add(curve);
+            }
+            track->insertClipQuietly(clip);
+        }
+        tracks.append(track);
+    }
+    return noteCount;
+}
+
+static int loadStreaming(const QString &path, int threadCount) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    DspxStreamReader reader(&file);
+    reader.setThreadCount(threadCount);
+    if (!reader.read()) {
+        qDebug() << reader.errorString();
+        return -1;
+    }
+    int noteCount = 0;
+    for (const auto track : reader.takeTracks())
+        for (const auto clip : track->clips())
+            noteCount += dynamic_cast<DsSingingClip *>(clip)->notes().count();
+    return noteCount;
+}
+
+// Each path runs in a process of its own, so that the peak memory is its own
+static void measure(const QString &mode, const QString &path) {
+    QProcess process;
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.start(QCoreApplication::applicationFilePath(), {mode, path});
+    process.waitForFinished(-1);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    auto args = app.arguments();
+    if (args.count() == 3) {
+        auto baseline = peakMemory();
+        QElapsedTimer timer;
+        timer.start();
+        int notes;
+        if (args[1] == "stream")
+            notes = loadStreaming(args[2], 1);
+        else if (args[1] == "thread")
+            notes = loadStreaming(args[2], QThread::idealThreadCount());
+        else
+            notes = loadThroughModel(args[2]);
+        auto elapsed = timer.elapsed();
+        qDebug().noquote() << QString("  %1: notes: %2 load: %3 ms peak memory: +%4 MiB")
+                                  .arg(args[1], -6)
+                                  .arg(notes)
+                                  .arg(elapsed)
+                                  .arg((peakMemory() - baseline) / 1024);
+        return 0;
+    }
+
+    auto path = QDir::temp().filePath("BenchmarkDspxLoad.dspx");
+    qDebug() << "threads:" << QThread::idealThreadCount();
+    // tracks, clips per track, notes per clip
+    const QList<QList<int>> projects = {
+        {1, 4, 1000}, {2, 8, 5000}, {4, 8, 10000}, {64, 2, 2000}, {128, 4, 1000}};
+    for (const auto &project : projects) {
+        writeProject(path, project[0], project[1], project[2]);
+        qDebug() << "tracks:" << project[0] << "clips:" << project[0] * project[1]
+                 << "notes:" << project[0] * project[1] * project[2]
+                 << "file:" << QFile(path).size() / (1024 * 1024) << "MiB";
+        measure("dspx", path);
+        measure("stream", path);
+        measure("thread", path);
+    }
+    QFile::remove(path);
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <random>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "../../gui/Model/DsNote.h"
+#include "../../gui/Utils/OverlapableSerialList.h"
+
+class Clip {
+public:
+    explicit Clip(int size) {
+        std::mt19937 random(20240216);
+        for (int i = 0; i < size; i++) {
+            // Some notes overlap their neighbours, so the overlap state has work to do
+            auto length = random() % 8 == 0 ? 720 : 480;
+            auto note = new DsNote(i * 480, length, 48 + static_cast<int>(random() % 24),
+                                   QString("la%1").arg(i));
+            note->attach(&store);
+            list.add(note);
+            notes.append(note);
+        }
+    }
+    ~Clip() {
+        list.clear();
+        qDeleteAll(notes);
+    }
+
+    DsNoteStore store;
+    OverlapableSerialList<DsNote> list;
+    QList<DsNote *> notes;
+};
+
+// What the edit actions did per note before: take the note out, move it and put it back
+void movePerNote(Clip &clip, const QList<DsNote *> &selection, int deltaTick, int deltaKey) {
+    for (const auto note : selection) {
+        clip.list.remove(note);
+        note->detach();
+        note->setStart(note->start() + deltaTick);
+        note->setKeyIndex(note->keyIndex() + deltaKey);
+        note->attach(&clip.store);
+        clip.list.add(note);
+    }
+}
+
+void moveBulk(Clip &clip, const QList<DsNote *> &selection, int deltaTick, int deltaKey) {
+    clip.list.updateItems(selection, [&](DsNote *note) {
+        note->setStart(note->start() + deltaTick);
+        note->setKeyIndex(note->keyIndex() + deltaKey);
+    });
+}
+
+bool isSame(const Clip &a, const Clip &b) {
+    if (a.list.count() != b.list.count() ||
+        a.list.overlappedItems().count() != b.list.overlappedItems().count())
+        return false;
+    for (int i = 0; i < a.list.count(); i++) {
+        auto noteA = a.list.at(i);
+        auto noteB = b.list.at(i);
+        if (noteA->id() - a.notes.first()->id() != noteB->id() - b.notes.first()->id() ||
+            noteA->start() != noteB->start() || noteA->keyIndex() != noteB->keyIndex() ||
+            noteA->overlapped() != noteB->overlapped())
+            return false;
+    }
+    return true;
+}
+
+void run(int size, int selected) {
+    Clip perNote(size);
+    Clip bulk(size);
+    // Spread the selection over the clip, like a drag of a large selection
+    QList<DsNote *> perNoteSelection;
+    QList<DsNote *> bulkSelection;
+    auto step = size / selected;
+    auto first = (size - step * selected) / 2;
+    for (int i = 0; i < selected; i++) {
+        auto index = first + i * step;
+        perNoteSelection.append(perNote.notes.at(index));
+        bulkSelection.append(bulk.notes.at(index));
+    }
+
+    // Move right across the neighbours, then back, like execute() and undo()
+    const int deltaTick = 960 + 240;
+    QElapsedTimer timer;
+    timer.start();
+    movePerNote(perNote, perNoteSelection, deltaTick, 1);
+    movePerNote(perNote, perNoteSelection, -deltaTick, -1);
+    auto perNoteTime = timer.elapsed();
+
+    timer.start();
+    moveBulk(bulk, bulkSelection, deltaTick, 1);
+    moveBulk(bulk, bulkSelection, -deltaTick, -1);
+    auto bulkTime = timer.elapsed();
+
+    qDebug() << "notes:" << size << "selected:" << perNoteSelection.count()
+             << "per note:" << perNoteTime << "ms"
+             << "bulk:" << bulkTime << "ms"
+             << "results match:" << isSame(perNote, bulk);
+}
+
+int main(int argc, char *argv[]) {
+    run(10000, 10000);
+    run(20000, 10000);
+    run(100000, 10000);
+    // Small selections keep going through remove() and add()
+    run(100000, 100);
+    return 0;
+}
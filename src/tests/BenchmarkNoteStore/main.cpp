@@ -0,0 +1,118 @@
+//
+// Created by fluty on 2024/2/12.
+//
+
+#include <algorithm>
+#include <random>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "../../gui/Model/DsNote.h"
+#include "../../gui/Utils/OverlapableSerialList.h"
+
+// Layout of DsNote before the note store: every note owns its timing, text and phonemes
+class LegacyNote {
+public:
+    int start = 0;
+    int length = 480;
+    int keyIndex = 60;
+    QString lyric;
+    QString pronunciation;
+    DsPhonemes phonemes;
+};
+
+struct ScanResult {
+    qint64 sum = 0;
+    int lowestKeyIndex = 127;
+    int highestKeyIndex = 0;
+};
+
+// Timing-only scan, like preview drawing and segmentation do it
+template <typename Start, typename Length, typename Key>
+void accumulate(ScanResult &result, Start start, Length length, Key keyIndex) {
+    result.sum += start + length;
+    result.lowestKeyIndex = qMin(result.lowestKeyIndex, keyIndex);
+    result.highestKeyIndex = qMax(result.highestKeyIndex, keyIndex);
+}
+
+double nsPerNote(const QElapsedTimer &timer, int notes, int rounds) {
+    return static_cast<double>(timer.nsecsElapsed()) / notes / rounds;
+}
+
+void run(int size) {
+    const int rounds = 20;
+    std::mt19937 random(20240212);
+    // Notes are created in editing order, not in time order, so the heap is interleaved
+    QVector<int> order(size);
+    for (int i = 0; i < size; i++)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), random);
+
+    QList<LegacyNote *> legacyNotes;
+    for (auto i : order) {
+        auto note = new LegacyNote;
+        note->start = i * 480;
+        note->keyIndex = 48 + static_cast<int>(random() % 24);
+        note->lyric = QString("la%1").arg(i);
+        note->pronunciation = "la";
+        legacyNotes.append(note);
+    }
+    std::sort(legacyNotes.begin(), legacyNotes.end(),
+              [](const LegacyNote *a, const LegacyNote *b) { return a->start < b->start; });
+
+    DsNoteStore store;
+    OverlapableSerialList<DsNote> notes;
+    QList<DsNote *> ownedNotes;
+    for (auto i : order) {
+        auto note = new DsNote(i * 480, 480, 48 + static_cast<int>(random() % 24),
+                               QString("la%1").arg(i));
+        note->setPronunciation("la");
+        note->attach(&store);
+        notes.add(note);
+        ownedNotes.append(note);
+    }
+
+    QElapsedTimer timer;
+    ScanResult legacy;
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        for (const auto note : legacyNotes)
+            accumulate(legacy, note->start, note->length, note->keyIndex);
+    auto legacyTime = nsPerNote(timer, size, rounds);
+
+    ScanResult facade;
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        for (const auto note : notes)
+            accumulate(facade, note->start(), note->length(), note->keyIndex());
+    auto facadeTime = nsPerNote(timer, size, rounds);
+
+    ScanResult columns;
+    timer.start();
+    for (int r = 0; r < rounds; r++) {
+        const auto &starts = store.starts();
+        const auto &lengths = store.lengths();
+        const auto &keys = store.keyIndices();
+        for (int slot = 0; slot < store.slotCount(); slot++)
+            if (!store.isFree(slot))
+                accumulate(columns, starts.at(slot), lengths.at(slot), keys.at(slot));
+    }
+    auto columnsTime = nsPerNote(timer, size, rounds);
+
+    qDebug() << "notes:" << size << "heap objects:" << legacyTime << "ns/note"
+             << "store via DsNote:" << facadeTime << "ns/note"
+             << "store columns:" << columnsTime << "ns/note"
+             << "checksums match:"
+             << (legacy.sum == facade.sum && facade.sum == columns.sum);
+
+    qDeleteAll(legacyNotes);
+    notes.clear();
+    qDeleteAll(ownedNotes);
+}
+
+int main(int argc, char *argv[]) {
+    for (auto size : {1000, 10000, 100000})
+        run(size);
+    return 0;
+}
@@ -0,0 +1,115 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "../../gui/Model/DsCurve.h"
+#include "../../gui/Model/DsNote.h"
+#include "../../gui/Utils/ObjectPool.h"
+
+// Counts heap allocations, to compare one allocation per object with one per pool block
+static std::atomic<qint64> allocations{0};
+
+void *operator new(std::size_t size) {
+    allocations++;
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// What a loaded singing clip allocates: notes attached to the clip's store, and anchor
+// curves for the pitch with a node every few ticks
+class Project {
+public:
+    int notes;
+    int nodes;
+};
+
+// Objects allocated one by one, as the converters did
+void loadPerObject(const Project &project, qint64 &loadTime, qint64 &freeTime) {
+    QElapsedTimer timer;
+    timer.start();
+    DsNoteStore store;
+    QList<DsNote *> notes;
+    for (int i = 0; i < project.notes; i++) {
+        auto note = new DsNote(i * 480, 480, 60 + i % 12, "la");
+        note->attach(&store);
+        notes.append(note);
+    }
+    QList<DsAnchorNode *> nodes;
+    for (int i = 0; i < project.nodes; i++)
+        nodes.append(new DsAnchorNode(i * 5, i % 100));
+    loadTime = timer.nsecsElapsed();
+
+    timer.start();
+    qDeleteAll(notes);
+    qDeleteAll(nodes);
+    freeTime = timer.nsecsElapsed();
+}
+
+// Objects from the pools of the clip, freed all at once with it
+void loadPooled(const Project &project, qint64 &loadTime, qint64 &freeTime) {
+    QElapsedTimer timer;
+    timer.start();
+    DsNoteStore store;
+    ObjectPool<DsNote> notePool;
+    ObjectPool<DsAnchorNode> nodePool;
+    QList<DsNote *> notes;
+    for (int i = 0; i < project.notes; i++) {
+        auto note = notePool.create(i * 480, 480, 60 + i % 12, "la");
+        note->attach(&store);
+        notes.append(note);
+    }
+    QList<DsAnchorNode *> nodes;
+    for (int i = 0; i < project.nodes; i++)
+        nodes.append(nodePool.create(i * 5, i % 100));
+    loadTime = timer.nsecsElapsed();
+
+    timer.start();
+    notePool.clear();
+    nodePool.clear();
+    freeTime = timer.nsecsElapsed();
+}
+
+void run(const Project &project) {
+    qint64 loadTime;
+    qint64 freeTime;
+    auto before = allocations.load();
+    loadPerObject(project, loadTime, freeTime);
+    auto perObjectAllocations = allocations.load() - before;
+    auto perObjectLoad = loadTime;
+    auto perObjectFree = freeTime;
+
+    before = allocations.load();
+    loadPooled(project, loadTime, freeTime);
+    auto pooledAllocations = allocations.load() - before;
+
+    // Allocation counts include the id registry and the lists, which both sides share
+    qDebug() << "notes:" << project.notes << "anchor nodes:" << project.nodes;
+    qDebug() << "  per object: allocations:" << perObjectAllocations
+             << "load:" << perObjectLoad / 1000 << "us"
+             << "free:" << perObjectFree / 1000 << "us";
+    qDebug() << "  pooled:     allocations:" << pooledAllocations
+             << "load:" << loadTime / 1000 << "us"
+             << "free:" << freeTime / 1000 << "us";
+}
+
+int main(int argc, char *argv[]) {
+    run({1000, 10000});
+    run({10000, 100000});
+    // About the size of a long song with dense pitch anchors
+    run({100000, 1000000});
+    return 0;
+}
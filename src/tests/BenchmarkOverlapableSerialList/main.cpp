@@ -0,0 +1,117 @@
+//
+// Created by fluty on 2024/2/11.
+//
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include "../TestComparable/TestTimeObject.h"
+#include "../../gui/Utils/OverlapableSerialList.h"
+
+// Brute-force check that the incrementally maintained overlapped flags are right
+bool verifyOverlappedFlags(const OverlapableSerialList<TestTimeObject> &list) {
+    for (const auto item : list) {
+        bool overlapped = false;
+        for (const auto other : list)
+            if (other != item && other->isOverlappedWith(item)) {
+                overlapped = true;
+                break;
+            }
+        if (overlapped != item->overlapped() ||
+            overlapped != list.overlappedItems().contains(item))
+            return false;
+    }
+    return true;
+}
+
+double usPerOp(const QElapsedTimer &timer, int ops) {
+    return timer.nsecsElapsed() / 1000.0 / ops;
+}
+
+void run(int size, bool withLongItem, QRandomGenerator &random) {
+    const int ops = 1000;
+    // Roughly the density of a dense vocal part: notes of 1/8 to 1/2 beat, some overlapping
+    QList<TestTimeObject *> objects;
+    for (int i = 0; i < size; i++)
+        objects.append(new TestTimeObject(random.bounded(size * 240), random.bounded(60, 480)));
+    // One item spanning everything, like a whole-clip note or a long curve, must not make
+    // the overlap scans visit all the items before their range
+    if (withLongItem) {
+        delete objects[0];
+        objects[0] = new TestTimeObject(0, size * 240 + 480);
+    }
+
+    OverlapableSerialList<TestTimeObject> list;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto obj : objects)
+        list.add(obj);
+    auto addTime = usPerOp(timer, size);
+
+    // Same pattern as EditNotePositionAction: remove, move, insert back
+    timer.start();
+    for (int i = 0; i < ops; i++) {
+        auto obj = objects.at(random.bounded(size));
+        list.remove(obj);
+        obj->setStart(qMax(0, obj->start() + random.bounded(-480, 480)));
+        list.add(obj);
+    }
+    auto moveTime = usPerOp(timer, ops);
+
+    int found = 0;
+    timer.start();
+    for (int i = 0; i < ops; i++)
+        found += list.findOverlappedItems(objects.at(random.bounded(size))).count();
+    auto findTime = usPerOp(timer, ops);
+
+    timer.start();
+    for (int i = 0; i < ops; i++)
+        found += list.indexOf(list.at(random.bounded(size))) >= 0;
+    auto indexTime = usPerOp(timer, ops);
+
+    // Visible window of a few bars, as painted by the piano roll and clip previews
+    bool rangesMatch = true;
+    timer.start();
+    for (int i = 0; i < ops; i++) {
+        auto startTick = random.bounded(size * 240);
+        int visited = 0;
+        list.forEachInRange(startTick, startTick + 7680, [&](TestTimeObject *) { visited++; });
+        int viewed = 0;
+        for (const auto item : list.itemsInRange(startTick, startTick + 7680)) {
+            Q_UNUSED(item)
+            viewed++;
+        }
+        rangesMatch = rangesMatch && visited == viewed;
+        found += visited;
+    }
+    auto rangeTime = usPerOp(timer, ops);
+
+    bool sorted = true;
+    int prev = 0;
+    for (const auto item : list) {
+        if (item->start() < prev)
+            sorted = false;
+        prev = item->start();
+    }
+    bool flagsValid = size > 10000 || verifyOverlappedFlags(list);
+
+    qDebug() << "items:" << size << "long item:" << withLongItem << "add:" << addTime << "us"
+             << "move:" << moveTime << "us"
+             << "findOverlapped:" << findTime << "us"
+             << "at+indexOf:" << indexTime << "us"
+             << "range:" << rangeTime << "us"
+             << "sorted:" << sorted << "flags valid:" << flagsValid
+             << "ranges match:" << rangesMatch << found;
+
+    list.clear();
+    qDeleteAll(objects);
+}
+
+int main(int argc, char *argv[]) {
+    QRandomGenerator random(20240211);
+    for (auto withLongItem : {false, true})
+        for (auto size : {100, 1000, 10000, 100000})
+            run(size, withLongItem, random);
+    return 0;
+}
@@ -0,0 +1,92 @@
+//
+// Created by fluty on 2024/2/14.
+//
+
+#include <cmath>
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "../../gui/Model/DsParamSampler.h"
+#include "../../gui/Utils/SamplingKernels.h"
+
+using Kernel = void (*)(float, float, int, float, float, float, float, float *);
+
+double benchmarkKernel(Kernel kernel, QVector<float> &out) {
+    const int rounds = 2000;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        kernel(0, 1.0f / out.count(), out.count(), 6000, 6200 + r % 7, 10, -10, out.data());
+    return static_cast<double>(timer.nsecsElapsed()) / rounds / out.count();
+}
+
+// One minute at 120 bpm: a pitch draw curve, an anchor curve in the edited layer and an
+// anchor envelope
+DsParam buildParam() {
+    DsParam param;
+    auto pitch = new DsDrawCurve;
+    QList<int> values;
+    for (int i = 0; i < 57600 / 5; i++)
+        values.append(6000 + static_cast<int>(50 * std::sin(i / 20.0)));
+    pitch->setValues(values);
+    param.original.add(pitch);
+
+    auto edited = new DsAnchorCurve;
+    for (int i = 0; i <= 40; i++) {
+        auto node = new DsAnchorNode(19200 + i * 480, 6000 + (i % 5) * 100);
+        node->setInterpMode(static_cast<DsAnchorNode::InterpMode>(i % 4));
+        edited->insertNode(node);
+    }
+    param.edited.add(edited);
+
+    auto envelope = new DsAnchorCurve;
+    auto first = new DsAnchorNode(0, 0);
+    first->setInterpMode(DsAnchorNode::Linear);
+    envelope->insertNode(first);
+    envelope->insertNode(new DsAnchorNode(57600, 100));
+    param.envelope.add(envelope);
+    return param;
+}
+
+int main(int argc, char *argv[]) {
+    QVector<float> scalarOut(4096);
+    auto scalarTime = benchmarkKernel(SamplingKernels::hermiteScalar, scalarOut);
+    QVector<float> vectorOut(4096);
+    auto vectorTime = benchmarkKernel(SamplingKernels::hermite, vectorOut);
+    bool kernelsMatch = scalarOut == vectorOut;
+    qDebug() << "hermite kernel scalar:" << scalarTime << "ns/sample"
+             << "dispatched:" << vectorTime << "ns/sample"
+             << "results match:" << kernelsMatch;
+
+    auto param = buildParam();
+    DsParamSampler sampler;
+    const int rounds = 200;
+    QVector<float> buffer;
+    QElapsedTimer timer;
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        buffer = sampler.sample(param, 0, 57600, 5);
+    auto sampleTime = static_cast<double>(timer.nsecsElapsed()) / rounds / buffer.count();
+
+    // Spot checks: draw curve before the edited range, linear envelope added on top
+    auto expectedFirst = 6000.0f;
+    auto atEditStart = buffer.at(19200 / 5);
+    auto envelopeAtEditStart = 100.0f * 19200 / 57600;
+    bool valid = std::abs(buffer.at(0) - expectedFirst) < 1e-3 &&
+                 std::abs(atEditStart - (6000 + envelopeAtEditStart)) < 1e-2;
+
+    // Batch: the same param for 16 clips into one contiguous buffer
+    QVector<float> batchBuffer(16 * 11520);
+    QList<DsParamSampler::Request> requests;
+    for (int i = 0; i < 16; i++)
+        requests.append({&param, 0, 5, 11520, batchBuffer.data() + i * 11520});
+    timer.start();
+    sampler.sampleBatch(requests);
+    auto batchTime = static_cast<double>(timer.nsecsElapsed()) / batchBuffer.count();
+
+    qDebug() << "sample one minute:" << sampleTime << "ns/sample"
+             << "batch of 16:" << batchTime << "ns/sample"
+             << "valid:" << valid;
+    return 0;
+}
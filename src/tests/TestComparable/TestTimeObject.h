@@ -14,6 +14,9 @@ public:
     int start() const {
         return m_start;
     }
+    void setStart(int start) {
+        m_start = start;
+    }
     int length() const {
         return m_lenght;
     }
@@ -34,6 +37,13 @@ public:
         return true;
     }
 
+    int overlapStart() const {
+        return start();
+    }
+    int overlapEnd() const {
+        return start() + length();
+    }
+
 private:
     int m_start = 0;
     int m_lenght = 0;
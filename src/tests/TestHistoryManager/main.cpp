@@ -0,0 +1,181 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include "Controller/Actions/AppModel/Clip/ClipActions.h"
+#include "Controller/Actions/AppModel/Clip/InsertClipAction.h"
+#include "Controller/Actions/AppModel/Note/InsertNoteAction.h"
+#include "Controller/Actions/AppModel/Note/NoteActions.h"
+#include "Controller/History/ActionJournal.h"
+#include "Controller/History/HistoryManager.h"
+#include "Model/AppModel.h"
+
+// Inserts a clip and a note in it as one edit
+class InsertClipWithNote : public ActionSequence {
+public:
+    InsertClipWithNote(DsSingingClip *clip, DsNote *note, DsTrack *track) {
+        addAction(InsertClipAction::build(clip, track));
+        addAction(InsertNoteAction::build(note, clip));
+    }
+};
+
+DsSingingClip *newClip() {
+    auto clip = new DsSingingClip;
+    clip->setStart(0);
+    clip->setLength(1920);
+    clip->setClipStart(0);
+    clip->setClipLen(1920);
+    return clip;
+}
+
+void record(ActionSequence *actions) {
+    actions->execute();
+    HistoryManager::instance()->record(actions);
+}
+
+// A new edit clears the redo stack. The undone edits must be freed newest first, so that the
+// note of an undone InsertNote is freed before the clip of the undone InsertClip that owns it.
+// Run under AddressSanitizer to catch a freed clip being used.
+bool testUndoneInsertions(DsTrack *track) {
+    auto history = HistoryManager::instance();
+    auto clip = newClip();
+    auto insertClip = new ClipActions;
+    insertClip->insertClips({clip}, track);
+    record(insertClip);
+    auto note = clip->createNote(0, 480, 60, "la");
+    auto insertNote = new NoteActions;
+    insertNote->insertNotes({note}, clip);
+    record(insertNote);
+    auto clipId = clip->id();
+    auto noteId = note->id();
+
+    history->undo();
+    history->undo();
+    auto other = new ClipActions;
+    other->insertClips({newClip()}, track);
+    record(other);
+
+    return !history->canRedo() && !UniqueObject::find<DsClip>(clipId) &&
+           !UniqueObject::find<DsNote>(noteId);
+}
+
+// The same within one undone edit: its actions are freed last action first
+bool testUndoneSequence(DsTrack *track) {
+    auto history = HistoryManager::instance();
+    auto clip = newClip();
+    auto note = clip->createNote(0, 480, 60, "la");
+    auto clipId = clip->id();
+    auto noteId = note->id();
+    record(new InsertClipWithNote(clip, note, track));
+
+    history->undo();
+    auto other = new ClipActions;
+    other->insertClips({newClip()}, track);
+    record(other);
+
+    return !history->canRedo() && !UniqueObject::find<DsClip>(clipId) &&
+           !UniqueObject::find<DsNote>(noteId);
+}
+
+// An undone insert is the only holder of its clip, so the clip counts towards the history
+// once the entry is on the redo stack. Over budget, the newest redo entries are evicted first.
+bool testMemoryBudget(DsTrack *track) {
+    auto history = HistoryManager::instance();
+    history->reset();
+    QList<int> clipIds;
+    for (int i = 0; i < 3; i++) {
+        auto clip = newClip();
+        for (int j = 0; j < 100; j++)
+            clip->insertNote(clip->createNote(j * 480, 480, 60, "la"));
+        clipIds.append(clip->id());
+        auto insert = new ClipActions;
+        insert->insertClips({clip}, track);
+        record(insert);
+    }
+    auto executedUsage = history->memoryUsage();
+    auto clipBytes = UniqueObject::find<DsClip>(clipIds.last())->memoryUsage();
+    history->undo();
+    auto passed = history->memoryUsage() == executedUsage + clipBytes;
+    history->undo();
+    history->undo();
+
+    // Only the next entry to redo is left
+    auto budget = history->memoryBudget();
+    history->setMemoryBudget(1);
+    passed = passed && !history->canUndo() && history->canRedo() &&
+             UniqueObject::find<DsClip>(clipIds.at(0)) &&
+             !UniqueObject::find<DsClip>(clipIds.at(1)) &&
+             !UniqueObject::find<DsClip>(clipIds.at(2));
+    history->redo();
+    passed = passed && history->memoryUsage() < clipBytes;
+    history->setMemoryBudget(budget);
+    history->reset();
+    return passed;
+}
+
+// A journal record that refers to an object the reopened project does not have, here a track
+// added outside the history, ends the replay: the records before it are replayed and the
+// journal is cut off there
+bool testUnknownJournalObject() {
+    auto history = HistoryManager::instance();
+    auto model = AppModel::instance();
+    auto projectPath = QDir::temp().filePath("TestHistoryManager.dspx");
+    auto journalPath = ActionJournal::pathOf(projectPath);
+    history->reset();
+    model->newProject();
+    history->restartJournal(projectPath);
+    auto known = new ClipActions;
+    known->insertClips({newClip()}, model->tracks().first());
+    record(known);
+    // Closing the journal writes out what is queued
+    history->reset();
+    auto replayedSize = QFileInfo(journalPath).size();
+
+    // Reopened and edited further
+    model->newProject();
+    history->openJournal(projectPath);
+    auto unknownTrack = new DsTrack;
+    model->appendTrack(unknownTrack);
+    auto unknown = new ClipActions;
+    unknown->insertClips({newClip()}, unknownTrack);
+    record(unknown);
+    history->reset();
+    auto writtenSize = QFileInfo(journalPath).size();
+
+    // Reopened again: the model is back to what the file holds
+    model->newProject();
+    history->openJournal(projectPath);
+    auto passed = writtenSize > replayedSize && history->canUndo() &&
+                  model->tracks().first()->clips().count() == 1 &&
+                  QFileInfo(journalPath).size() == replayedSize;
+    history->undo();
+    passed = passed && !history->canUndo();
+    history->reset();
+    QFile::remove(journalPath);
+    return passed;
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    auto track = new DsTrack;
+    AppModel::instance()->appendTrack(track);
+
+    int failures = 0;
+    auto check = [&](const char *name, bool passed) {
+        qDebug() << name << (passed ? "passed" : "failed");
+        if (!passed)
+            failures++;
+    };
+    check("Undone insertions", testUndoneInsertions(track));
+    check("Undone sequence", testUndoneSequence(track));
+    check("Memory budget", testMemoryBudget(track));
+    check("Unknown journal object", testUnknownJournalObject());
+
+    HistoryManager::instance()->reset();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+//
+// Created by fluty on 2024/2/16.
+//
+
+#include <limits>
+
+#include <QDebug>
+#include <QList>
+
+#include "../../gui/Utils/TickSampleConverter.h"
+
+// Sweeps positions up to 24 hours and checks that every conversion stays exact
+int main(int argc, char *argv[]) {
+    const QList<double> tempos = {60, 120, 123.456, 200};
+    const QList<double> sampleRates = {44100, 48000, 96000, 192000};
+    const qint64 hours = 24;
+    const int steps = 100000;
+    int failures = 0;
+
+    auto fail = [&](const char *check, double tempo, double sampleRate, qint64 at) {
+        if (failures++ < 20)
+            qDebug() << check << "failed: tempo" << tempo << "sample rate" << sampleRate << "at"
+                     << at;
+    };
+
+    for (const auto tempo : tempos) {
+        for (const auto sampleRate : sampleRates) {
+            TickSampleConverter converter(tempo, sampleRate);
+            auto rate = static_cast<qint64>(sampleRate);
+            auto endSample = hours * 3600 * rate;
+            auto endTick = static_cast<qint64>(hours * 60 * tempo * 480);
+
+            // Whole minutes of a tempo with whole ticks per minute must land on exact samples.
+            // 123.456 BPM only does so every 125 minutes.
+            auto minutes = tempo == 123.456 ? 125 : 1;
+            auto ticksPerPeriod = qRound64(minutes * tempo * 480);
+            for (qint64 period = 0; period * minutes <= hours * 60; period++) {
+                auto tick = period * ticksPerPeriod;
+                if (converter.tickToSample(tick) != period * minutes * 60 * rate)
+                    fail("Period", tempo, sampleRate, tick);
+            }
+
+            qint64 lastSample = -1;
+            for (int i = 0; i <= steps; i++) {
+                auto tick = endTick / steps * i + i % 97;
+                auto sample = converter.tickToSample(tick);
+                // Monotonic, and within a sample of the plain floating-point formula
+                if (sample < lastSample)
+                    fail("Monotonic", tempo, sampleRate, tick);
+                lastSample = sample;
+                auto expected = static_cast<long double>(tick) * 60 * sampleRate / tempo / 480;
+                if (std::abs(static_cast<long double>(sample) - expected) > 1)
+                    fail("Formula", tempo, sampleRate, tick);
+                // Fractional positions agree with whole ticks
+                if (converter.tickToSample(static_cast<double>(tick)) != sample)
+                    fail("Fractional tick", tempo, sampleRate, tick);
+            }
+
+            for (int i = 0; i <= steps; i++) {
+                auto sample = endSample / steps * i + i % 997;
+                // A sample position survives the round trip through ticks
+                if (converter.tickToSample(converter.sampleToTick(sample)) != sample)
+                    fail("Round trip", tempo, sampleRate, sample);
+            }
+
+            if (endSample <= std::numeric_limits<int>::max())
+                continue;
+            if (converter.tickToSample(endTick) <= std::numeric_limits<int>::max())
+                fail("64-bit range", tempo, sampleRate, endTick);
+        }
+    }
+
+    qDebug() << "Swept" << hours << "hours at" << tempos.count() * sampleRates.count()
+             << "tempo and sample rate pairs," << failures << "failures";
+    return failures == 0 ? 0 : 1;
+}